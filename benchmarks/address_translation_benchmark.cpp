@@ -0,0 +1,134 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Measures address translation with many ranges, as used for reading
+// process memory (see examples/proc_mem):
+//  - single lookups: random and sequential addresses, compared to a linear
+//    scan of the ranges
+//  - loading a file through 4 KiB page translations
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include "benchmark.hpp"
+
+using namespace ELFIO;
+
+//------------------------------------------------------------------------------
+// Linear scan of the ranges, the way lookups were done before
+std::streampos linear_translate( const std::vector<address_translation>& ranges,
+                                 std::streampos                          value )
+{
+    for ( const auto& t : ranges ) {
+        if ( ( t.start <= value ) && ( ( value - t.start ) < t.size ) ) {
+            return value - t.start + t.mapped_to;
+        }
+    }
+    return value;
+}
+
+//------------------------------------------------------------------------------
+int main()
+{
+    const std::uint64_t page    = 0x1000;
+    const unsigned      lookups = 100000;
+
+    std::cout << std::setw( 8 ) << "ranges" << std::setw( 14 ) << "access"
+              << std::setw( 16 ) << "linear, ns/op" << std::setw( 16 )
+              << "indexed, ns/op" << std::endl;
+
+    for ( unsigned num : { 10u, 100u, 1000u, 10000u } ) {
+        // Every second page is mapped
+        std::vector<address_translation> ranges;
+        for ( std::uint64_t i = 0; i < num; ++i ) {
+            ranges.emplace_back( 2 * i * page, page, i * page );
+        }
+        address_translator translator;
+        translator.set_address_translation( ranges );
+
+        std::mt19937_64                         rng( 42 );
+        std::uniform_int_distribution<uint64_t> dist( 0, 2 * num * page );
+        std::vector<std::uint64_t>              random( lookups );
+        std::vector<std::uint64_t>              sequential( lookups );
+        for ( unsigned i = 0; i < lookups; ++i ) {
+            random[i]     = dist( rng );
+            sequential[i] = ( i * 64 ) % ( 2 * num * page );
+        }
+
+        for ( const auto* addresses : { &random, &sequential } ) {
+            std::streamoff sum1 = 0;
+            std::streamoff sum2 = 0;
+
+            // Fewer linear lookups, they are slow for many ranges
+            unsigned linear_num = std::max( 1000u, lookups / num );
+            double   linear     = benchmark::median_time_us( [&]() {
+                for ( unsigned i = 0; i < linear_num; ++i ) {
+                    sum1 += linear_translate( ranges, ( *addresses )[i] );
+                }
+            } );
+            double indexed = benchmark::median_time_us( [&]() {
+                for ( auto address : *addresses ) {
+                    sum2 += translator[address];
+                }
+            } );
+
+            // The sums are printed to keep the lookups from being optimized
+            // away
+            std::cout << std::setw( 8 ) << num << std::setw( 14 )
+                      << ( addresses == &random ? "random" : "sequential" )
+                      << std::fixed << std::setprecision( 1 )
+                      << std::setw( 16 ) << linear * 1000 / linear_num
+                      << std::setw( 16 ) << indexed * 1000 / lookups
+                      << ( sum1 + sum2 == 0 ? " " : "" ) << std::endl;
+        }
+    }
+
+    // Load a file made of 4 KiB pages mapped one by one
+    const std::string image =
+        benchmark::generate_object( 20000, ELFCLASS64, 2000 );
+    std::vector<address_translation> pages;
+    for ( std::uint64_t start = 0; start < image.size(); start += page ) {
+        pages.emplace_back( start, page, start );
+    }
+
+    double plain = benchmark::median_time_us( [&]() {
+        std::istringstream stream( image );
+        elfio              reader;
+        reader.load( stream );
+    } );
+    double translated = benchmark::median_time_us( [&]() {
+        std::istringstream stream( image );
+        elfio              reader;
+        reader.set_address_translation( pages );
+        reader.load( stream );
+    } );
+
+    std::cout << std::endl
+              << "Load of " << image.size() / 1024 << " KiB through "
+              << pages.size() << " ranges: " << std::fixed
+              << std::setprecision( 1 ) << translated << " us (" << plain
+              << " us without translation)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Measures the throughput of batch_scanner over the test example files
+// against the number of workers. The directory to scan may be given as
+// the first argument
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+#include <elfio/elfio_batch.hpp>
+#include "benchmark.hpp"
+
+using namespace ELFIO;
+
+int main( int argc, char** argv )
+{
+    const std::string directory =
+        argc > 1 ? argv[1] : ELFIO_BENCHMARK_EXAMPLES_DIR;
+
+    std::vector<std::string> file_names;
+    size_t                   total_size = 0;
+    for ( const auto& entry :
+          std::filesystem::directory_iterator( directory ) ) {
+        if ( entry.is_regular_file() ) {
+            file_names.push_back( entry.path().string() );
+            total_size += size_t( entry.file_size() );
+        }
+    }
+    if ( file_names.empty() ) {
+        std::cerr << "No files in " << directory << std::endl;
+        return 1;
+    }
+
+    // Scan the directory several times to get measurable durations
+    const int                repeats = 20;
+    std::vector<std::string> batch;
+    for ( int i = 0; i < repeats; ++i ) {
+        batch.insert( batch.end(), file_names.begin(), file_names.end() );
+    }
+    const double batch_mb = double( total_size ) * repeats / ( 1024 * 1024 );
+
+    std::cout << std::setw( 8 ) << "workers" << std::setw( 14 ) << "mode"
+              << std::setw( 12 ) << "files/s" << std::setw( 12 ) << "MB/s"
+              << std::endl;
+
+    struct mode
+    {
+        const char*  name;
+        bool         is_lazy;
+        load_profile profile;
+    };
+    for ( const mode& m : { mode{ "headers", true, load_profile::headers_only },
+                            mode{ "lazy", true, load_profile::full },
+                            mode{ "eager", false, load_profile::full } } ) {
+        for ( unsigned workers : { 1u, 2u, 4u, 8u } ) {
+            batch_scanner scanner( workers, 64 * 1024 * 1024 );
+            scanner.set_lazy( m.is_lazy );
+            scanner.set_load_profile( m.profile );
+
+            double time = benchmark::median_time_us( [&]() {
+                scanner.scan( batch, []( const std::string&, elfio* file ) {
+                    if ( file != nullptr ) {
+                        volatile Elf_Half machine = file->get_machine();
+                        (void)machine;
+                    }
+                } );
+            } );
+
+            std::cout << std::setw( 8 ) << workers << std::setw( 14 ) << m.name
+                      << std::fixed << std::setprecision( 1 )
+                      << std::setw( 12 ) << batch.size() * 1e6 / time
+                      << std::setw( 12 ) << batch_mb * 1e6 / time
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
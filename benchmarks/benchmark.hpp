@@ -0,0 +1,91 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ELFIO_BENCHMARK_HPP
+#define ELFIO_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <elfio/elfio.hpp>
+
+namespace benchmark {
+
+//------------------------------------------------------------------------------
+//! \brief Run a function several times and return the median duration
+//! \param func The function to measure
+//! \param runs Number of runs
+//! \return Median duration in microseconds
+inline double median_time_us( const std::function<void()>& func,
+                              int                          runs = 5 )
+{
+    std::vector<double> times;
+    for ( int i = 0; i < runs; ++i ) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(
+            std::chrono::duration<double, std::micro>( end - start ).count() );
+    }
+
+    std::sort( times.begin(), times.end() );
+    return times[times.size() / 2];
+}
+
+//------------------------------------------------------------------------------
+//! \brief Generate an ELF object with the given number of sections
+//! \param sections_num Number of sections to add (ELF section numbers are
+//!                     limited to 16 bits)
+//! \param file_class ELFCLASS32 or ELFCLASS64
+//! \param section_size Size of the data of each section
+//! \return The ELF image
+inline std::string generate_object( unsigned      sections_num,
+                                    unsigned char file_class   = ELFIO::ELFCLASS64,
+                                    size_t        section_size = 16 )
+{
+    ELFIO::elfio writer;
+    writer.create( file_class, ELFIO::ELFDATA2LSB );
+    writer.set_type( ELFIO::ET_REL );
+    writer.set_machine( ELFIO::EM_X86_64 );
+
+    std::string data( section_size, '\x90' );
+    for ( unsigned i = 0; i < sections_num; ++i ) {
+        ELFIO::section* sec =
+            writer.sections.add( ".text.f" + std::to_string( i ) );
+        sec->set_type( ELFIO::SHT_PROGBITS );
+        sec->set_flags( ELFIO::SHF_ALLOC | ELFIO::SHF_EXECINSTR );
+        sec->set_addr_align( 16 );
+        sec->set_data( data );
+    }
+
+    std::stringstream stream;
+    writer.save( stream );
+    return stream.str();
+}
+
+} // namespace benchmark
+
+#endif // ELFIO_BENCHMARK_HPP
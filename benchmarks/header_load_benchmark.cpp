@@ -0,0 +1,103 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Measures the time needed to load section and segment headers
+// (lazy mode, no section data is read) against the number of sections.
+// The last columns show loads with deferred section names and loads of
+// the ELF header and segments only
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include "benchmark.hpp"
+
+using namespace ELFIO;
+
+int main()
+{
+    const std::string file_name = "header_load_benchmark.elf";
+
+    std::cout << std::setw( 10 ) << "sections" << std::setw( 12 ) << "class"
+              << std::setw( 14 ) << "stream, us" << std::setw( 14 )
+              << "file, us" << std::setw( 18 ) << "file/section, ns"
+              << std::setw( 16 ) << "deferred, us" << std::setw( 16 )
+              << "headers, us" << std::endl;
+
+    for ( unsigned char file_class : { ELFCLASS32, ELFCLASS64 } ) {
+        for ( unsigned num : { 1000u, 5000u, 20000u, 60000u } ) {
+            const std::string image =
+                benchmark::generate_object( num, file_class );
+            std::ofstream( file_name, std::ios::binary ) << image;
+
+            double stream_time = benchmark::median_time_us( [&]() {
+                std::istringstream stream( image );
+                elfio              reader;
+                if ( !reader.load( stream, true ) ||
+                     reader.sections.size() < num ) {
+                    std::cerr << "Load failed" << std::endl;
+                }
+            } );
+
+            double file_time = benchmark::median_time_us( [&]() {
+                elfio reader;
+                if ( !reader.load( file_name, true ) ||
+                     reader.sections.size() < num ) {
+                    std::cerr << "Load failed" << std::endl;
+                }
+            } );
+
+            double deferred_time = benchmark::median_time_us( [&]() {
+                elfio reader;
+                reader.set_load_profile( load_profile::deferred_names );
+                if ( !reader.load( file_name, true ) ||
+                     reader.sections.size() < num ) {
+                    std::cerr << "Load failed" << std::endl;
+                }
+            } );
+
+            double headers_time = benchmark::median_time_us( [&]() {
+                elfio reader;
+                reader.set_load_profile( load_profile::headers_only );
+                if ( !reader.load( file_name, true ) ) {
+                    std::cerr << "Load failed" << std::endl;
+                }
+            } );
+
+            std::cout << std::setw( 10 ) << num << std::setw( 12 )
+                      << ( file_class == ELFCLASS32 ? "ELFCLASS32"
+                                                    : "ELFCLASS64" )
+                      << std::fixed << std::setprecision( 1 )
+                      << std::setw( 14 ) << stream_time << std::setw( 14 )
+                      << file_time << std::setw( 18 )
+                      << file_time * 1000 / num << std::setw( 16 )
+                      << deferred_time << std::setw( 16 ) << headers_time
+                      << std::endl;
+        }
+    }
+
+    std::remove( file_name.c_str() );
+
+    return 0;
+}
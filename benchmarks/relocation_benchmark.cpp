@@ -0,0 +1,177 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Measures reading relocations with their resolved symbols from objects with
+// many sections:
+//  - the way symbols were resolved before, building a symbol accessor for
+//    every relocation
+//  - the resolving get_entry() of the relocation accessor
+//  - relocation_cursor
+// and applying relocations to a buffer with relocator
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include <elfio/elfio_relocator.hpp>
+
+#include "benchmark.hpp"
+
+using namespace ELFIO;
+
+//------------------------------------------------------------------------------
+// Add a symbol table and a relocation section to an object
+std::string add_relocations( const std::string& image, unsigned relocs_num )
+{
+    std::istringstream in( image );
+    elfio              writer;
+    writer.load( in );
+
+    section* str_sec = writer.sections.add( ".strtab" );
+    str_sec->set_type( SHT_STRTAB );
+    section* sym_sec = writer.sections.add( ".symtab" );
+    sym_sec->set_type( SHT_SYMTAB );
+    sym_sec->set_link( str_sec->get_index() );
+    sym_sec->set_entry_size( writer.get_default_entry_size( SHT_SYMTAB ) );
+    section* rel_sec = writer.sections.add( ".rela.text" );
+    rel_sec->set_type( SHT_RELA );
+    rel_sec->set_link( sym_sec->get_index() );
+    rel_sec->set_entry_size( writer.get_default_entry_size( SHT_RELA ) );
+
+    string_section_accessor     strings( str_sec );
+    symbol_section_accessor     symbols( writer, sym_sec );
+    relocation_section_accessor relocs( writer, rel_sec );
+    std::vector<Elf_Word>       indexes;
+    for ( unsigned i = 0; i < 1000; ++i ) {
+        indexes.push_back( symbols.add_symbol(
+            strings, ( "func" + std::to_string( i ) ).c_str(), i * 16, 16,
+            STB_GLOBAL, STT_FUNC, 0, 1 ) );
+    }
+    for ( unsigned i = 0; i < relocs_num; ++i ) {
+        relocs.add_entry( i * 8, indexes[i % indexes.size()],
+                          (unsigned char)R_X86_64_64, 0 );
+    }
+
+    std::stringstream out;
+    writer.save( out );
+    return out.str();
+}
+
+//------------------------------------------------------------------------------
+int main()
+{
+    const unsigned relocs_num = 100000;
+
+    std::cout << std::setw( 10 ) << "sections" << std::setw( 20 )
+              << "rebuilt, ns/reloc" << std::setw( 20 ) << "get_entry, ns"
+              << std::setw( 20 ) << "cursor, ns" << std::endl;
+
+    for ( unsigned num : { 10u, 1000u, 10000u } ) {
+        std::istringstream stream(
+            add_relocations( benchmark::generate_object( num ), relocs_num ) );
+        elfio reader;
+        reader.load( stream );
+        const section* rel_sec = reader.sections[".rela.text"];
+        const_relocation_section_accessor relocs( reader, rel_sec );
+
+        size_t sum1 = 0;
+        size_t sum2 = 0;
+        size_t sum3 = 0;
+
+        // Fewer rebuilt lookups, they are slow for many sections
+        unsigned rebuilt_num = std::max( 1000u, relocs_num / num * 10 );
+        rebuilt_num          = std::min( rebuilt_num, relocs_num );
+        double rebuilt       = benchmark::median_time_us( [&]() {
+            for ( unsigned i = 0; i < rebuilt_num; ++i ) {
+                Elf64_Addr    offset;
+                Elf_Word      symbol;
+                unsigned      type;
+                Elf_Sxword    addend;
+                std::string   name;
+                Elf64_Addr    value;
+                Elf_Xword     size;
+                unsigned char bind;
+                unsigned char symbol_type;
+                Elf_Half      section_index;
+                unsigned char other;
+                relocs.get_entry( i, offset, symbol, type, addend );
+                const_symbol_section_accessor symbols(
+                    reader, reader.sections[(Elf_Half)rel_sec->get_link()] );
+                symbols.get_symbol( symbol, name, value, size, bind,
+                                    symbol_type, section_index, other );
+                sum1 += name.size();
+            }
+        } );
+        double accessor = benchmark::median_time_us( [&]() {
+            for ( unsigned i = 0; i < relocs_num; ++i ) {
+                Elf64_Addr  offset;
+                Elf64_Addr  value;
+                std::string name;
+                unsigned    type;
+                Elf_Sxword  addend;
+                Elf_Sxword  calc_value;
+                relocs.get_entry( i, offset, value, name, type, addend,
+                                  calc_value );
+                sum2 += name.size();
+            }
+        } );
+        double cursor = benchmark::median_time_us( [&]() {
+            relocation_cursor cur( reader, rel_sec );
+            relocation_entry  entry;
+            while ( cur.next( entry ) ) {
+                sum3 += entry.symbol_name.size();
+            }
+        } );
+
+        // The sums are printed to keep the reads from being optimized away
+        std::cout << std::setw( 10 ) << reader.sections.size() << std::fixed
+                  << std::setprecision( 1 ) << std::setw( 20 )
+                  << rebuilt * 1000 / rebuilt_num << std::setw( 20 )
+                  << accessor * 1000 / relocs_num << std::setw( 20 )
+                  << cursor * 1000 / relocs_num
+                  << ( sum1 + sum2 + sum3 == 0 ? " " : "" ) << std::endl;
+    }
+
+    // Apply many relocations in one pass
+    const unsigned     applied_num = 4000000;
+    std::istringstream stream(
+        add_relocations( benchmark::generate_object( 10 ), applied_num ) );
+    elfio reader;
+    reader.load( stream );
+    const section*    rel_sec = reader.sections[".rela.text"];
+    std::vector<char> target( size_t( applied_num ) * 8 );
+
+    relocator engine( reader );
+    bool      is_ok   = true;
+    double    applied = benchmark::median_time_us( [&]() {
+        is_ok = engine.apply( rel_sec, target.data(), target.size(), 0 ) &&
+                is_ok;
+    } );
+
+    std::cout << std::endl
+              << "Apply " << applied_num << " relocations: " << std::fixed
+              << std::setprecision( 1 ) << applied / 1000 << " ms, "
+              << applied * 1000 / applied_num << " ns/reloc"
+              << ( is_ok ? "" : " (failed)" ) << std::endl;
+
+    return 0;
+}
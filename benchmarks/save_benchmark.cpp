@@ -0,0 +1,87 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+// Compares the sequential (gather-write) save path with the seek-based one
+// on large objects, writing to a memory stream and to a file
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include "benchmark.hpp"
+
+using namespace ELFIO;
+
+int main()
+{
+    const std::string file_name = "save_benchmark.elf";
+
+    std::cout << std::setw( 10 ) << "sections" << std::setw( 10 ) << "size"
+              << std::setw( 14 ) << "mode" << std::setw( 14 ) << "stream, us"
+              << std::setw( 14 ) << "file, us" << std::endl;
+
+    for ( unsigned num : { 1000u, 10000u, 60000u } ) {
+        for ( size_t size : { size_t( 16 ), size_t( 4096 ) } ) {
+            if ( num * size > 256 * 1024 * 1024 ) {
+                continue;
+            }
+
+            std::istringstream image(
+                benchmark::generate_object( num, ELFCLASS64, size ) );
+            elfio writer;
+            if ( !writer.load( image ) ) {
+                std::cerr << "Load failed" << std::endl;
+                return 1;
+            }
+
+            for ( bool is_sequential : { false, true } ) {
+                double stream_time = benchmark::median_time_us( [&]() {
+                    std::ostringstream stream;
+                    if ( !writer.save( stream, is_sequential ) ) {
+                        std::cerr << "Save failed" << std::endl;
+                    }
+                } );
+
+                double file_time = benchmark::median_time_us( [&]() {
+                    std::ofstream stream( file_name, std::ios::binary );
+                    if ( !writer.save( stream, is_sequential ) ) {
+                        std::cerr << "Save failed" << std::endl;
+                    }
+                } );
+
+                std::cout << std::setw( 10 ) << num << std::setw( 10 ) << size
+                          << std::setw( 14 )
+                          << ( is_sequential ? "sequential" : "seek" )
+                          << std::fixed << std::setprecision( 1 )
+                          << std::setw( 14 ) << stream_time << std::setw( 14 )
+                          << file_time << std::endl;
+            }
+        }
+    }
+
+    std::remove( file_name.c_str() );
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Measures reading all symbols of a large symbol table of little and big
+// endian files:
+//  - through symbol_section_accessor::get_symbol()
+//  - through table_view
+//  - through a copy made by table_view::copy_to()
+//  - through static_symbol_section_accessor::get_symbol() and the view of
+//    the accessor, with the class and the encoding known at compile time
+// and the throughput of the bulk and the portable byte order conversion
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include <elfio/elfio_table_view.hpp>
+
+#include "benchmark.hpp"
+
+using namespace ELFIO;
+
+//------------------------------------------------------------------------------
+// Generate an object with a symbol table
+std::string generate_symbols( unsigned char encoding, unsigned symbols_num )
+{
+    elfio writer;
+    writer.create( ELFCLASS64, encoding );
+    writer.set_type( ET_REL );
+    writer.set_machine( EM_X86_64 );
+
+    section* str_sec = writer.sections.add( ".strtab" );
+    str_sec->set_type( SHT_STRTAB );
+    section* sym_sec = writer.sections.add( ".symtab" );
+    sym_sec->set_type( SHT_SYMTAB );
+    sym_sec->set_link( str_sec->get_index() );
+    sym_sec->set_entry_size( writer.get_default_entry_size( SHT_SYMTAB ) );
+
+    // Build the tables directly, adding symbols one by one is slow
+    std::string names( 1, '\0' );
+    std::string symbols( sizeof( Elf64_Sym ), '\0' );
+    const auto& convertor = *writer.get_convertor();
+    for ( unsigned i = 1; i < symbols_num; ++i ) {
+        Elf64_Sym sym = {};
+        sym.st_name   = convertor( Elf_Word( names.size() ) );
+        sym.st_value  = convertor( Elf64_Addr( i * 16 ) );
+        sym.st_size   = convertor( Elf_Xword( i % 64 ) );
+        sym.st_info   = ELF_ST_INFO( STB_GLOBAL, STT_FUNC );
+        sym.st_shndx  = convertor( Elf_Half( 1 ) );
+        names += "f" + std::to_string( i ) + '\0';
+        symbols.append( reinterpret_cast<const char*>( &sym ), sizeof( sym ) );
+    }
+    str_sec->set_data( names );
+    sym_sec->set_data( symbols );
+
+    std::stringstream stream;
+    writer.save( stream );
+    return stream.str();
+}
+
+//------------------------------------------------------------------------------
+// Read all symbols with the class and the encoding known at compile time
+template <unsigned char Encoding>
+void read_static( const elfio&   reader,
+                  const section* sym_sec,
+                  double&        accessed,
+                  double&        viewed,
+                  Elf_Xword&     sum1,
+                  Elf_Xword&     sum2 )
+{
+    static_symbol_section_accessor<ELFCLASS64, Encoding> symbols( reader,
+                                                                  sym_sec );
+    accessed = benchmark::median_time_us( [&]() {
+        for ( Elf_Xword i = 0; i < symbols.get_symbols_num(); ++i ) {
+            std::string_view name;
+            Elf64_Addr       value;
+            Elf_Xword        size;
+            unsigned char    bind;
+            unsigned char    type;
+            Elf_Half         section_index;
+            unsigned char    other;
+            symbols.get_symbol( i, name, value, size, bind, type,
+                                section_index, other );
+            sum1 += value + size;
+        }
+    } );
+
+    viewed = benchmark::median_time_us( [&]() {
+        for ( const auto& sym : symbols.get_symbols() ) {
+            sum2 += sym.st_value + sym.st_size;
+        }
+    } );
+}
+
+//------------------------------------------------------------------------------
+int main()
+{
+    const unsigned symbols_num = 1000000;
+
+    std::cout << "Nanoseconds per symbol" << std::endl
+              << std::setw( 10 ) << "encoding" << std::setw( 12 ) << "accessor"
+              << std::setw( 12 ) << "view" << std::setw( 12 ) << "copy"
+              << std::setw( 12 ) << "static" << std::setw( 14 )
+              << "static view" << std::endl;
+
+    for ( unsigned char encoding : { ELFDATA2LSB, ELFDATA2MSB } ) {
+        std::istringstream stream( generate_symbols( encoding, symbols_num ) );
+        elfio              reader;
+        reader.load( stream );
+        const section* sym_sec = reader.sections[".symtab"];
+
+        Elf_Xword sum1 = 0;
+        Elf_Xword sum2 = 0;
+        Elf_Xword sum3 = 0;
+        Elf_Xword sum4 = 0;
+        Elf_Xword sum5 = 0;
+
+        const_symbol_section_accessor symbols( reader, sym_sec );
+        double accessor = benchmark::median_time_us( [&]() {
+            for ( Elf_Xword i = 0; i < symbols.get_symbols_num(); ++i ) {
+                std::string   name;
+                Elf64_Addr    value;
+                Elf_Xword     size;
+                unsigned char bind;
+                unsigned char type;
+                Elf_Half      section_index;
+                unsigned char other;
+                symbols.get_symbol( i, name, value, size, bind, type,
+                                    section_index, other );
+                sum1 += value + size;
+            }
+        } );
+
+        auto   view = make_table_view<Elf64_Sym>( reader, sym_sec );
+        double viewed = benchmark::median_time_us( [&]() {
+            for ( const auto& sym : view ) {
+                sum2 += sym.st_value + sym.st_size;
+            }
+        } );
+
+        std::vector<Elf64_Sym> copy;
+        double                 copied = benchmark::median_time_us( [&]() {
+            view.copy_to( copy );
+            for ( const auto& sym : copy ) {
+                sum3 += sym.st_value + sym.st_size;
+            }
+        } );
+
+        double fast_accessed = 0;
+        double fast_viewed   = 0;
+        if ( encoding == ELFDATA2LSB ) {
+            read_static<ELFDATA2LSB>( reader, sym_sec, fast_accessed,
+                                      fast_viewed, sum4, sum5 );
+        }
+        else {
+            read_static<ELFDATA2MSB>( reader, sym_sec, fast_accessed,
+                                      fast_viewed, sum4, sum5 );
+        }
+
+        // The sums are printed to keep the reads from being optimized away
+        bool matched = sum1 == sum2 && sum1 == sum3 && sum1 == sum4 &&
+                       sum1 == sum5;
+        std::cout << std::setw( 10 )
+                  << ( encoding == ELFDATA2LSB ? "LSB" : "MSB" ) << std::fixed
+                  << std::setprecision( 2 ) << std::setw( 12 )
+                  << accessor * 1000 / symbols_num << std::setw( 12 )
+                  << viewed * 1000 / symbols_num << std::setw( 12 )
+                  << copied * 1000 / symbols_num << std::setw( 12 )
+                  << fast_accessed * 1000 / symbols_num << std::setw( 14 )
+                  << fast_viewed * 1000 / symbols_num
+                  << ( matched ? "" : " (mismatch)" ) << std::endl;
+    }
+
+    std::vector<Elf64_Sym> source( symbols_num );
+    std::vector<Elf64_Sym> target( symbols_num );
+    for ( unsigned i = 0; i < symbols_num; ++i ) {
+        source[i].st_value = i;
+    }
+    double bytes = double( symbols_num ) * sizeof( Elf64_Sym );
+    double bulk  = benchmark::median_time_us( [&]() {
+        table_entry_swapper<Elf64_Sym>::swap( target.data(), source.data(),
+                                              symbols_num );
+    } );
+    double portable = benchmark::median_time_us( [&]() {
+        table_entry_swapper<Elf64_Sym>::swap_portable(
+            target.data(), source.data(), symbols_num );
+    } );
+    std::cout << std::endl
+              << "Byte order conversion, MB/s: bulk " << std::setprecision( 0 )
+              << bytes / bulk << ", portable " << bytes / portable
+              << std::endl;
+
+    return 0;
+}
@@ -477,6 +477,9 @@ constexpr Elf_Word EF_AMDGPU_MACH_AMDGCN_GFX1013       = 0x042;
 constexpr Elf_Word EF_AMDGPU_MACH_AMDGCN_FIRST = EF_AMDGPU_MACH_AMDGCN_GFX600;
 constexpr Elf_Word EF_AMDGPU_MACH_AMDGCN_LAST  = EF_AMDGPU_MACH_AMDGCN_GFX1013;
 
+// ARM specific e_flags
+constexpr Elf_Word EF_ARM_BE8 = 0x00800000; // Instructions are little-endian
+
 /////////////////////
 // Sections constants
 
@@ -560,6 +563,14 @@ constexpr Elf_Xword SHF_ORDERED     = 0x40000000;
 constexpr Elf_Xword SHF_EXCLUDE     = 0x80000000;
 constexpr Elf_Xword SHF_MASKPROC    = 0xF0000000;
 
+// Section compression types
+constexpr Elf_Word ELFCOMPRESS_ZLIB   = 1;
+constexpr Elf_Word ELFCOMPRESS_ZSTD   = 2;
+constexpr Elf_Word ELFCOMPRESS_LOOS   = 0x60000000;
+constexpr Elf_Word ELFCOMPRESS_HIOS   = 0x6FFFFFFF;
+constexpr Elf_Word ELFCOMPRESS_LOPROC = 0x70000000;
+constexpr Elf_Word ELFCOMPRESS_HIPROC = 0x7FFFFFFF;
+
 // Section group flags
 constexpr Elf_Word GRP_COMDAT   = 0x1;
 constexpr Elf_Word GRP_MASKOS   = 0x0ff00000;
@@ -826,6 +837,10 @@ constexpr unsigned R_ARM_NONE         = 0;
 constexpr unsigned R_ARM_PC24         = 1;
 constexpr unsigned R_ARM_ABS32        = 2;
 constexpr unsigned R_ARM_REL32        = 3;
+constexpr unsigned R_ARM_COPY         = 20;
+constexpr unsigned R_ARM_GLOB_DAT     = 21;
+constexpr unsigned R_ARM_JUMP_SLOT    = 22;
+constexpr unsigned R_ARM_RELATIVE     = 23;
 constexpr unsigned R_ARM_CALL         = 28;
 constexpr unsigned R_ARM_JUMP24       = 29;
 constexpr unsigned R_ARM_TARGET1      = 38;
@@ -32,10 +32,14 @@ THE SOFTWARE.
 #include <vector>
 #include <deque>
 #include <memory>
+#include <string_view>
+#include <unordered_map>
 
 #include <elfio/elf_types.hpp>
 #include <elfio/elfio_version.hpp>
 #include <elfio/elfio_utils.hpp>
+#include <elfio/elfio_mmap.hpp>
+#include <elfio/elfio_cache.hpp>
 #include <elfio/elfio_header.hpp>
 #include <elfio/elfio_section.hpp>
 #include <elfio/elfio_segment.hpp>
@@ -58,6 +62,34 @@ THE SOFTWARE.
 
 namespace ELFIO {
 
+//------------------------------------------------------------------------------
+//! \struct validation_error
+//! \brief A problem detected by elfio::get_validation_errors()
+struct validation_error
+{
+    //! \brief Kind of the problem
+    enum class kind
+    {
+        section_overlap,         //!< Two sections overlap in the file
+        segment_address_conflict //!< Segment and section addresses differ
+    };
+
+    kind     type;   //!< Kind of the problem
+    Elf_Half first;  //!< Index of the first section, or of the segment
+    Elf_Half second; //!< Index of the second (or the only) section
+    std::string message; //!< Human readable description
+};
+
+//------------------------------------------------------------------------------
+//! \brief Amount of the section information read by elfio::load()
+enum class load_profile
+{
+    full,           //!< Section headers and names are read on load
+    deferred_names, //!< Section names are read on first use
+    headers_only    //!< Only the ELF header and the segments are read.
+                    //!< The sections list stays empty
+};
+
 //------------------------------------------------------------------------------
 //! \class elfio
 //! \brief The elfio class represents an ELF file and provides methods to manipulate it.
@@ -70,6 +102,7 @@ class elfio
     {
         convertor       = std::make_shared<endianness_convertor>();
         addr_translator = std::make_shared<address_translator>();
+        names_version   = std::make_shared<size_t>( 0 );
         create( ELFCLASS32, ELFDATA2LSB );
     }
 
@@ -80,6 +113,9 @@ class elfio
     {
         this->compression =
             std::shared_ptr<compression_interface>( compression_ptr );
+        if ( compression ) {
+            compression->setup( get_class() );
+        }
     }
 
     //------------------------------------------------------------------------------
@@ -89,12 +125,19 @@ class elfio
         : sections( this ), segments( this ),
           current_file_pos( other.current_file_pos )
     {
-        header          = std::move( other.header );
-        sections_       = std::move( other.sections_ );
-        segments_       = std::move( other.segments_ );
-        convertor       = std::move( other.convertor );
-        addr_translator = std::move( other.addr_translator );
-        compression     = std::move( other.compression );
+        pstream            = std::move( other.pstream );
+        header             = std::move( other.header );
+        sections_          = std::move( other.sections_ );
+        segments_          = std::move( other.segments_ );
+        convertor          = std::move( other.convertor );
+        addr_translator    = std::move( other.addr_translator );
+        compression        = std::move( other.compression );
+        names_version      = std::move( other.names_version );
+        name_index         = std::move( other.name_index );
+        name_index_version = other.name_index_version.load();
+        threads_num        = other.threads_num;
+        cache              = std::move( other.cache );
+        profile            = other.profile;
 
         other.header = nullptr;
         other.sections_.clear();
@@ -109,13 +152,20 @@ class elfio
     elfio& operator=( elfio&& other ) noexcept
     {
         if ( this != &other ) {
-            header           = std::move( other.header );
-            sections_        = std::move( other.sections_ );
-            segments_        = std::move( other.segments_ );
-            convertor        = std::move( other.convertor );
-            addr_translator  = std::move( other.addr_translator );
-            current_file_pos = other.current_file_pos;
-            compression      = std::move( other.compression );
+            pstream            = std::move( other.pstream );
+            header             = std::move( other.header );
+            sections_          = std::move( other.sections_ );
+            segments_          = std::move( other.segments_ );
+            convertor          = std::move( other.convertor );
+            addr_translator    = std::move( other.addr_translator );
+            current_file_pos   = other.current_file_pos;
+            compression        = std::move( other.compression );
+            names_version      = std::move( other.names_version );
+            name_index         = std::move( other.name_index );
+            name_index_version = other.name_index_version.load();
+            threads_num        = other.threads_num;
+            cache              = std::move( other.cache );
+            profile            = other.profile;
 
             other.current_file_pos = 0;
             other.header           = nullptr;
@@ -138,9 +188,12 @@ class elfio
     //! \param encoding The encoding of the ELF file (ELFDATA2LSB or ELFDATA2MSB)
     void create( unsigned char file_class, unsigned char encoding )
     {
-        sections_.clear();
+        clear_sections();
         segments_.clear();
         ( *convertor ).setup( encoding );
+        if ( compression ) {
+            compression->setup( file_class );
+        }
         header = create_header( file_class, encoding );
         create_mandatory_sections();
     }
@@ -153,24 +206,86 @@ class elfio
         ( *addr_translator ).set_address_translation( addr_trans );
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Set the number of threads used for the section compression
+    //!        on save and for the section data loading of non-lazy loads.
+    //!        The compression interface has to allow concurrent deflate()
+    //!        and inflate() calls when more than one thread is used
+    //! \param value Number of threads. 1 (the default) means no extra threads
+    void set_threads_num( unsigned value )
+    {
+        threads_num = value > 0 ? value : 1;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the number of threads used for the section compression
+    //!        and loading
+    //! \return Number of threads
+    unsigned get_threads_num() const { return threads_num; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the amount of the section information read by load().
+    //!        Deferring or skipping the sections speeds up loads that
+    //!        need only the ELF header and the segments
+    //! \param value The load profile. load_profile::full is the default
+    void set_load_profile( load_profile value ) { profile = value; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the amount of the section information read by load()
+    //! \return The load profile
+    load_profile get_load_profile() const { return profile; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the cache tracking the data of lazily loaded sections and
+    //!        segments. The cache may be shared by several elfio objects.
+    //!        It takes effect on the next load
+    //! \param value The data cache, or nullptr to keep all loaded data
+    void set_data_cache( std::shared_ptr<data_cache> value )
+    {
+        cache = std::move( value );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the cache tracking the data of lazily loaded sections
+    //! \return The data cache, or nullptr if none is set
+    std::shared_ptr<data_cache> get_data_cache() const { return cache; }
+
     //------------------------------------------------------------------------------
     //! \brief Load an ELF file from a file
+    //!
+    //! When more than one thread is set by set_threads_num() and the file
+    //! is not loaded lazily, the section data is read with positional reads
+    //! and decompressed by several threads. Lazily loaded data is read with
+    //! positional reads as well, so different threads may call get_data()
+    //! of different sections without waiting for each other
     //! \param file_name The name of the file to load
     //! \param is_lazy Whether to load the file lazily
     //! \return True if successful, false otherwise
     bool load( const std::string& file_name, bool is_lazy = false )
     {
-        pstream = std::make_unique<std::ifstream>();
-        if ( !pstream ) {
+        auto file = std::make_unique<std::ifstream>();
+        if ( !file ) {
             return false;
         }
 
-        pstream->open( file_name.c_str(), std::ios::in | std::ios::binary );
-        if ( !*pstream ) {
+        file->open( file_name.c_str(), std::ios::in | std::ios::binary );
+        if ( !*file ) {
             return false;
         }
+        pstream = std::move( file );
+
+        load_context context;
+        context.stream  = pstream.get();
+        context.is_lazy = is_lazy;
+        if ( ( is_lazy || threads_num > 1 ) &&
+             positional_file::is_supported() ) {
+            auto reader = std::make_shared<positional_file>();
+            if ( reader->open( file_name ) ) {
+                context.file = std::move( reader );
+            }
+        }
 
-        bool ret = load( *pstream, is_lazy );
+        bool ret = load( context );
 
         if ( !is_lazy ) {
             pstream.reset();
@@ -180,49 +295,55 @@ class elfio
     }
 
     //------------------------------------------------------------------------------
-    //! \brief Load an ELF file from a stream
-    //! \param stream The input stream to load from
+    //! \brief Load an ELF file by mapping it into memory
+    //!
+    //! Section and segment data returned by get_data() points directly into
+    //! a private copy-on-write mapping of the file. Data is copied only when
+    //! it is modified by set_data(), insert_data() or append_data().
+    //! Falls back to load() if memory mapping is not supported by the platform
+    //! \param file_name The name of the file to load
     //! \param is_lazy Whether to load the file lazily
     //! \return True if successful, false otherwise
-    bool load( std::istream& stream, bool is_lazy = false )
+    bool load_mapped( const std::string& file_name, bool is_lazy = false )
     {
-        sections_.clear();
-        segments_.clear();
-
-        std::array<char, EI_NIDENT> e_ident = { 0 };
-        // Read ELF file signature
-        stream.seekg( ( *addr_translator )[0] );
-        stream.read( e_ident.data(), sizeof( e_ident ) );
-
-        // Is it ELF file?
-        if ( stream.gcount() != sizeof( e_ident ) ||
-             e_ident[EI_MAG0] != ELFMAG0 || e_ident[EI_MAG1] != ELFMAG1 ||
-             e_ident[EI_MAG2] != ELFMAG2 || e_ident[EI_MAG3] != ELFMAG3 ) {
-            return false;
+        if ( !mapped_file::is_supported() ) {
+            return load( file_name, is_lazy );
         }
 
-        if ( ( e_ident[EI_CLASS] != ELFCLASS64 ) &&
-             ( e_ident[EI_CLASS] != ELFCLASS32 ) ) {
+        auto mapping = std::make_shared<mapped_file>();
+        if ( !mapping->open( file_name ) ) {
             return false;
         }
 
-        if ( ( e_ident[EI_DATA] != ELFDATA2LSB ) &&
-             ( e_ident[EI_DATA] != ELFDATA2MSB ) ) {
-            return false;
-        }
+        pstream = std::make_unique<memory_istream>( mapping->get_data(),
+                                                    mapping->get_size() );
 
-        ( *convertor ).setup( e_ident[EI_DATA] );
-        header = create_header( e_ident[EI_CLASS], e_ident[EI_DATA] );
-        if ( nullptr == header ) {
-            return false;
-        }
-        if ( !header->load( stream ) ) {
-            return false;
+        load_context context;
+        context.stream  = pstream.get();
+        context.is_lazy = is_lazy;
+        context.mapping = std::move( mapping );
+
+        bool ret = load( context );
+
+        if ( !is_lazy ) {
+            pstream.reset();
         }
 
-        load_sections( stream, is_lazy );
-        bool is_still_good = load_segments( stream, is_lazy );
-        return is_still_good;
+        return ret;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Load an ELF file from a stream
+    //! \param stream The input stream to load from
+    //! \param is_lazy Whether to load the file lazily
+    //! \return True if successful, false otherwise
+    bool load( std::istream& stream, bool is_lazy = false )
+    {
+        load_context context;
+        context.stream  = &stream;
+        context.is_lazy = is_lazy;
+
+        return load( context );
     }
 
     //------------------------------------------------------------------------------
@@ -242,41 +363,103 @@ class elfio
 
     //------------------------------------------------------------------------------
     //! \brief Save the ELF file to a stream
+    //!
+    //! By default the file layout is computed first and the file is emitted
+    //! in one sequential pass. Otherwise, or when file blocks overlap, every
+    //! header and data block is written at its position separately
     //! \param stream The output stream to save to
+    //! Sections with SHF_COMPRESSED or SHF_RPX_DEFLATE flags are compressed
+    //! before the layout is computed, using get_threads_num() threads
+    //! \param is_sequential Write the file in one sequential pass
     //! \return True if successful, false otherwise
-    bool save( std::ostream& stream )
+    bool save( std::ostream& stream, bool is_sequential = true )
     {
         if ( !stream || header == nullptr ) {
             return false;
         }
 
-        // Define layout specific header fields
-        // The position of the segment table is fixed after the header.
-        // The position of the section table is variable and needs to be fixed
-        // before saving.
-        header->set_segments_num( segments.size() );
-        header->set_segments_offset(
-            segments.size() > 0 ? header->get_header_size() : 0 );
-        header->set_sections_num( sections.size() );
-        header->set_sections_offset( 0 );
+        // Data released by the data cache is loaded again for the save.
+        // It is kept until written, as the blocks are gathered first
+        std::vector<data_pin<section>> pins;
+        pins.reserve( sections_.size() );
+        for ( const auto& sec : sections_ ) {
+            pins.emplace_back( sec.get() );
+        }
 
-        // Layout the first section right after the segment table
-        current_file_pos =
-            header->get_header_size() +
-            header->get_segment_entry_size() *
-                static_cast<Elf_Xword>( header->get_segments_num() );
+        // The compressed section sizes are needed for the layout
+        bool is_still_good = compress_sections();
+        is_still_good = is_still_good && save_layout( stream, is_sequential );
+        release_compressed_sections();
 
-        calc_segment_alignment();
+        return is_still_good;
+    }
 
-        bool is_still_good = layout_segments_and_their_sections();
-        is_still_good = is_still_good && layout_sections_without_segments();
-        is_still_good = is_still_good && layout_section_table();
+    //------------------------------------------------------------------------------
+    //! \brief Save the changes to the ELF file they were loaded from
+    //!
+    //! Only the changed headers and the section data modified by
+    //! set_data(), insert_data(), append_data() or marked by
+    //! section::mark_data_modified() are overwritten. When only parts of
+    //! the data were marked, only those bytes are written. This is possible
+    //! only when the file layout is unchanged: no sections or segments were
+    //! added and no section or segment was moved or resized
+    //! \param file_name The name of the file to update
+    //! \return True if successful, false otherwise
+    bool save_in_place( const std::string& file_name )
+    {
+        std::fstream stream;
+        stream.open( file_name.c_str(),
+                     std::ios::in | std::ios::out | std::ios::binary );
+        if ( !stream ) {
+            return false;
+        }
 
-        is_still_good = is_still_good && save_header( stream );
-        is_still_good = is_still_good && save_sections( stream );
-        is_still_good = is_still_good && save_segments( stream );
+        return save_in_place( stream );
+    }
 
-        return is_still_good;
+    //------------------------------------------------------------------------------
+    //! \brief Save the changes to a stream holding the loaded ELF file
+    //! \param stream The output stream containing the file
+    //! \return True if successful, false otherwise.
+    //!         Nothing is written when false is returned
+    bool save_in_place( std::ostream& stream )
+    {
+        if ( !stream || header == nullptr || !addr_translator->empty() ||
+             sections.size() != header->get_sections_num() ||
+             segments.size() != header->get_segments_num() ) {
+            return false;
+        }
+
+        output_chunks chunks;
+        if ( !header->gather_changes( chunks ) ) {
+            return false;
+        }
+        for ( const auto& sec : sections_ ) {
+            Elf64_Off header_offset =
+                header->get_sections_offset() +
+                Elf64_Off( header->get_section_entry_size() ) *
+                    sec->get_index();
+            if ( !sec->gather_changes( chunks, header_offset ) ) {
+                return false;
+            }
+        }
+        for ( const auto& seg : segments_ ) {
+            Elf64_Off header_offset =
+                header->get_segments_offset() +
+                Elf64_Off( header->get_segment_entry_size() ) *
+                    seg->get_index();
+            if ( !seg->gather_changes( chunks, header_offset ) ) {
+                return false;
+            }
+        }
+
+        if ( !chunks.sort() || !chunks.write_in_place( stream ) ||
+             !stream.flush() ) {
+            return false;
+        }
+
+        set_saved();
+        return true;
     }
 
     //------------------------------------------------------------------------------
@@ -352,30 +535,30 @@ class elfio
     //! \return An empty string if no problems are detected, or a string containing an error message if problems are found, with one error per line.
     std::string validate() const
     {
-        // clang-format off
-
         std::string errors;
+        for ( const auto& error : get_validation_errors() ) {
+            errors += error.message + "\n";
+        }
+
+        return errors;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Validate the ELF file
+    //! \return List of detected problems, empty if the file is consistent
+    std::vector<validation_error> get_validation_errors() const
+    {
+        std::vector<validation_error> errors;
+
         // Check for overlapping sections in the file
         // This is explicitly forbidden by ELF specification
-        for ( int i = 0; i < sections.size(); ++i) {
-            for ( int j = i+1; j < sections.size(); ++j ) {
-                const section* a = sections[i];
-                const section* b = sections[j];
-                if (   ( ( a->get_type() & SHT_NOBITS) == 0 )
-                    && ( ( b->get_type() & SHT_NOBITS) == 0 )
-                      && ( a->get_size() > 0 )
-                      && ( b->get_size() > 0 )
-                      && ( a->get_offset() > 0 )
-                      && ( b->get_offset() > 0 )
-                      && ( is_offset_in_section( a->get_offset(), b )
-                        || is_offset_in_section( a->get_offset()+a->get_size()-1, b )
-                        || is_offset_in_section( b->get_offset(), a )
-                        || is_offset_in_section( b->get_offset()+b->get_size()-1, a ) ) ) {
-                            errors += "Sections " + a->get_name() + " and " + b->get_name() + " overlap in file\n";
-                }
-            }
+        for ( const auto& [i, j] : find_overlapping_sections() ) {
+            const section* a = sections[i];
+            const section* b = sections[j];
+            errors.push_back( { validation_error::kind::section_overlap, i, j,
+                                "Sections " + a->get_name() + " and " +
+                                    b->get_name() + " overlap in file" } );
         }
-        // clang-format on
 
         // Check for conflicting section / program header tables, where
         // the same offset has different vaddresses in section table and
@@ -385,23 +568,27 @@ class elfio
         // - it doesn't make any sense
         // - ELFIO relies on this being consistent when writing ELF files,
         //   since offsets are re-calculated from vaddress
-        for ( int h = 0; h < segments.size(); ++h ) {
+        prog_section_index prog_sections( sections_ );
+        for ( Elf_Half h = 0; h < segments.size(); ++h ) {
             const segment* seg = segments[h];
-            const section* sec =
-                find_prog_section_for_offset( seg->get_offset() );
-            if ( seg->get_type() == PT_LOAD && seg->get_file_size() > 0 &&
-                 sec != nullptr ) {
-                Elf64_Addr sec_addr =
-                    get_virtual_addr( seg->get_offset(), sec );
-                if ( sec_addr != seg->get_virtual_address() ) {
-                    errors += "Virtual address of segment " +
-                              std::to_string( h ) + " (" +
-                              to_hex_string( seg->get_virtual_address() ) +
-                              ")" + " conflicts with address of section " +
-                              sec->get_name() + " (" +
-                              to_hex_string( sec_addr ) + ")" + " at offset " +
-                              to_hex_string( seg->get_offset() ) + "\n";
-                }
+            if ( seg->get_type() != PT_LOAD || seg->get_file_size() == 0 ) {
+                continue;
+            }
+            const section* sec = prog_sections.find( seg->get_offset() );
+            if ( sec == nullptr ) {
+                continue;
+            }
+            Elf64_Addr sec_addr = get_virtual_addr( seg->get_offset(), sec );
+            if ( sec_addr != seg->get_virtual_address() ) {
+                errors.push_back(
+                    { validation_error::kind::segment_address_conflict, h,
+                      sec->get_index(),
+                      "Virtual address of segment " + std::to_string( h ) +
+                          " (" + to_hex_string( seg->get_virtual_address() ) +
+                          ")" + " conflicts with address of section " +
+                          sec->get_name() + " (" + to_hex_string( sec_addr ) +
+                          ")" + " at offset " +
+                          to_hex_string( seg->get_offset() ) } );
             }
         }
 
@@ -411,6 +598,81 @@ class elfio
     }
 
   private:
+    //------------------------------------------------------------------------------
+    //! \brief Load an ELF file using the given load parameters
+    //! \param context Load parameters shared by all sections and segments.
+    //!                The stream size is determined here, once per file
+    //! \return True if successful, false otherwise
+    bool load( load_context context )
+    {
+        std::istream& stream = *context.stream;
+
+        clear_sections();
+        segments_.clear();
+
+        if ( addr_translator->empty() ) {
+            stream.seekg( 0, std::istream::end );
+            context.stream_size = size_t( stream.tellg() );
+        }
+        else {
+            context.stream_size = std::numeric_limits<size_t>::max();
+        }
+
+        std::array<char, EI_NIDENT> e_ident = { 0 };
+        // Read ELF file signature
+        stream.seekg( ( *addr_translator )[0] );
+        stream.read( e_ident.data(), sizeof( e_ident ) );
+
+        // Is it ELF file?
+        if ( stream.gcount() != sizeof( e_ident ) ||
+             e_ident[EI_MAG0] != ELFMAG0 || e_ident[EI_MAG1] != ELFMAG1 ||
+             e_ident[EI_MAG2] != ELFMAG2 || e_ident[EI_MAG3] != ELFMAG3 ) {
+            return false;
+        }
+
+        if ( ( e_ident[EI_CLASS] != ELFCLASS64 ) &&
+             ( e_ident[EI_CLASS] != ELFCLASS32 ) ) {
+            return false;
+        }
+
+        if ( ( e_ident[EI_DATA] != ELFDATA2LSB ) &&
+             ( e_ident[EI_DATA] != ELFDATA2MSB ) ) {
+            return false;
+        }
+
+        ( *convertor ).setup( e_ident[EI_DATA] );
+        if ( compression ) {
+            compression->setup( e_ident[EI_CLASS] );
+        }
+        header = create_header( e_ident[EI_CLASS], e_ident[EI_DATA] );
+        if ( nullptr == header ) {
+            return false;
+        }
+        if ( !header->load( stream ) ) {
+            return false;
+        }
+
+        context.is_deferred = !context.is_lazy && threads_num > 1;
+        if ( context.is_lazy ) {
+            // Data read on demand from several threads has to share
+            // the stream position
+            context.stream_mutex = std::make_shared<std::mutex>();
+            context.cache        = cache;
+        }
+        if ( profile != load_profile::headers_only ) {
+            load_sections( context );
+        }
+        if ( context.is_deferred ) {
+            load_deferred_sections( context );
+        }
+        bool is_still_good = load_segments( context );
+        if ( profile == load_profile::full ) {
+            // Lookups by name of a loaded file only read the index
+            update_name_index();
+        }
+        return is_still_good;
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Check if an offset is within a section
     //! \param offset The offset to check
@@ -433,18 +695,191 @@ class elfio
     }
 
     //------------------------------------------------------------------------------
-    //! \brief Find the section that contains a given offset
-    //! \param offset The offset to find
-    //! \return Pointer to the section that contains the offset, or nullptr if not found
-    const section* find_prog_section_for_offset( Elf64_Off offset ) const
+    //! \class prog_section_index
+    //! \brief Segment tree of the PROGBITS sections over their file ranges.
+    //!
+    //! The section bounds split the file into elementary ranges, the leaves
+    //! of the tree. Every section is stored in the O(log n) nodes covering
+    //! its range, and each node keeps the section of the lowest index
+    class prog_section_index
+    {
+      public:
+        //------------------------------------------------------------------------------
+        //! \brief Constructor
+        //! \param all_sections Sections of the file
+        explicit prog_section_index(
+            const std::vector<std::unique_ptr<section>>& all_sections )
+        {
+            std::vector<std::pair<Elf64_Off, Elf64_Off>> ranges;
+            std::vector<const section*>                 secs;
+            for ( const auto& sec : all_sections ) {
+                Elf64_Off start = sec->get_offset();
+                Elf64_Off end   = start + sec->get_size();
+                // is_offset_in_section() never matches a section whose end
+                // wraps around
+                if ( sec->get_type() == SHT_PROGBITS && end > start ) {
+                    ranges.emplace_back( start, end );
+                    secs.push_back( sec.get() );
+                    bounds.push_back( start );
+                    bounds.push_back( end );
+                }
+            }
+            std::sort( bounds.begin(), bounds.end() );
+            bounds.erase( std::unique( bounds.begin(), bounds.end() ),
+                          bounds.end() );
+
+            leaves = 1;
+            while ( leaves < bounds.size() ) {
+                leaves *= 2;
+            }
+            nodes.assign( 2 * leaves, nullptr );
+            for ( size_t i = 0; i < secs.size(); ++i ) {
+                size_t first = bound_position( ranges[i].first ) + leaves;
+                size_t last  = bound_position( ranges[i].second ) + leaves;
+                for ( ; first < last; first /= 2, last /= 2 ) {
+                    if ( first % 2 != 0 ) {
+                        keep_lowest( nodes[first++], secs[i] );
+                    }
+                    if ( last % 2 != 0 ) {
+                        keep_lowest( nodes[--last], secs[i] );
+                    }
+                }
+            }
+        }
+
+        //------------------------------------------------------------------------------
+        //! \brief Find the section that contains a given offset
+        //!
+        //! Same result as a scan of the section table: the section with
+        //! the lowest index wins if several sections contain the offset
+        //! \param offset The offset to find
+        //! \return Pointer to the section that contains the offset, or nullptr if not found
+        const section* find( Elf64_Off offset ) const
+        {
+            // The elementary range starting at the last bound not above
+            // the offset
+            auto it = std::upper_bound( bounds.begin(), bounds.end(), offset );
+            if ( it == bounds.begin() ) {
+                return nullptr;
+            }
+
+            const section* found = nullptr;
+            for ( size_t node = size_t( it - bounds.begin() ) - 1 + leaves;
+                  node > 0; node /= 2 ) {
+                if ( nodes[node] != nullptr ) {
+                    keep_lowest( found, nodes[node] );
+                }
+            }
+
+            return found;
+        }
+
+      private:
+        //------------------------------------------------------------------------------
+        //! \brief Get the position of a section bound
+        //! \param value The bound
+        //! \return Position of the bound in the sorted bounds
+        size_t bound_position( Elf64_Off value ) const
+        {
+            return size_t(
+                std::lower_bound( bounds.begin(), bounds.end(), value ) -
+                bounds.begin() );
+        }
+
+        //------------------------------------------------------------------------------
+        //! \brief Keep the section of the lower index
+        //! \param kept The kept section, or nullptr
+        //! \param sec The candidate section
+        static void keep_lowest( const section*& kept, const section* sec )
+        {
+            if ( kept == nullptr || sec->get_index() < kept->get_index() ) {
+                kept = sec;
+            }
+        }
+
+        std::vector<Elf64_Off>      bounds; //!< Sorted distinct section bounds
+        std::vector<const section*> nodes;  //!< Tree of the lowest sections
+        size_t                      leaves = 1; //!< Number of leaves of nodes
+    };
+
+    //------------------------------------------------------------------------------
+    //! \brief Find the pairs of sections overlapping in the file
+    //!
+    //! The sections are swept in the order of their offsets, so only the
+    //! sections still open at a section start are compared with it
+    //! \return Pairs of section indices, sorted, lower index first
+    std::vector<std::pair<Elf_Half, Elf_Half>> find_overlapping_sections() const
     {
-        for ( const auto& sec : sections ) {
-            if ( sec->get_type() == SHT_PROGBITS &&
-                 is_offset_in_section( offset, sec.get() ) ) {
-                return sec.get();
+        std::vector<std::pair<Elf_Half, Elf_Half>> pairs;
+
+        auto end_of = []( const section* sec ) {
+            return sec->get_offset() + sec->get_size();
+        };
+        auto wraps = [&end_of]( const section* sec ) {
+            return end_of( sec ) < sec->get_offset();
+        };
+        auto add_pair = [&pairs]( const section* a, const section* b ) {
+            pairs.emplace_back( std::min( a->get_index(), b->get_index() ),
+                                std::max( a->get_index(), b->get_index() ) );
+        };
+
+        std::vector<const section*> candidates;
+        std::vector<const section*> wrapping;
+        for ( const auto& sec : sections_ ) {
+            if ( ( sec->get_type() & SHT_NOBITS ) != 0 ||
+                 sec->get_size() == 0 || sec->get_offset() == 0 ) {
+                continue;
+            }
+            // Sections with an end beyond the address space are compared
+            // one by one to keep the diagnostics of the original check
+            if ( wraps( sec.get() ) ) {
+                wrapping.push_back( sec.get() );
+            }
+            else {
+                candidates.push_back( sec.get() );
             }
         }
-        return nullptr;
+
+        for ( size_t i = 0; i < wrapping.size(); ++i ) {
+            const section* a = wrapping[i];
+            auto           check = [&]( const section* b ) {
+                if ( is_offset_in_section( a->get_offset(), b ) ||
+                     is_offset_in_section( end_of( a ) - 1, b ) ||
+                     is_offset_in_section( b->get_offset(), a ) ||
+                     is_offset_in_section( end_of( b ) - 1, a ) ) {
+                    add_pair( a, b );
+                }
+            };
+            std::for_each( candidates.begin(), candidates.end(), check );
+            std::for_each( wrapping.begin() + i + 1, wrapping.end(), check );
+        }
+
+        std::sort( candidates.begin(), candidates.end(),
+                   []( const section* a, const section* b ) {
+                       return a->get_offset() < b->get_offset();
+                   } );
+
+        // Sections covering the current offset, the one ending first is on
+        // top of the heap
+        auto ends_later = [&end_of]( const section* a, const section* b ) {
+            return end_of( a ) > end_of( b );
+        };
+        std::vector<const section*> open;
+        for ( const section* b : candidates ) {
+            while ( !open.empty() &&
+                    end_of( open.front() ) <= b->get_offset() ) {
+                std::pop_heap( open.begin(), open.end(), ends_later );
+                open.pop_back();
+            }
+            for ( const section* a : open ) {
+                add_pair( a, b );
+            }
+            open.push_back( b );
+            std::push_heap( open.begin(), open.end(), ends_later );
+        }
+
+        std::sort( pairs.begin(), pairs.end() );
+        return pairs;
     }
 
     //------------------------------------------------------------------------------
@@ -479,15 +914,17 @@ class elfio
     //! \return Pointer to the created section
     section* create_section()
     {
+        ++*names_version;
+
         if ( auto file_class = get_class(); file_class == ELFCLASS64 ) {
             sections_.emplace_back(
                 new ( std::nothrow ) section_impl<Elf64_Shdr>(
-                    convertor, addr_translator, compression ) );
+                    convertor, addr_translator, compression, names_version ) );
         }
         else if ( file_class == ELFCLASS32 ) {
             sections_.emplace_back(
                 new ( std::nothrow ) section_impl<Elf32_Shdr>(
-                    convertor, addr_translator, compression ) );
+                    convertor, addr_translator, compression, names_version ) );
         }
         else {
             sections_.pop_back();
@@ -500,6 +937,55 @@ class elfio
         return new_section;
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Remove all sections
+    void clear_sections()
+    {
+        // The name index refers to the names stored in the sections
+        ++*names_version;
+        name_index.clear();
+        sections_.clear();
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Find a section by name using the name index
+    //!
+    //! The index is built on first use and rebuilt after a section
+    //! was added or renamed
+    //! \param name The name of the section
+    //! \return Pointer to the first section with this name, or nullptr
+    section* find_section( std::string_view name ) const
+    {
+        if ( sections_.empty() ) {
+            return nullptr;
+        }
+
+        update_name_index();
+
+        auto it = name_index.find( name );
+        return it != name_index.end() ? sections_[it->second].get() : nullptr;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Rebuild the name index if a section was added or renamed
+    void update_name_index() const
+    {
+        if ( name_index_version != *names_version ) {
+            // Concurrent lookups wait for a single rebuild
+            std::lock_guard<std::mutex> lock( name_index_mutex );
+            if ( name_index_version == *names_version ) {
+                return;
+            }
+            name_index.clear();
+            name_index.reserve( sections_.size() );
+            for ( size_t i = 0; i < sections_.size(); ++i ) {
+                // The first section wins for duplicated names
+                name_index.emplace( sections_[i]->get_name(), i );
+            }
+            name_index_version = *names_version;
+        }
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Create a new segment
     //! \return Pointer to the created segment
@@ -545,10 +1031,9 @@ class elfio
 
     //------------------------------------------------------------------------------
     //! \brief Load sections from a stream
-    //! \param stream The input stream to load from
-    //! \param is_lazy Whether to load the sections lazily
+    //! \param context Load parameters shared by all sections
     //! \return True if successful, false otherwise
-    bool load_sections( std::istream& stream, bool is_lazy )
+    bool load_sections( const load_context& context )
     {
         unsigned char file_class = header->get_class();
         Elf_Half      entry_size = header->get_section_entry_size();
@@ -562,15 +1047,20 @@ class elfio
             return false;
         }
 
+        std::vector<char> table;
+        size_t            table_read =
+            read_header_table( context, offset, num, entry_size, table );
+
         for ( Elf_Half i = 0; i < num; ++i ) {
             section* sec = create_section();
 
-            // Load return value is ignored here
+            // Headers located beyond the read part of the table are loaded
+            // as zeroes. Load return value is ignored here
             // This allows retrieval of information from corrupted sections
-            sec->load( stream,
-                       static_cast<std::streamoff>( offset ) +
-                           static_cast<std::streampos>( i ) * entry_size,
-                       is_lazy );
+            std::array<char, sizeof( Elf64_Shdr )> entry = {};
+            copy_header_entry( table, table_read, size_t( i ) * entry_size,
+                               entry.data(), entry.size() );
+            sec->load( context, entry.data() );
             // To mark that the section is not permitted to reassign address
             // during layout calculation
             sec->set_address( sec->get_address() );
@@ -578,6 +1068,14 @@ class elfio
 
         if ( Elf_Half shstrndx = get_section_name_str_index();
              SHN_UNDEF != shstrndx ) {
+            if ( profile == load_profile::deferred_names ) {
+                // The string table is read when a name is used first
+                for ( Elf_Half i = 0; i < num; ++i ) {
+                    sections[i]->defer_name( sections[shstrndx] );
+                }
+                return true;
+            }
+
             string_section_accessor str_reader( sections[shstrndx] );
             for ( Elf_Half i = 0; i < num; ++i ) {
                 Elf_Word section_offset = sections[i]->get_name_string_offset();
@@ -591,6 +1089,119 @@ class elfio
         return true;
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Read and decompress the section data deferred by load_sections()
+    //!
+    //! Positional reads of a file or a memory mapping allow reading several
+    //! sections at once. Otherwise the data is read from the stream one
+    //! section after another and only the decompression is done in parallel
+    //! \param context Load parameters
+    void load_deferred_sections( const load_context& context )
+    {
+        std::vector<section*> work;
+        for ( const auto& sec : sections_ ) {
+            if ( sec->get_type() != SHT_NULL &&
+                 sec->get_type() != SHT_NOBITS ) {
+                work.push_back( sec.get() );
+            }
+        }
+        // The largest sections go first to balance the workers' load
+        std::stable_sort( work.begin(), work.end(),
+                          []( const section* a, const section* b ) {
+                              return a->get_size() > b->get_size();
+                          } );
+
+        if ( context.file || context.mapping ) {
+            const positional_file* file = context.file.get();
+            parallel_for( work.size(), threads_num, [&]( size_t i ) {
+                work[i]->load_deferred_data( file );
+                work[i]->inflate_data();
+            } );
+        }
+        else {
+            for ( section* sec : work ) {
+                sec->load_deferred_data( nullptr );
+            }
+            parallel_for( work.size(), threads_num,
+                          [&]( size_t i ) { work[i]->inflate_data(); } );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read a section or program header table with a single read
+    //! \param context Load parameters
+    //! \param offset File offset of the table
+    //! \param num Number of entries in the table
+    //! \param entry_size Size of a table entry
+    //! \param table Buffer receiving the table contents
+    //! \return Number of bytes actually read into the buffer
+    size_t read_header_table( const load_context& context,
+                              Elf64_Off           offset,
+                              Elf_Half            num,
+                              Elf_Half            entry_size,
+                              std::vector<char>&  table ) const
+    {
+        size_t table_size = size_t( num ) * entry_size;
+        if ( addr_translator->empty() ) {
+            // Do not allocate more than the stream is able to provide
+            if ( offset >= context.stream_size ) {
+                return 0;
+            }
+            table_size = std::min<size_t>( table_size, context.stream_size -
+                                                           size_t( offset ) );
+        }
+        table.resize( table_size );
+
+        std::istream&        stream     = *context.stream;
+        const auto&          translator = *addr_translator;
+        const std::streampos first      = translator[offset];
+        std::streamsize      read_size  = 0;
+        if ( table_size == 0 ||
+             translator[offset + table_size - 1] ==
+                 first + std::streamoff( table_size - 1 ) ) {
+            stream.seekg( first );
+            stream.read( table.data(), std::streamsize( table_size ) );
+            read_size = stream.gcount();
+        }
+        else {
+            // The table spans several translated ranges, read it entry by
+            // entry
+            for ( size_t pos = 0; pos < table_size && stream.good();
+                  pos += entry_size ) {
+                size_t size = std::min<size_t>( entry_size, table_size - pos );
+                stream.seekg( translator[offset + pos] );
+                stream.read( table.data() + pos, std::streamsize( size ) );
+                read_size += stream.gcount();
+            }
+        }
+
+        return size_t( read_size );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Copy a single header from a header table buffer
+    //! \param table Header table buffer
+    //! \param table_read Number of valid bytes in the buffer
+    //! \param pos Position of the header in the buffer
+    //! \param header Destination buffer
+    //! \param header_size Size of the header
+    //! \return True if the whole header was available, false otherwise
+    static bool copy_header_entry( const std::vector<char>& table,
+                                   size_t                   table_read,
+                                   size_t                   pos,
+                                   char*                    header,
+                                   size_t                   header_size )
+    {
+        if ( pos >= table_read ) {
+            return false;
+        }
+
+        size_t available = std::min( header_size, table_read - pos );
+        std::copy( table.data() + pos, table.data() + pos + available,
+                   header );
+        return available == header_size;
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Checks whether the addresses of the section entirely fall within the given segment.
     //! It doesn't matter if the addresses are memory addresses, or file offsets,
@@ -613,12 +1224,30 @@ class elfio
         //           sect_begin=12, sect_size=0  -> shall return false!
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Find the sections starting within the given address range
+    //! \param starts Section start addresses and positions, sorted
+    //! \param begin The beginning of the range
+    //! \param end The end of the range (exclusive)
+    //! \param found Receives positions of the found sections
+    static void find_section_starts(
+        const std::vector<std::pair<Elf64_Off, size_t>>& starts,
+        Elf64_Off                                        begin,
+        Elf64_Off                                        end,
+        std::vector<size_t>&                             found )
+    {
+        auto it = std::lower_bound( starts.begin(), starts.end(),
+                                    std::make_pair( begin, size_t( 0 ) ) );
+        for ( ; it != starts.end() && it->first < end; ++it ) {
+            found.push_back( it->second );
+        }
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Load segments from a stream
-    //! \param stream The input stream to load from
-    //! \param is_lazy Whether to load the segments lazily
+    //! \param context Load parameters shared by all segments
     //! \return True if successful, false otherwise
-    bool load_segments( std::istream& stream, bool is_lazy )
+    bool load_segments( const load_context& context )
     {
         unsigned char file_class = header->get_class();
         Elf_Half      entry_size = header->get_segment_entry_size();
@@ -632,6 +1261,28 @@ class elfio
             return false;
         }
 
+        std::vector<char> table;
+        size_t            table_read =
+            read_header_table( context, offset, num, entry_size, table );
+
+        // Section start positions sorted once for all segments.
+        // SHF_ALLOC sections are matched based on the virtual address
+        // otherwise the file offset is matched
+        std::vector<std::pair<Elf64_Off, size_t>> alloc_starts;
+        std::vector<std::pair<Elf64_Off, size_t>> offset_starts;
+        for ( size_t j = 0; j < sections.size(); ++j ) {
+            const section* psec = sections[j];
+            if ( ( psec->get_flags() & SHF_ALLOC ) == SHF_ALLOC ) {
+                alloc_starts.emplace_back( psec->get_address(), j );
+            }
+            else {
+                offset_starts.emplace_back( psec->get_offset(), j );
+            }
+        }
+        std::sort( alloc_starts.begin(), alloc_starts.end() );
+        std::sort( offset_starts.begin(), offset_starts.end() );
+        std::vector<size_t> candidates;
+
         for ( Elf_Half i = 0; i < num; ++i ) {
             if ( file_class == ELFCLASS64 ) {
                 segments_.emplace_back( new ( std::nothrow )
@@ -650,11 +1301,15 @@ class elfio
 
             segment* seg = segments_.back().get();
 
-            if ( !seg->load( stream,
-                             static_cast<std::streamoff>( offset ) +
-                                 static_cast<std::streampos>( i ) * entry_size,
-                             is_lazy ) ||
-                 stream.fail() ) {
+            std::array<char, sizeof( Elf64_Phdr )> entry = {};
+            size_t header_size = ( file_class == ELFCLASS64 )
+                                     ? sizeof( Elf64_Phdr )
+                                     : sizeof( Elf32_Phdr );
+            if ( !copy_header_entry( table, table_read,
+                                     size_t( i ) * entry_size, entry.data(),
+                                     header_size ) ||
+                 !seg->load( context, entry.data() ) ||
+                 context.stream->fail() ) {
                 segments_.pop_back();
                 return false;
             }
@@ -666,9 +1321,16 @@ class elfio
             Elf64_Off segEndOffset  = segBaseOffset + seg->get_file_size();
             Elf64_Off segVBaseAddr  = seg->get_virtual_address();
             Elf64_Off segVEndAddr   = segVBaseAddr + seg->get_memory_size();
-            for ( const auto& psec : sections ) {
-                // SHF_ALLOC sections are matched based on the virtual address
-                // otherwise the file offset is matched
+            // Only the sections starting inside of the segment may belong
+            // to it. They are processed in the order of the section table
+            candidates.clear();
+            find_section_starts( alloc_starts, segVBaseAddr, segVEndAddr,
+                                 candidates );
+            find_section_starts( offset_starts, segBaseOffset, segEndOffset,
+                                 candidates );
+            std::sort( candidates.begin(), candidates.end() );
+            for ( size_t j : candidates ) {
+                const section* psec = sections[j];
                 if ( ( ( psec->get_flags() & SHF_ALLOC ) == SHF_ALLOC )
                          ? is_sect_in_seg( psec->get_address(),
                                            psec->get_size(), segVBaseAddr,
@@ -739,21 +1401,145 @@ class elfio
     }
 
     //------------------------------------------------------------------------------
-    //! \brief Check if a section is without a segment
-    //! \param section_index The index of the section
-    //! \return True if the section is without a segment, false otherwise
-    bool is_section_without_segment( unsigned int section_index ) const
+    //! \brief Compute the file layout and write the file
+    //! \param stream The output stream to save to
+    //! \param is_sequential Write the file in one sequential pass
+    //! \return True if successful, false otherwise
+    bool save_layout( std::ostream& stream, bool is_sequential )
     {
-        bool found = false;
+        // Define layout specific header fields
+        // The position of the segment table is fixed after the header.
+        // The position of the section table is variable and needs to be fixed
+        // before saving.
+        header->set_segments_num( segments.size() );
+        header->set_segments_offset(
+            segments.size() > 0 ? header->get_header_size() : 0 );
+        header->set_sections_num( sections.size() );
+        header->set_sections_offset( 0 );
+
+        // Layout the first section right after the segment table
+        current_file_pos =
+            header->get_header_size() +
+            header->get_segment_entry_size() *
+                static_cast<Elf_Xword>( header->get_segments_num() );
+
+        calc_segment_alignment();
+
+        bool is_still_good = layout_segments_and_their_sections();
+        is_still_good = is_still_good && layout_sections_without_segments();
+        is_still_good = is_still_good && layout_section_table();
+        if ( !is_still_good ) {
+            return false;
+        }
+
+        if ( is_sequential ) {
+            output_chunks chunks;
+            header->gather( chunks );
+            gather_sections( chunks );
+            gather_segments( chunks );
+            if ( chunks.sort() ) {
+                if ( std::streamoff( stream.tellp() ) > 0 ) {
+                    stream.seekp( 0 );
+                }
+                is_still_good = chunks.write( stream );
+                if ( is_still_good ) {
+                    set_saved();
+                }
+                return is_still_good;
+            }
+        }
+
+        is_still_good = is_still_good && save_header( stream );
+        is_still_good = is_still_good && save_sections( stream );
+        is_still_good = is_still_good && save_segments( stream );
+        if ( is_still_good ) {
+            set_saved();
+        }
+
+        return is_still_good;
+    }
 
-        for ( unsigned int j = 0; !found && ( j < segments.size() ); ++j ) {
-            for ( Elf_Half k = 0;
-                  !found && ( k < segments[j]->get_sections_num() ); ++k ) {
-                found = segments[j]->get_section_index_at( k ) == section_index;
+    //------------------------------------------------------------------------------
+    //! \brief Compress the data of compressed sections
+    //!
+    //! The largest sections are handed to the threads first
+    //! \return True if successful, false otherwise
+    bool compress_sections()
+    {
+        std::vector<section*> work;
+        if ( compression != nullptr ) {
+            for ( const auto& sec : sections_ ) {
+                if ( sec->get_flags() & ( SHF_COMPRESSED | SHF_RPX_DEFLATE ) ) {
+                    work.push_back( sec.get() );
+                }
+            }
+        }
+        std::stable_sort( work.begin(), work.end(),
+                          []( const section* a, const section* b ) {
+                              return a->get_size() > b->get_size();
+                          } );
+
+        std::atomic<bool> is_ok{ true };
+        parallel_for( work.size(), threads_num, [&]( size_t i ) {
+            if ( !work[i]->compress_data() ) {
+                is_ok = false;
             }
+        } );
+
+        return is_ok;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Release the compressed data of compressed sections
+    void release_compressed_sections()
+    {
+        for ( const auto& sec : sections_ ) {
+            sec->release_compressed_data();
         }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Record the current state of all headers and sections as
+    //!        the one stored in the file
+    void set_saved()
+    {
+        header->set_saved();
+        for ( const auto& sec : sections_ ) {
+            sec->set_saved();
+        }
+        for ( const auto& seg : segments_ ) {
+            seg->set_saved();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Add the section headers and data to an ordered output list
+    //! \param chunks The output list
+    void gather_sections( output_chunks& chunks ) const
+    {
+        for ( const auto& sec : sections_ ) {
+            Elf64_Off header_offset =
+                header->get_sections_offset() +
+                Elf64_Off( header->get_section_entry_size() ) *
+                    sec->get_index();
 
-        return !found;
+            sec->gather( chunks, header_offset, sec->get_offset() );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Add the segment headers to an ordered output list
+    //! \param chunks The output list
+    void gather_segments( output_chunks& chunks ) const
+    {
+        for ( const auto& seg : segments_ ) {
+            Elf64_Off header_offset =
+                header->get_segments_offset() +
+                Elf64_Off( header->get_segment_entry_size() ) *
+                    seg->get_index();
+
+            seg->gather( chunks, header_offset, seg->get_offset() );
+        }
     }
 
     //------------------------------------------------------------------------------
@@ -778,13 +1564,18 @@ class elfio
 
     //------------------------------------------------------------------------------
     //! \brief Get ordered segments
+    //!
+    //! A segment is placed after all the segments containing its sections
+    //! (see is_subsequence_of()). The segments are taken in passes over the
+    //! pending ones, keeping their relative order
     //! \return Vector of ordered segments
     std::vector<segment*> get_ordered_segments() const
     {
         std::vector<segment*> res;
-        std::deque<segment*>  worklist;
+        std::vector<segment*> worklist;
 
         res.reserve( segments.size() );
+        worklist.reserve( segments.size() );
         for ( const auto& seg : segments ) {
             worklist.emplace_back( seg.get() );
         }
@@ -802,23 +1593,63 @@ class elfio
             }
         }
 
-        while ( !worklist.empty() ) {
-            segment* seg = worklist.front();
-            worklist.pop_front();
-
-            size_t i = 0;
-            for ( ; i < worklist.size(); ++i ) {
-                if ( is_subsequence_of( seg, worklist[i] ) ) {
-                    break;
+        // Segments containing each section
+        std::vector<std::vector<size_t>> containing;
+        for ( size_t i = 0; i < worklist.size(); ++i ) {
+            for ( Elf_Half index : worklist[i]->get_sections() ) {
+                if ( index >= containing.size() ) {
+                    containing.resize( size_t( index ) + 1 );
+                }
+                if ( containing[index].empty() ||
+                     containing[index].back() != i ) {
+                    containing[index].push_back( i );
                 }
             }
+        }
 
-            if ( i < worklist.size() ) {
-                worklist.emplace_back( seg );
+        // A segment without sections is contained in every other segment
+        // having sections. Others are contained only in segments sharing
+        // their first section
+        std::vector<size_t>              pending_supersets( worklist.size() );
+        std::vector<std::vector<size_t>> subsets( worklist.size() );
+        size_t                           pending_non_empty = 0;
+        for ( size_t i = 0; i < worklist.size(); ++i ) {
+            const auto& sections1 = worklist[i]->get_sections();
+            if ( sections1.empty() ) {
+                continue;
             }
-            else {
-                res.emplace_back( seg );
+            ++pending_non_empty;
+            for ( size_t j : containing[sections1.front()] ) {
+                if ( is_subsequence_of( worklist[i], worklist[j] ) ) {
+                    subsets[j].push_back( i );
+                    ++pending_supersets[i];
+                }
+            }
+        }
+
+        std::vector<size_t> pending( worklist.size() );
+        for ( size_t i = 0; i < pending.size(); ++i ) {
+            pending[i] = i;
+        }
+        while ( !pending.empty() ) {
+            std::vector<size_t> next;
+            for ( size_t i : pending ) {
+                bool is_empty = worklist[i]->get_sections_num() == 0;
+                if ( pending_supersets[i] > 0 ||
+                     ( is_empty && pending_non_empty > 0 ) ) {
+                    next.push_back( i );
+                    continue;
+                }
+
+                res.emplace_back( worklist[i] );
+                if ( !is_empty ) {
+                    --pending_non_empty;
+                }
+                for ( size_t j : subsets[i] ) {
+                    --pending_supersets[j];
+                }
             }
+            pending.swap( next );
         }
 
         return res;
@@ -829,8 +1660,17 @@ class elfio
     //! \return True if successful, false otherwise
     bool layout_sections_without_segments()
     {
+        std::vector<bool> in_segment( sections_.size(), false );
+        for ( const auto& seg : segments_ ) {
+            for ( Elf_Half index : seg->get_sections() ) {
+                if ( index < in_segment.size() ) {
+                    in_segment[index] = true;
+                }
+            }
+        }
+
         for ( unsigned int i = 0; i < sections_.size(); ++i ) {
-            if ( is_section_without_segment( i ) ) {
+            if ( !in_segment[i] ) {
                 const auto& sec = sections_[i];
 
                 if ( Elf_Xword section_align = sec->get_addr_align();
@@ -1092,16 +1932,7 @@ class elfio
         //! \return Pointer to the section, or nullptr if not found
         section* operator[]( const std::string_view& name ) const
         {
-            section* sec = nullptr;
-
-            for ( const auto& it : parent->sections_ ) {
-                if ( it->get_name() == name ) {
-                    sec = it.get();
-                    break;
-                }
-            }
-
-            return sec;
+            return parent->find_section( name );
         }
 
         //------------------------------------------------------------------------------
@@ -1234,7 +2065,7 @@ class elfio
 
     //------------------------------------------------------------------------------
   private:
-    std::unique_ptr<std::ifstream> pstream =
+    std::unique_ptr<std::istream> pstream =
         nullptr; //!< Pointer to the input stream
     std::unique_ptr<elf_header> header = nullptr; //!< Pointer to the ELF header
     std::vector<std::unique_ptr<section>> sections_; //!< Vector of sections
@@ -1243,7 +2074,19 @@ class elfio
     std::shared_ptr<address_translator> addr_translator; //!< Address translator
     std::shared_ptr<compression_interface> compression =
         nullptr; //!< Pointer to the compression interface
-
+    std::shared_ptr<size_t>
+        names_version; //!< Counter of section list and name changes
+    mutable std::unordered_map<std::string_view, size_t>
+        name_index; //!< Section positions by name
+    mutable std::atomic<size_t> name_index_version{
+        0 }; //!< names_version the name index was built for
+    mutable std::mutex name_index_mutex; //!< Lock of the name index rebuild
+
+    std::shared_ptr<data_cache> cache =
+        nullptr; //!< Cache of the data of lazily loaded sections
+
+    load_profile profile = load_profile::full; //!< Amount of data loaded
+    unsigned  threads_num      = 1; //!< Threads used for compression
     Elf_Xword current_file_pos = 0; //!< Current file position
 };
 
@@ -0,0 +1,276 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ELFIO_BATCH_HPP
+#define ELFIO_BATCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <elfio/elfio.hpp>
+
+namespace ELFIO {
+
+//------------------------------------------------------------------------------
+//! \class batch_scanner
+//! \brief Loads many ELF files concurrently and passes each of them to
+//!        a visitor.
+//!
+//! Every worker thread owns one elfio object and one file buffer, which
+//! are reused for all files the worker loads. Non-lazy loads map each file
+//! into memory, so section data is not copied. Where mapping is not
+//! supported, a file is read with a single read into the buffer and its
+//! sections are copied from there. The memory taken by the files loaded at
+//! once is kept within the memory budget. Lazy loads read only the parts
+//! of the files that are used. All workers share one lru_data_cache limited
+//! by the budget, which releases the least recently used lazily loaded data
+class batch_scanner
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Function called for every scanned file. It is called
+    //!        concurrently from the worker threads. The elfio object is
+    //!        nullptr when the file could not be loaded. It is reused for
+    //!        the next file after the function returns
+    using visitor =
+        std::function<void( const std::string& file_name, elfio* file )>;
+
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param workers Number of worker threads
+    //! \param budget Maximum total size in bytes of the file data loaded
+    //!               at once. 0 means no limit
+    explicit batch_scanner( unsigned workers = 4, size_t budget = 0 )
+        : workers_num( workers > 0 ? workers : 1 ), memory_budget( budget )
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the number of worker threads
+    //! \param value Number of threads
+    void set_workers_num( unsigned value )
+    {
+        workers_num = value > 0 ? value : 1;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the number of worker threads
+    //! \return Number of threads
+    unsigned get_workers_num() const { return workers_num; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the memory budget. It takes effect on the next scan
+    //! \param value Maximum total size of the loaded data. 0 means no limit
+    void set_memory_budget( size_t value ) { memory_budget = value; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the memory budget
+    //! \return Maximum total size of the loaded data
+    size_t get_memory_budget() const { return memory_budget; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set whether the files are loaded lazily
+    //! \param value True for lazy loads (the default)
+    void set_lazy( bool value ) { is_lazy = value; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether the files are loaded lazily
+    //! \return True for lazy loads
+    bool get_lazy() const { return is_lazy; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the amount of the section information read for every file
+    //! \param value The load profile
+    void set_load_profile( load_profile value ) { profile = value; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the amount of the section information read for every file
+    //! \return The load profile
+    load_profile get_load_profile() const { return profile; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Load the files and pass each of them to the visitor.
+    //!        The files are visited in no particular order
+    //! \param file_names The files to scan
+    //! \param func The visitor
+    //! \return Number of files loaded successfully
+    size_t scan( const std::vector<std::string>& file_names,
+                 const visitor&                  func )
+    {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> loaded{ 0 };
+
+        std::shared_ptr<lru_data_cache> cache;
+        if ( is_lazy && memory_budget != 0 ) {
+            cache = std::make_shared<lru_data_cache>( memory_budget );
+        }
+
+        // Each worker keeps its own elfio object and buffer
+        parallel_for( workers_num, workers_num, [&]( size_t ) {
+            elfio             elf;
+            std::vector<char> buffer;
+            elf.set_load_profile( profile );
+            elf.set_data_cache( cache );
+            for ( size_t i = next++; i < file_names.size(); i = next++ ) {
+                if ( visit( file_names[i], elf, buffer, func ) ) {
+                    ++loaded;
+                }
+            }
+        } );
+
+        return loaded;
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    //! \brief Load a file and pass it to the visitor
+    //! \param file_name The file to load
+    //! \param elf The elfio object of the worker
+    //! \param buffer The file buffer of the worker
+    //! \param func The visitor
+    //! \return True if the file was loaded, false otherwise
+    bool visit( const std::string& file_name,
+                elfio&             elf,
+                std::vector<char>& buffer,
+                const visitor&     func )
+    {
+        if ( !is_lazy ) {
+            return load_buffered( file_name, elf, buffer, func );
+        }
+
+        bool is_loaded = elf.load( file_name, true );
+        func( file_name, is_loaded ? &elf : nullptr );
+        return is_loaded;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Load a file without lazy loading and visit it within the
+    //!        memory budget. The file is mapped if the platform supports it
+    //! \param file_name The file to load
+    //! \param elf The elfio object of the worker
+    //! \param buffer The file buffer of the worker
+    //! \param func The visitor
+    //! \return True if the file was loaded, false otherwise
+    bool load_buffered( const std::string& file_name,
+                        elfio&             elf,
+                        std::vector<char>& buffer,
+                        const visitor&     func )
+    {
+        std::ifstream stream( file_name, std::ios::in | std::ios::binary );
+        stream.seekg( 0, std::ios::end );
+        std::streamoff size = stream ? std::streamoff( stream.tellg() ) : -1;
+        if ( size <= 0 ) {
+            func( file_name, nullptr );
+            return false;
+        }
+
+        if ( mapped_file::is_supported() ) {
+            // Section data points into the mapping
+            stream.close();
+            size_t reserved  = acquire( size_t( size ) );
+            bool   is_loaded = elf.load_mapped( file_name );
+            func( file_name, is_loaded ? &elf : nullptr );
+            // Drop the mapping before its memory returns to the budget
+            elf.create( ELFCLASS64, ELFDATA2LSB );
+            release( reserved );
+            return is_loaded;
+        }
+
+        // The sections are copied out of the buffer
+        size_t reserved = acquire( 2 * size_t( size ) );
+        buffer.resize( size_t( size ) );
+        stream.seekg( 0 );
+        bool is_loaded = false;
+        if ( stream.read( buffer.data(), size ) ) {
+            memory_istream memory( buffer.data(), buffer.size() );
+            is_loaded = elf.load( memory );
+        }
+        func( file_name, is_loaded ? &elf : nullptr );
+
+        // Keep the buffer for the next file only if it fits the budget share
+        if ( memory_budget != 0 &&
+             buffer.capacity() > memory_budget / workers_num ) {
+            std::vector<char>().swap( buffer );
+        }
+        // Drop the section copies before their memory returns to the budget
+        elf.create( ELFCLASS64, ELFDATA2LSB );
+        release( reserved );
+
+        return is_loaded;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Wait until memory fits into the budget and reserve it.
+    //!        A request larger than the budget waits for all others
+    //! \param size Size of the memory
+    //! \return Size actually reserved
+    size_t acquire( size_t size )
+    {
+        if ( memory_budget == 0 ) {
+            return 0;
+        }
+
+        size_t reserved = std::min( size, memory_budget );
+        std::unique_lock<std::mutex> lock( budget_mutex );
+        budget_released.wait(
+            lock, [&]() { return in_flight + reserved <= memory_budget; } );
+        in_flight += reserved;
+
+        return reserved;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Return reserved memory to the budget
+    //! \param reserved Size returned by acquire()
+    void release( size_t reserved )
+    {
+        if ( reserved == 0 ) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock( budget_mutex );
+            in_flight -= reserved;
+        }
+        budget_released.notify_all();
+    }
+
+    unsigned     workers_num;                    //!< Number of worker threads
+    size_t       memory_budget;                  //!< Limit of loaded bytes
+    bool         is_lazy   = true;               //!< Whether loads are lazy
+    load_profile profile   = load_profile::full; //!< Section info read
+    size_t       in_flight = 0;                  //!< Currently loaded bytes
+
+    std::mutex              budget_mutex;    //!< Lock of in_flight
+    std::condition_variable budget_released; //!< Signal of released memory
+};
+
+} // namespace ELFIO
+
+#endif // ELFIO_BATCH_HPP
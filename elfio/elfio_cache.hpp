@@ -0,0 +1,331 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ELFIO_CACHE_HPP
+#define ELFIO_CACHE_HPP
+
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace ELFIO {
+
+//------------------------------------------------------------------------------
+//! \class cached_object
+//! \brief Owner of data loaded on demand that a data cache may release
+class cached_object
+{
+  public:
+    //------------------------------------------------------------------------------
+    virtual ~cached_object() = default;
+
+    //------------------------------------------------------------------------------
+    //! \brief Release the loaded data. It is loaded again on next access
+    //! \return True if the data was released, false if it has to be kept
+    virtual bool release_cached_data() const = 0;
+};
+
+//------------------------------------------------------------------------------
+//! \class data_cache
+//! \brief Interface tracking the data of lazily loaded sections and segments.
+//!
+//! A cache may be shared by several elfio objects and is called from
+//! any thread reading their data. It must never call back into the object
+//! reporting an access, except through release_cached_data() of other objects
+class data_cache
+{
+  public:
+    //------------------------------------------------------------------------------
+    virtual ~data_cache() = default;
+
+    //------------------------------------------------------------------------------
+    //! \brief Report data loaded by an object
+    //! \param object The object that loaded the data
+    //! \param size Size of the loaded data
+    virtual void add( const cached_object* object, size_t size ) = 0;
+
+    //------------------------------------------------------------------------------
+    //! \brief Report an access to data of an object
+    //! \param object The object whose data was accessed
+    virtual void touch( const cached_object* object ) = 0;
+
+    //------------------------------------------------------------------------------
+    //! \brief Report data released or taken over by its object
+    //! \param object The object that no longer holds the cached data
+    virtual void remove( const cached_object* object ) = 0;
+
+    //------------------------------------------------------------------------------
+    //! \brief Keep the data of an object loaded until it is unpinned.
+    //!        Pins are counted. The object may be pinned before it loads data
+    //! \param object The object whose data is in use
+    virtual void pin( const cached_object* object ) = 0;
+
+    //------------------------------------------------------------------------------
+    //! \brief Remove a pin added by pin()
+    //! \param object The object whose data is not in use anymore
+    virtual void unpin( const cached_object* object ) = 0;
+};
+
+//------------------------------------------------------------------------------
+//! \class lru_data_cache
+//! \brief Data cache releasing the least recently used data when the total
+//!        size of the loaded data exceeds a memory budget.
+//!
+//! Data pointers returned by get_data() of an object using the cache stay
+//! valid until the data is released to load data of another object.
+//! The data just loaded is never released by its own load, even if it alone
+//! exceeds the budget. Pinned data is never released; the budget may be
+//! exceeded until the data is unpinned and another load happens
+class lru_data_cache : public data_cache
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param value Maximum total size of the cached data in bytes
+    explicit lru_data_cache( size_t value ) : budget( value ) {}
+
+    lru_data_cache( const lru_data_cache& )            = delete;
+    lru_data_cache& operator=( const lru_data_cache& ) = delete;
+
+    //------------------------------------------------------------------------------
+    //! \brief Report data loaded by an object and release the least
+    //!        recently used data exceeding the budget
+    //! \param object The object that loaded the data
+    //! \param size Size of the loaded data
+    void add( const cached_object* object, size_t size ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        erase( object );
+        entries.emplace_front( object, size );
+        positions[object] = entries.begin();
+        total_size += size;
+
+        // The data just loaded is about to be returned to the caller
+        shrink( 1 );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Mark the data of an object as the most recently used
+    //! \param object The object whose data was accessed
+    void touch( const cached_object* object ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        auto it = positions.find( object );
+        if ( it != positions.end() ) {
+            entries.splice( entries.begin(), entries, it->second );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Stop tracking the data of an object
+    //! \param object The object that no longer holds the cached data
+    void remove( const cached_object* object ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        erase( object );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Keep the data of an object loaded until it is unpinned
+    //! \param object The object whose data is in use
+    void pin( const cached_object* object ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        ++pins[object];
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Remove a pin added by pin()
+    //! \param object The object whose data is not in use anymore
+    void unpin( const cached_object* object ) override
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        auto it = pins.find( object );
+        if ( it != pins.end() && --it->second == 0 ) {
+            pins.erase( it );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the memory budget. Data exceeding it is released at once
+    //! \param value Maximum total size of the cached data in bytes
+    void set_budget( size_t value )
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        budget = value;
+        shrink( 0 );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the memory budget
+    //! \return Maximum total size of the cached data in bytes
+    size_t get_budget() const
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        return budget;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the total size of the cached data
+    //! \return Size of the cached data in bytes
+    size_t get_size() const
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        return total_size;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the number of objects holding cached data
+    //! \return Number of objects
+    size_t get_entries_num() const
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        return entries.size();
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    //! \brief Stop tracking an object. The cache lock has to be held
+    //! \param object The object to stop tracking
+    void erase( const cached_object* object )
+    {
+        auto it = positions.find( object );
+        if ( it != positions.end() ) {
+            total_size -= it->second->second;
+            entries.erase( it->second );
+            positions.erase( it );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Release the least recently used data until the budget is met.
+    //!        The cache lock has to be held
+    //! \param kept Number of the most recently used entries never released
+    void shrink( size_t kept )
+    {
+        auto   it        = entries.end();
+        size_t remaining = entries.size();
+        while ( total_size > budget && remaining > kept ) {
+            --remaining;
+            auto                 victim_it = std::prev( it );
+            const cached_object* victim    = victim_it->first;
+            if ( pins.find( victim ) != pins.end() ) {
+                it = victim_it;
+                continue;
+            }
+            erase( victim );
+            victim->release_cached_data();
+        }
+    }
+
+    using entry = std::pair<const cached_object*, size_t>;
+
+    mutable std::mutex mutex;   //!< Lock of the cache state
+    std::list<entry>   entries; //!< Cached objects, most recently used first
+    std::unordered_map<const cached_object*, std::list<entry>::iterator>
+        positions; //!< Positions of the objects in the entries list
+    std::unordered_map<const cached_object*, size_t>
+                 pins;           //!< Pin counts of the objects in use
+    size_t       total_size = 0; //!< Total size of the cached data
+    size_t       budget;         //!< Maximum total size of the cached data
+};
+
+//------------------------------------------------------------------------------
+//! \class data_pin
+//! \brief Keeps the data of a section or a segment loaded while the pin
+//!        exists. The pointer returned by get() stays valid until then,
+//!        even when a data cache releases data to load data of other objects
+//! \tparam T section or segment
+template <class T> class data_pin
+{
+  public:
+    //------------------------------------------------------------------------------
+    data_pin() = default;
+
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param value The object to pin, or nullptr
+    explicit data_pin( const T* value ) : object( value )
+    {
+        if ( object != nullptr ) {
+            object->pin_data();
+        }
+    }
+
+    data_pin( const data_pin& )            = delete;
+    data_pin& operator=( const data_pin& ) = delete;
+
+    //------------------------------------------------------------------------------
+    data_pin( data_pin&& other ) noexcept
+        : object( std::exchange( other.object, nullptr ) )
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    data_pin& operator=( data_pin&& other ) noexcept
+    {
+        if ( this != &other ) {
+            reset();
+            object = std::exchange( other.object, nullptr );
+        }
+        return *this;
+    }
+
+    //------------------------------------------------------------------------------
+    ~data_pin() { reset(); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the data of the pinned object, loading it if needed
+    //! \return Pointer to the data, or nullptr if nothing is pinned
+    const char* get() const
+    {
+        return object != nullptr ? object->get_data() : nullptr;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Remove the pin
+    void reset()
+    {
+        if ( object != nullptr ) {
+            object->unpin_data();
+            object = nullptr;
+        }
+    }
+
+  private:
+    const T* object = nullptr; //!< The pinned object
+};
+
+} // namespace ELFIO
+
+#endif // ELFIO_CACHE_HPP
@@ -0,0 +1,537 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#ifndef ELFIO_COMPRESSION_HPP
+#define ELFIO_COMPRESSION_HPP
+
+// This header is not included by elfio.hpp. It requires zlib.
+// Define ELFIO_WITH_ZSTD before including it to enable ELFCOMPRESS_ZSTD
+// support. The application has to link against zlib (and zstd)
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <zlib.h>
+#ifdef ELFIO_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include <elfio/elfio.hpp>
+
+namespace ELFIO {
+
+//------------------------------------------------------------------------------
+//! \class section_compression
+//! \brief Codec for SHF_COMPRESSED sections starting with an Elf32_Chdr or
+//!        an Elf64_Chdr header
+//!
+//! Besides the whole section inflation used by elfio, read() decompresses
+//! a range of a section chunk by chunk. Sequential reads continue from the
+//! previous position. The chunks are decompressed into a scratch buffer
+//! reused for all sections. read() keeps state between the calls and must
+//! not be used by several threads at the same time. inflate() and deflate()
+//! may be called concurrently, as elfio does when saving with several
+//! threads. deflate() reuses a scratch buffer of the calling thread
+class section_compression : public compression_interface
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param type Compression type used by deflate() (ELFCOMPRESS_ZLIB or
+    //!             ELFCOMPRESS_ZSTD)
+    //! \param chunk_size Size of the chunks decompressed by read()
+    explicit section_compression( Elf_Word type       = ELFCOMPRESS_ZLIB,
+                                  size_t   chunk_size = 64 * 1024 )
+        : type( type ), chunk_size( std::max<size_t>( chunk_size, 1 ) )
+    {
+    }
+
+    section_compression( const section_compression& )            = delete;
+    section_compression& operator=( const section_compression& ) = delete;
+
+    //------------------------------------------------------------------------------
+    ~section_compression() override { cursor.end(); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Setup the compression for the class of the processed ELF file
+    //! \param file_class The class of the ELF file (ELFCLASS32 or ELFCLASS64)
+    void setup( unsigned char file_class ) override
+    {
+        this->file_class = file_class;
+        cursor.end();
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether a compression type is supported
+    //! \param type Compression type
+    //! \return True if supported, false otherwise
+    static bool is_supported( Elf_Word type )
+    {
+#ifdef ELFIO_WITH_ZSTD
+        return type == ELFCOMPRESS_ZLIB || type == ELFCOMPRESS_ZSTD;
+#else
+        return type == ELFCOMPRESS_ZLIB;
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read the compression header of a section
+    //! \param data The compressed section data
+    //! \param size The size of the compressed section data
+    //! \param convertor Pointer to an endianness convertor instance
+    //! \param ch_type Reference to a variable to store the compression type
+    //! \param uncompressed_size Reference to a variable to store the size of
+    //!                          the uncompressed data
+    //! \param addr_align Reference to a variable to store the alignment of
+    //!                   the uncompressed data
+    //! \return True if successful, false otherwise
+    bool get_header( const char*                                 data,
+                     Elf_Xword                                   size,
+                     std::shared_ptr<const endianness_convertor> convertor,
+                     Elf_Word&                                   ch_type,
+                     Elf_Xword& uncompressed_size,
+                     Elf_Xword& addr_align ) const
+    {
+        if ( data == nullptr || size < get_header_size() ) {
+            return false;
+        }
+
+        if ( file_class == ELFCLASS64 ) {
+            Elf64_Chdr header;
+            std::memcpy( &header, data, sizeof( header ) );
+            ch_type           = ( *convertor )( header.ch_type );
+            uncompressed_size = ( *convertor )( header.ch_size );
+            addr_align        = ( *convertor )( header.ch_addralign );
+        }
+        else {
+            Elf32_Chdr header;
+            std::memcpy( &header, data, sizeof( header ) );
+            ch_type           = ( *convertor )( header.ch_type );
+            uncompressed_size = ( *convertor )( header.ch_size );
+            addr_align        = ( *convertor )( header.ch_addralign );
+        }
+
+        return uncompressed_size < std::numeric_limits<size_t>::max();
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Decompress a compressed section
+    //! \param data The buffer of compressed data
+    //! \param convertor Pointer to an endianness convertor instance
+    //! \param compressed_size The size of the compressed data buffer
+    //! \param uncompressed_size Reference to a variable to store
+    //!                          the decompressed buffer size
+    //! \return A smart pointer to the decompressed data, nullptr on failure
+    std::unique_ptr<char[]>
+    inflate( const char*                                 data,
+             std::shared_ptr<const endianness_convertor> convertor,
+             Elf_Xword                                   compressed_size,
+             Elf_Xword& uncompressed_size ) const override
+    {
+        Elf_Word  ch_type    = 0;
+        Elf_Xword size       = 0;
+        Elf_Xword addr_align = 0;
+        if ( !get_header( data, compressed_size, convertor, ch_type, size,
+                          addr_align ) ) {
+            return nullptr;
+        }
+
+        std::unique_ptr<char[]> result(
+            new ( std::nothrow ) char[size_t( size ) + 1] );
+        if ( result == nullptr ) {
+            return nullptr;
+        }
+
+        decoder dec;
+        bool    is_ok = dec.begin( ch_type, data + get_header_size(),
+                                   compressed_size - get_header_size() ) &&
+                     dec.decode( result.get(), size ) == size;
+        dec.end();
+        if ( !is_ok ) {
+            return nullptr;
+        }
+
+        result[size_t( size )] = '\0';
+        uncompressed_size      = size;
+        return result;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Compress a section
+    //!
+    //! The alignment of the uncompressed data is recorded as 1
+    //! \param data The buffer of uncompressed data
+    //! \param convertor Pointer to an endianness convertor instance
+    //! \param decompressed_size The size of the uncompressed data buffer
+    //! \param compressed_size Reference to a variable to store
+    //!                        the compressed buffer size
+    //! \return A smart pointer to the compressed data, nullptr on failure
+    std::unique_ptr<char[]>
+    deflate( const char*                                 data,
+             std::shared_ptr<const endianness_convertor> convertor,
+             Elf_Xword                                   decompressed_size,
+             Elf_Xword& compressed_size ) const override
+    {
+        std::vector<char>& buffer      = get_deflate_buffer();
+        size_t             header_size = get_header_size();
+        size_t             size        = 0;
+        if ( !compress( data, decompressed_size, buffer, header_size, size ) ) {
+            return nullptr;
+        }
+
+        if ( file_class == ELFCLASS64 ) {
+            Elf64_Chdr header   = {};
+            header.ch_type      = ( *convertor )( type );
+            header.ch_size      = ( *convertor )( decompressed_size );
+            header.ch_addralign = ( *convertor )( Elf_Xword( 1 ) );
+            std::memcpy( buffer.data(), &header, sizeof( header ) );
+        }
+        else {
+            Elf32_Chdr header   = {};
+            header.ch_type      = ( *convertor )( type );
+            header.ch_size =
+                ( *convertor )( Elf_Word( decompressed_size ) );
+            header.ch_addralign = ( *convertor )( Elf_Word( 1 ) );
+            std::memcpy( buffer.data(), &header, sizeof( header ) );
+        }
+
+        std::unique_ptr<char[]> result(
+            new ( std::nothrow ) char[header_size + size] );
+        if ( result == nullptr ) {
+            return nullptr;
+        }
+
+        std::copy( buffer.data(), buffer.data() + header_size + size,
+                   result.get() );
+        compressed_size = header_size + size;
+        return result;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read a range of the uncompressed data of a section
+    //! \param data The compressed section data
+    //! \param compressed_size The size of the compressed section data
+    //! \param convertor Pointer to an endianness convertor instance
+    //! \param offset Offset of the range in the uncompressed data
+    //! \param buffer Buffer receiving the range
+    //! \param size Size of the range
+    //! \return True if successful, false otherwise
+    bool read( const char*                                 data,
+               Elf_Xword                                   compressed_size,
+               std::shared_ptr<const endianness_convertor> convertor,
+               Elf_Xword                                   offset,
+               char*                                       buffer,
+               Elf_Xword                                   size ) const
+    {
+        Elf_Word  ch_type    = 0;
+        Elf_Xword total      = 0;
+        Elf_Xword addr_align = 0;
+        if ( !get_header( data, compressed_size, convertor, ch_type, total,
+                          addr_align ) ||
+             offset > total || size > total - offset ) {
+            return false;
+        }
+
+        // Restart the decompression for another section or when
+        // the range precedes the decompressed chunk
+        if ( cursor.source != data || cursor.source_size != compressed_size ||
+             offset < cursor.chunk_offset ) {
+            cursor.end();
+            if ( !cursor.dec.begin( ch_type, data + get_header_size(),
+                                    compressed_size - get_header_size() ) ) {
+                cursor.end();
+                return false;
+            }
+            cursor.source      = data;
+            cursor.source_size = compressed_size;
+            scratch.resize( std::max( scratch.size(), chunk_size ) );
+        }
+
+        while ( size > 0 ) {
+            Elf_Xword chunk_end = cursor.chunk_offset + cursor.chunk_filled;
+            if ( offset < chunk_end ) {
+                Elf_Xword n = std::min( size, chunk_end - offset );
+                const char* from =
+                    scratch.data() + ( offset - cursor.chunk_offset );
+                std::copy( from, from + n, buffer );
+                buffer += n;
+                offset += n;
+                size -= n;
+                continue;
+            }
+
+            cursor.chunk_offset = chunk_end;
+            cursor.chunk_filled =
+                cursor.dec.decode( scratch.data(), chunk_size );
+            if ( cursor.chunk_filled == 0 ) {
+                cursor.end();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read a range of the uncompressed data of a section
+    //!
+    //! The section has to be loaded lazily or without compression support,
+    //! so its data is kept compressed
+    //! \param elf_file The ELF file containing the section
+    //! \param sec The compressed section
+    //! \param offset Offset of the range in the uncompressed data
+    //! \param buffer Buffer receiving the range
+    //! \param size Size of the range
+    //! \return True if successful, false otherwise
+    bool read( const elfio&   elf_file,
+               const section* sec,
+               Elf_Xword      offset,
+               char*          buffer,
+               Elf_Xword      size ) const
+    {
+        if ( sec == nullptr || ( sec->get_flags() & SHF_COMPRESSED ) == 0 ||
+             elf_file.get_class() != file_class ) {
+            return false;
+        }
+
+        return read( sec->get_data(), sec->get_size(),
+                     elf_file.get_convertor(), offset, buffer, size );
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    //! \brief Get the size of the compression header
+    //! \return Size of Elf32_Chdr or Elf64_Chdr
+    size_t get_header_size() const
+    {
+        return file_class == ELFCLASS64 ? sizeof( Elf64_Chdr )
+                                        : sizeof( Elf32_Chdr );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the scratch buffer of deflate() for the calling thread
+    //! \return Reference to the buffer
+    static std::vector<char>& get_deflate_buffer()
+    {
+        thread_local std::vector<char> buffer;
+        return buffer;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Compress data into a buffer after the header space
+    //! \param data The data to compress
+    //! \param data_size Size of the data
+    //! \param buffer The buffer receiving the compressed data
+    //! \param header_size Space to reserve for the compression header
+    //! \param size Reference to a variable to store the compressed size
+    //! \return True if successful, false otherwise
+    bool compress( const char*        data,
+                   Elf_Xword          data_size,
+                   std::vector<char>& buffer,
+                   size_t             header_size,
+                   size_t&            size ) const
+    {
+        if ( data == nullptr || !is_supported( type ) ||
+             ( file_class != ELFCLASS64 &&
+               data_size > std::numeric_limits<Elf_Word>::max() ) ) {
+            return false;
+        }
+
+#ifdef ELFIO_WITH_ZSTD
+        if ( type == ELFCOMPRESS_ZSTD ) {
+            size_t bound = ZSTD_compressBound( size_t( data_size ) );
+            buffer.resize( std::max( buffer.size(), header_size + bound ) );
+            size = ZSTD_compress( buffer.data() + header_size, bound, data,
+                                  size_t( data_size ), ZSTD_CLEVEL_DEFAULT );
+            return !ZSTD_isError( size );
+        }
+#endif
+
+        if ( data_size > std::numeric_limits<uLong>::max() ) {
+            return false;
+        }
+        uLongf bound = compressBound( uLong( data_size ) );
+        buffer.resize( std::max( buffer.size(), header_size + bound ) );
+        auto* dest = reinterpret_cast<Bytef*>( buffer.data() + header_size );
+        if ( compress2( dest, &bound, reinterpret_cast<const Bytef*>( data ),
+                        uLong( data_size ), Z_DEFAULT_COMPRESSION ) != Z_OK ) {
+            return false;
+        }
+
+        size = bound;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \class decoder
+    //! \brief Incremental decompression of one compressed stream
+    class decoder
+    {
+      public:
+        //------------------------------------------------------------------------------
+        //! \brief Start the decompression
+        //! \param type Compression type
+        //! \param data The compressed stream
+        //! \param size Size of the compressed stream
+        //! \return True if successful, false otherwise
+        bool begin( Elf_Word type, const char* data, Elf_Xword size )
+        {
+            end();
+            if ( !is_supported( type ) ) {
+                return false;
+            }
+
+            next = data;
+            last = data + size;
+#ifdef ELFIO_WITH_ZSTD
+            if ( type == ELFCOMPRESS_ZSTD ) {
+                zstd = ZSTD_createDStream();
+                return zstd != nullptr;
+            }
+#endif
+            zlib          = {};
+            is_zlib_ready = inflateInit( &zlib ) == Z_OK;
+            return is_zlib_ready;
+        }
+
+        //------------------------------------------------------------------------------
+        //! \brief Decompress the next part of the stream
+        //! \param buffer Buffer receiving the decompressed data
+        //! \param size Size of the buffer
+        //! \return Number of decompressed bytes. It is less than the buffer
+        //!         size only at the end of the stream or on an error
+        Elf_Xword decode( char* buffer, Elf_Xword size )
+        {
+            Elf_Xword produced = 0;
+#ifdef ELFIO_WITH_ZSTD
+            if ( zstd != nullptr ) {
+                while ( produced < size ) {
+                    ZSTD_inBuffer  in  = { next, size_t( last - next ), 0 };
+                    ZSTD_outBuffer out = { buffer + produced,
+                                           size_t( size - produced ), 0 };
+                    size_t ret = ZSTD_decompressStream( zstd, &out, &in );
+                    next += in.pos;
+                    produced += out.pos;
+                    if ( ZSTD_isError( ret ) ||
+                         ( out.pos == 0 && in.pos == 0 ) ) {
+                        break;
+                    }
+                }
+                return produced;
+            }
+#endif
+            if ( !is_zlib_ready ) {
+                return 0;
+            }
+
+            while ( produced < size ) {
+                if ( zlib.avail_in == 0 ) {
+                    zlib.next_in = reinterpret_cast<Bytef*>(
+                        const_cast<char*>( next ) );
+                    zlib.avail_in =
+                        uInt( std::min<Elf_Xword>( last - next, UINT_MAX ) );
+                    next += zlib.avail_in;
+                }
+                zlib.next_out = reinterpret_cast<Bytef*>( buffer + produced );
+                zlib.avail_out =
+                    uInt( std::min<Elf_Xword>( size - produced, UINT_MAX ) );
+                uInt before = zlib.avail_out;
+                int  ret    = ::inflate( &zlib, Z_NO_FLUSH );
+                produced += before - zlib.avail_out;
+                if ( ret == Z_STREAM_END ||
+                     ( ret != Z_OK && ret != Z_BUF_ERROR ) ||
+                     ( ret == Z_BUF_ERROR && zlib.avail_in == 0 &&
+                       next == last ) ) {
+                    break;
+                }
+            }
+
+            return produced;
+        }
+
+        //------------------------------------------------------------------------------
+        //! \brief Release the decompression state
+        void end()
+        {
+            if ( is_zlib_ready ) {
+                inflateEnd( &zlib );
+                is_zlib_ready = false;
+            }
+#ifdef ELFIO_WITH_ZSTD
+            if ( zstd != nullptr ) {
+                ZSTD_freeDStream( zstd );
+                zstd = nullptr;
+            }
+#endif
+        }
+
+        //------------------------------------------------------------------------------
+        ~decoder() { end(); }
+
+      private:
+        const char* next          = nullptr; //!< Input not passed to zlib yet
+        const char* last          = nullptr; //!< End of the input
+        z_stream    zlib          = {};      //!< zlib decompression state
+        bool        is_zlib_ready = false;   //!< zlib state is initialized
+#ifdef ELFIO_WITH_ZSTD
+        ZSTD_DStream* zstd = nullptr; //!< zstd decompression state
+#endif
+    };
+
+    //------------------------------------------------------------------------------
+    //! \struct read_cursor
+    //! \brief Position of the sequential decompression done by read()
+    struct read_cursor
+    {
+        //------------------------------------------------------------------------------
+        //! \brief Forget the current decompression
+        void end()
+        {
+            dec.end();
+            source       = nullptr;
+            source_size  = 0;
+            chunk_offset = 0;
+            chunk_filled = 0;
+        }
+
+        decoder     dec;                    //!< Decompression state
+        const char* source       = nullptr; //!< Compressed section data
+        Elf_Xword   source_size  = 0;       //!< Size of the compressed data
+        Elf_Xword   chunk_offset = 0; //!< Uncompressed offset of the chunk
+        Elf_Xword   chunk_filled = 0; //!< Size of the decompressed chunk
+    };
+
+    Elf_Word                  type;       //!< Compression type for deflate()
+    size_t                    chunk_size; //!< Size of read() chunks
+    unsigned char             file_class = ELFCLASS64; //!< ELF file class
+    mutable std::vector<char> scratch; //!< Buffer of read() chunks
+    mutable read_cursor       cursor;  //!< State of sequential reads
+};
+
+} // namespace ELFIO
+
+#endif // ELFIO_COMPRESSION_HPP
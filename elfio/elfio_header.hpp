@@ -53,6 +53,25 @@ class elf_header
      */
     virtual bool save( std::ostream& stream ) const = 0;
 
+    /**
+     * @brief Add ELF header to an ordered output list.
+     * @param chunks Output list.
+     */
+    virtual void gather( output_chunks& chunks ) const = 0;
+
+    /**
+     * @brief Add ELF header to an output list if it was changed since
+     *        the last load or save.
+     * @param chunks Output list.
+     * @return False if the file layout described by the header was changed.
+     */
+    virtual bool gather_changes( output_chunks& chunks ) const = 0;
+
+    /**
+     * @brief Record the current state as the one stored in the file.
+     */
+    virtual void set_saved() = 0;
+
     // ELF header functions
     ELFIO_GET_ACCESS_DECL( unsigned char, class );
     ELFIO_GET_ACCESS_DECL( unsigned char, elf_version );
@@ -139,8 +158,12 @@ template <class T> class elf_header_impl : public elf_header
     {
         stream.seekg( ( *translator )[0] );
         stream.read( reinterpret_cast<char*>( &header ), sizeof( header ) );
+        if ( stream.gcount() != sizeof( header ) ) {
+            return false;
+        }
 
-        return ( stream.gcount() == sizeof( header ) );
+        set_saved();
+        return true;
     }
 
     /**
@@ -157,6 +180,56 @@ template <class T> class elf_header_impl : public elf_header
         return stream.good();
     }
 
+    /**
+     * @brief Add ELF header to an ordered output list.
+     * @param chunks Output list.
+     */
+    void gather( output_chunks& chunks ) const override
+    {
+        chunks.add( Elf64_Off( ( *translator )[0] ),
+                    reinterpret_cast<const char*>( &header ),
+                    sizeof( header ) );
+    }
+
+    /**
+     * @brief Add ELF header to an output list if it was changed since
+     *        the last load or save.
+     * @param chunks Output list.
+     * @return False if the file layout described by the header was changed.
+     */
+    bool gather_changes( output_chunks& chunks ) const override
+    {
+        if ( std::equal( reinterpret_cast<const char*>( &header ),
+                         reinterpret_cast<const char*>( &header + 1 ),
+                         reinterpret_cast<const char*>( &file_header ) ) ) {
+            return true;
+        }
+
+        if ( !is_in_file || header.e_phoff != file_header.e_phoff ||
+             header.e_shoff != file_header.e_shoff ||
+             header.e_phnum != file_header.e_phnum ||
+             header.e_shnum != file_header.e_shnum ||
+             header.e_ehsize != file_header.e_ehsize ||
+             header.e_phentsize != file_header.e_phentsize ||
+             header.e_shentsize != file_header.e_shentsize ) {
+            return false;
+        }
+
+        chunks.add( Elf64_Off( ( *translator )[0] ),
+                    reinterpret_cast<const char*>( &header ),
+                    sizeof( header ) );
+        return true;
+    }
+
+    /**
+     * @brief Record the current state as the one stored in the file.
+     */
+    void set_saved() override
+    {
+        file_header = header;
+        is_in_file  = true;
+    }
+
     //------------------------------------------------------------------------------
     // ELF header functions
     ELFIO_GET_ACCESS( unsigned char, class, header.e_ident[EI_CLASS] );
@@ -182,9 +255,11 @@ template <class T> class elf_header_impl : public elf_header
     ELFIO_GET_SET_ACCESS( Elf64_Off, segments_offset, header.e_phoff );
 
   private:
-    T                                     header     = {};
-    std::shared_ptr<endianness_convertor> convertor  = nullptr;
-    std::shared_ptr<address_translator>   translator = nullptr;
+    T                                     header      = {};
+    T                                     file_header = {};
+    bool                                  is_in_file  = false;
+    std::shared_ptr<endianness_convertor> convertor   = nullptr;
+    std::shared_ptr<address_translator>   translator  = nullptr;
 };
 
 } // namespace ELFIO
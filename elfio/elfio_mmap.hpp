@@ -0,0 +1,393 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ELFIO_MMAP_HPP
+#define ELFIO_MMAP_HPP
+
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cerrno>
+#include <istream>
+#include <streambuf>
+
+// Memory mapping support may be disabled by defining ELFIO_NO_MMAP.
+// In this case elfio::load_mapped() falls back to the regular stream loading
+#ifndef ELFIO_NO_MMAP
+#if defined( _WIN32 )
+#ifndef NOMINMAX
+#define NOMINMAX
+#define ELFIO_UNDEF_NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define ELFIO_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#ifdef ELFIO_UNDEF_NOMINMAX
+#undef NOMINMAX
+#undef ELFIO_UNDEF_NOMINMAX
+#endif
+#ifdef ELFIO_UNDEF_WIN32_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef ELFIO_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#define ELFIO_HAS_MMAP 1
+#elif defined( __unix__ ) || defined( __APPLE__ )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ELFIO_HAS_MMAP 1
+#endif
+#endif // ELFIO_NO_MMAP
+
+namespace ELFIO {
+
+//------------------------------------------------------------------------------
+//! \class mapped_file
+//! \brief Private (copy-on-write) read/write memory mapping of a file.
+//!
+//! Modifications done through the mapped memory never reach the file.
+//! Only the touched pages are copied by the operating system
+class mapped_file
+{
+  public:
+    //------------------------------------------------------------------------------
+    mapped_file() = default;
+    mapped_file( const mapped_file& )            = delete;
+    mapped_file& operator=( const mapped_file& ) = delete;
+    ~mapped_file() { close(); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Map the whole file into memory
+    //! \param file_name The name of the file to map
+    //! \return True if successful, false otherwise
+    bool open( const std::string& file_name )
+    {
+        close();
+#if defined( ELFIO_HAS_MMAP ) && defined( _WIN32 )
+        file_handle =
+            CreateFileA( file_name.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                         nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+        if ( file_handle == INVALID_HANDLE_VALUE ) {
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if ( !GetFileSizeEx( file_handle, &file_size ) ||
+             file_size.QuadPart == 0 ||
+             static_cast<unsigned long long>( file_size.QuadPart ) >
+                 std::numeric_limits<size_t>::max() ) {
+            close();
+            return false;
+        }
+
+        mapping_handle = CreateFileMappingA( file_handle, nullptr,
+                                             PAGE_WRITECOPY, 0, 0, nullptr );
+        if ( mapping_handle == nullptr ) {
+            close();
+            return false;
+        }
+
+        base = static_cast<char*>(
+            MapViewOfFile( mapping_handle, FILE_MAP_COPY, 0, 0, 0 ) );
+        if ( base == nullptr ) {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>( file_size.QuadPart );
+
+        return true;
+#elif defined( ELFIO_HAS_MMAP )
+        int fd = ::open( file_name.c_str(), O_RDONLY );
+        if ( fd < 0 ) {
+            return false;
+        }
+
+        struct stat st;
+        if ( fstat( fd, &st ) != 0 || st.st_size <= 0 ||
+             static_cast<unsigned long long>( st.st_size ) >
+                 std::numeric_limits<size_t>::max() ) {
+            ::close( fd );
+            return false;
+        }
+
+        void* p = mmap( nullptr, static_cast<size_t>( st.st_size ),
+                        PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+        ::close( fd );
+        if ( p == MAP_FAILED ) {
+            return false;
+        }
+
+        base   = static_cast<char*>( p );
+        length = static_cast<size_t>( st.st_size );
+
+        return true;
+#else
+        (void)file_name;
+        return false;
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Unmap the file
+    void close()
+    {
+#if defined( ELFIO_HAS_MMAP ) && defined( _WIN32 )
+        if ( base != nullptr ) {
+            UnmapViewOfFile( base );
+        }
+        if ( mapping_handle != nullptr ) {
+            CloseHandle( mapping_handle );
+            mapping_handle = nullptr;
+        }
+        if ( file_handle != INVALID_HANDLE_VALUE ) {
+            CloseHandle( file_handle );
+            file_handle = INVALID_HANDLE_VALUE;
+        }
+#elif defined( ELFIO_HAS_MMAP )
+        if ( base != nullptr ) {
+            munmap( base, length );
+        }
+#endif
+        base   = nullptr;
+        length = 0;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether memory mapping is supported on this platform
+    //! \return True if supported, false otherwise
+    static constexpr bool is_supported()
+    {
+#if defined( ELFIO_HAS_MMAP )
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the beginning of the mapped memory
+    //! \return Pointer to the mapped memory, or nullptr if nothing is mapped
+    const char* get_data() const { return base; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the size of the mapped file
+    //! \return Size of the mapped file
+    size_t get_size() const { return length; }
+
+  private:
+    char*  base   = nullptr; //!< Beginning of the mapped memory
+    size_t length = 0;       //!< Size of the mapped file
+#if defined( ELFIO_HAS_MMAP ) && defined( _WIN32 )
+    HANDLE file_handle    = INVALID_HANDLE_VALUE; //!< File handle
+    HANDLE mapping_handle = nullptr;              //!< File mapping handle
+#endif
+};
+
+//------------------------------------------------------------------------------
+//! \class positional_file
+//! \brief Read-only file allowing concurrent reads at explicit offsets.
+//!
+//! Unlike a stream, it has no current position, so several threads
+//! may read different parts of the file at the same time
+class positional_file
+{
+  public:
+    //------------------------------------------------------------------------------
+    positional_file() = default;
+    positional_file( const positional_file& )            = delete;
+    positional_file& operator=( const positional_file& ) = delete;
+    ~positional_file() { close(); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Open the file for reading
+    //! \param file_name The name of the file to open
+    //! \return True if successful, false otherwise
+    bool open( const std::string& file_name )
+    {
+        close();
+#if defined( ELFIO_HAS_MMAP ) && defined( _WIN32 )
+        file_handle =
+            CreateFileA( file_name.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                         nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+        return file_handle != INVALID_HANDLE_VALUE;
+#elif defined( ELFIO_HAS_MMAP )
+        fd = ::open( file_name.c_str(), O_RDONLY );
+        return fd >= 0;
+#else
+        (void)file_name;
+        return false;
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Close the file
+    void close()
+    {
+#if defined( ELFIO_HAS_MMAP ) && defined( _WIN32 )
+        if ( file_handle != INVALID_HANDLE_VALUE ) {
+            CloseHandle( file_handle );
+            file_handle = INVALID_HANDLE_VALUE;
+        }
+#elif defined( ELFIO_HAS_MMAP )
+        if ( fd >= 0 ) {
+            ::close( fd );
+            fd = -1;
+        }
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether positional reads are supported on this platform
+    //! \return True if supported, false otherwise
+    static constexpr bool is_supported() { return mapped_file::is_supported(); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read a block of the file. May be called concurrently
+    //! \param offset File offset of the block
+    //! \param buffer Buffer receiving the block
+    //! \param size Size of the block
+    //! \return True if the whole block was read, false otherwise
+    bool read( unsigned long long offset, char* buffer, size_t size ) const
+    {
+#if defined( ELFIO_HAS_MMAP ) && defined( _WIN32 )
+        while ( size > 0 ) {
+            DWORD      portion = static_cast<DWORD>( std::min<size_t>(
+                size, std::numeric_limits<DWORD>::max() ) );
+            DWORD      done    = 0;
+            OVERLAPPED overlapped{};
+            overlapped.Offset     = static_cast<DWORD>( offset );
+            overlapped.OffsetHigh = static_cast<DWORD>( offset >> 32 );
+            if ( !ReadFile( file_handle, buffer, portion, &done,
+                            &overlapped ) ||
+                 done == 0 ) {
+                return false;
+            }
+            offset += done;
+            buffer += done;
+            size -= done;
+        }
+        return true;
+#elif defined( ELFIO_HAS_MMAP )
+        while ( size > 0 ) {
+            ssize_t done = ::pread( fd, buffer, size, off_t( offset ) );
+            if ( done < 0 && errno == EINTR ) {
+                continue;
+            }
+            if ( done <= 0 ) {
+                return false;
+            }
+            offset += size_t( done );
+            buffer += done;
+            size -= size_t( done );
+        }
+        return true;
+#else
+        (void)offset;
+        (void)buffer;
+        return size == 0;
+#endif
+    }
+
+  private:
+#if defined( ELFIO_HAS_MMAP ) && defined( _WIN32 )
+    HANDLE file_handle = INVALID_HANDLE_VALUE; //!< File handle
+#elif defined( ELFIO_HAS_MMAP )
+    int fd = -1; //!< File descriptor
+#endif
+};
+
+//------------------------------------------------------------------------------
+//! \class memory_streambuf
+//! \brief Read-only stream buffer over a memory block
+class memory_streambuf : public std::streambuf
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param data Pointer to the memory block
+    //! \param size Size of the memory block
+    memory_streambuf( const char* data, size_t size )
+    {
+        char* p = const_cast<char*>( data );
+        setg( p, p, p + size );
+    }
+
+  protected:
+    //------------------------------------------------------------------------------
+    pos_type seekoff( off_type                off,
+                      std::ios_base::seekdir  dir,
+                      std::ios_base::openmode which ) override
+    {
+        if ( ( which & std::ios_base::in ) == 0 ) {
+            return pos_type( off_type( -1 ) );
+        }
+
+        off_type base_pos = 0;
+        if ( dir == std::ios_base::cur ) {
+            base_pos = gptr() - eback();
+        }
+        else if ( dir == std::ios_base::end ) {
+            base_pos = egptr() - eback();
+        }
+
+        off_type new_pos = base_pos + off;
+        if ( new_pos < 0 || new_pos > egptr() - eback() ) {
+            return pos_type( off_type( -1 ) );
+        }
+
+        setg( eback(), eback() + new_pos, egptr() );
+        return pos_type( new_pos );
+    }
+
+    //------------------------------------------------------------------------------
+    pos_type seekpos( pos_type pos, std::ios_base::openmode which ) override
+    {
+        return seekoff( off_type( pos ), std::ios_base::beg, which );
+    }
+};
+
+//------------------------------------------------------------------------------
+//! \class memory_istream
+//! \brief Input stream reading from a memory block
+class memory_istream : public std::istream
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param data Pointer to the memory block
+    //! \param size Size of the memory block
+    memory_istream( const char* data, size_t size )
+        : std::istream( nullptr ), buffer( data, size )
+    {
+        rdbuf( &buffer );
+    }
+
+  private:
+    memory_streambuf buffer; //!< Stream buffer over the memory block
+};
+
+} // namespace ELFIO
+
+#endif // ELFIO_MMAP_HPP
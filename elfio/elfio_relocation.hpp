@@ -91,6 +91,235 @@ template <> struct get_sym_and_type<Elf64_Rela>
     static int get_r_type( Elf_Xword info ) { return ELF64_R_TYPE( info ); }
 };
 
+//------------------------------------------------------------------------------
+//! \struct relocation_entry
+//! \brief Relocation with its resolved symbol
+struct relocation_entry
+{
+    Elf64_Addr       offset       = 0; //!< Offset of the relocation
+    Elf_Word         symbol       = 0; //!< Index of the symbol
+    unsigned         type         = 0; //!< Type of the relocation
+    Elf_Sxword       addend       = 0; //!< Addend of the relocation
+    Elf64_Addr       symbol_value = 0; //!< Value of the symbol
+    std::string_view symbol_name; //!< Name of the symbol in the string table
+    Elf_Sxword       calc_value = 0; //!< Calculated value
+};
+
+//------------------------------------------------------------------------------
+//! \class relocation_cursor
+//! \brief Reads the entries of a relocation section one after another.
+//!
+//! The relocation data, the symbol table and its string table are located
+//! once on construction, so reading an entry takes constant time.
+//! The three sections are pinned while the cursor exists, so a data cache
+//! doesn't release their data. Symbol names refer to the string table data
+//! and stay valid while the cursor exists and the data of the string table
+//! section is not changed or freed
+class relocation_cursor
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param elf_file Reference to the ELF file
+    //! \param relocations Pointer to the relocation section
+    relocation_cursor( const elfio& elf_file, const section* relocations )
+        : convertor( elf_file.get_convertor() ),
+          is_64( elf_file.get_class() == ELFCLASS64 )
+    {
+        if ( relocations == nullptr ||
+             ( relocations->get_type() != SHT_REL &&
+               relocations->get_type() != SHT_RELA ) ) {
+            return;
+        }
+
+        is_rela         = relocations->get_type() == SHT_RELA;
+        relocations_pin = data_pin<section>( relocations );
+        data            = relocations_pin.get();
+        entry_size = relocations->get_entry_size();
+        if ( data != nullptr && entry_size >= get_min_entry_size() ) {
+            entries_num = relocations->get_size() / entry_size;
+        }
+
+        const section* symbols =
+            elf_file.sections[(Elf_Half)relocations->get_link()];
+        if ( symbols == nullptr ) {
+            return;
+        }
+        symbols_pin        = data_pin<section>( symbols );
+        symbols_data       = symbols_pin.get();
+        symbols_entry_size = symbols->get_entry_size();
+        if ( symbols_data != nullptr &&
+             symbols_entry_size >=
+                 ( is_64 ? sizeof( Elf64_Sym ) : sizeof( Elf32_Sym ) ) ) {
+            symbols_num = symbols->get_size() / symbols_entry_size;
+        }
+
+        const section* strings =
+            elf_file.sections[(Elf_Half)symbols->get_link()];
+        strings_pin = data_pin<section>( strings );
+        if ( strings_pin.get() != nullptr ) {
+            strings_data = strings_pin.get();
+            strings_size = strings->get_size();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the number of entries
+    //! \return Number of entries
+    Elf_Xword get_entries_num() const { return entries_num; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the index of the entry returned by the next call of next()
+    //! \return Index of the entry
+    Elf_Xword get_position() const { return position; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the index of the entry returned by the next call of next()
+    //! \param index Index of the entry
+    void set_position( Elf_Xword index ) { position = index; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read the entry at the current position and advance
+    //! \param entry The entry read
+    //! \return True if an entry was read, false at the end of the section.
+    //!         The position advances also when the symbol can't be resolved
+    bool next( relocation_entry& entry )
+    {
+        if ( position >= entries_num ) {
+            return false;
+        }
+
+        get_entry( position++, entry );
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read an entry and resolve its symbol
+    //! \param index Index of the entry
+    //! \param entry The entry read
+    //! \return True if successful, false if the index is out of range or
+    //!         the symbol can't be found. The relocation fields are filled
+    //!         in the latter case
+    bool get_entry( Elf_Xword index, relocation_entry& entry ) const
+    {
+        if ( index >= entries_num ) {
+            return false;
+        }
+
+        const char* p = data + index * entry_size;
+        if ( is_64 ) {
+            is_rela ? read_relocation<Elf64_Rela>( p, entry )
+                    : read_relocation<Elf64_Rel>( p, entry );
+            return resolve_symbol<Elf64_Sym>( entry );
+        }
+
+        is_rela ? read_relocation<Elf32_Rela>( p, entry )
+                : read_relocation<Elf32_Rel>( p, entry );
+        return resolve_symbol<Elf32_Sym>( entry );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Calculate the value of an i386 relocation
+    //! \param entry The entry with the resolved symbol
+    //! \return Calculated value, 0 for not supported types
+    static Elf_Sxword calc_value( const relocation_entry& entry )
+    {
+        switch ( entry.type ) {
+        case R_386_32: // S + A
+            return entry.symbol_value + entry.addend;
+        case R_386_PC32: // S + A - P
+            return entry.symbol_value + entry.addend - entry.offset;
+        case R_386_GLOB_DAT: // S
+        case R_386_JMP_SLOT: // S
+            return entry.symbol_value;
+        case R_386_RELATIVE: // B + A
+            return entry.addend;
+        default: // none, GOT32, PLT32, COPY, GOTOFF, GOTPC, not recognized
+            return 0;
+        }
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    //! \brief Get the size of the relocation structure of the section
+    //! \return Size of the structure
+    size_t get_min_entry_size() const
+    {
+        if ( is_64 ) {
+            return is_rela ? sizeof( Elf64_Rela ) : sizeof( Elf64_Rel );
+        }
+        return is_rela ? sizeof( Elf32_Rela ) : sizeof( Elf32_Rel );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Decode a relocation without addend
+    //! \param p Pointer to the relocation
+    //! \param entry The entry to fill
+    template <class T>
+    void read_relocation( const char* p, relocation_entry& entry ) const
+    {
+        const auto* rel = reinterpret_cast<const T*>( p );
+        Elf_Xword   info = ( *convertor )( rel->r_info );
+        entry.offset     = ( *convertor )( rel->r_offset );
+        entry.symbol     = get_sym_and_type<T>::get_r_sym( info );
+        entry.type       = get_sym_and_type<T>::get_r_type( info );
+        if constexpr ( std::is_same_v<T, Elf32_Rela> ||
+                       std::is_same_v<T, Elf64_Rela> ) {
+            entry.addend = ( *convertor )( rel->r_addend );
+        }
+        else {
+            entry.addend = 0;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Find the symbol of a relocation and calculate its value
+    //! \param entry The entry with the decoded relocation
+    //! \return True if the symbol was found, false otherwise
+    template <class T> bool resolve_symbol( relocation_entry& entry ) const
+    {
+        entry.symbol_value = 0;
+        entry.symbol_name  = std::string_view();
+        entry.calc_value   = 0;
+        if ( entry.symbol >= symbols_num ) {
+            return false;
+        }
+
+        const auto* sym = reinterpret_cast<const T*>(
+            symbols_data + entry.symbol * symbols_entry_size );
+        entry.symbol_value = ( *convertor )( sym->st_value );
+
+        Elf_Word name = ( *convertor )( sym->st_name );
+        if ( name < strings_size ) {
+            const char* str = strings_data + name;
+            const void* end = std::memchr( str, '\0', strings_size - name );
+            if ( end != nullptr ) {
+                entry.symbol_name = std::string_view(
+                    str, size_t( static_cast<const char*>( end ) - str ) );
+            }
+        }
+
+        entry.calc_value = calc_value( entry );
+        return true;
+    }
+
+    std::shared_ptr<endianness_convertor> convertor; //!< Endianness convertor
+    bool        is_64       = false;   //!< Whether the file is ELFCLASS64
+    bool        is_rela     = false;   //!< Whether entries have addends
+    const char* data        = nullptr; //!< Relocation section data
+    Elf_Xword   entry_size  = 0;       //!< Size of a relocation entry
+    Elf_Xword   entries_num = 0;       //!< Number of relocation entries
+    Elf_Xword   position    = 0;       //!< Index of the next entry
+    const char* symbols_data       = nullptr; //!< Symbol table data
+    Elf_Xword   symbols_entry_size = 0;       //!< Size of a symbol entry
+    Elf_Xword   symbols_num        = 0;       //!< Number of symbols
+    const char* strings_data       = nullptr; //!< String table data
+    Elf_Xword   strings_size       = 0;       //!< Size of the string table
+    data_pin<section> relocations_pin; //!< Pin of the relocation section
+    data_pin<section> symbols_pin;     //!< Pin of the symbol table
+    data_pin<section> strings_pin;     //!< Pin of the string table
+};
+
 //------------------------------------------------------------------------------
 //! \class relocation_section_accessor_template
 //! \brief Class for accessing relocation section data
@@ -166,6 +395,10 @@ template <class S> class relocation_section_accessor_template
 
     //------------------------------------------------------------------------------
     //! \brief Get an entry with additional information
+    //!
+    //! Only the requested entry, its symbol and its name are read. Use
+    //! relocation_cursor to read many entries: it locates the symbol table
+    //! and the string table once and returns the names without copies
     //! \param index Index of the entry
     //! \param offset Offset of the entry
     //! \param symbolValue Value of the symbol
@@ -182,59 +415,23 @@ template <class S> class relocation_section_accessor_template
                     Elf_Sxword&  addend,
                     Elf_Sxword&  calcValue ) const
     {
-        // Do regular job
-        Elf_Word symbol = 0;
-        bool     ret    = get_entry( index, offset, symbol, type, addend );
-
-        // Find the symbol
-        Elf_Xword     size;
-        unsigned char bind;
-        unsigned char symbolType;
-        Elf_Half      section;
-        unsigned char other;
-
-        symbol_section_accessor symbols(
-            elf_file, elf_file.sections[get_symbol_table_index()] );
-        ret = ret && symbols.get_symbol( symbol, symbolName, symbolValue, size,
-                                         bind, symbolType, section, other );
-
+        relocation_entry entry;
+        if ( !get_entry( index, entry.offset, entry.symbol, entry.type,
+                         entry.addend ) ) {
+            return false;
+        }
+        offset = entry.offset;
+        type   = entry.type;
+        addend = entry.addend;
+
+        bool ret = elf_file.get_class() == ELFCLASS64
+                       ? generic_resolve_symbol<Elf64_Sym>(
+                             entry.symbol, entry.symbol_value, symbolName )
+                       : generic_resolve_symbol<Elf32_Sym>(
+                             entry.symbol, entry.symbol_value, symbolName );
         if ( ret ) { // Was it successful?
-            switch ( type ) {
-            case R_386_NONE: // none
-                calcValue = 0;
-                break;
-            case R_386_32: // S + A
-                calcValue = symbolValue + addend;
-                break;
-            case R_386_PC32: // S + A - P
-                calcValue = symbolValue + addend - offset;
-                break;
-            case R_386_GOT32: // G + A - P
-                calcValue = 0;
-                break;
-            case R_386_PLT32: // L + A - P
-                calcValue = 0;
-                break;
-            case R_386_COPY: // none
-                calcValue = 0;
-                break;
-            case R_386_GLOB_DAT: // S
-            case R_386_JMP_SLOT: // S
-                calcValue = symbolValue;
-                break;
-            case R_386_RELATIVE: // B + A
-                calcValue = addend;
-                break;
-            case R_386_GOTOFF: // S + A - GOT
-                calcValue = 0;
-                break;
-            case R_386_GOTPC: // GOT + A - P
-                calcValue = 0;
-                break;
-            default: // Not recognized symbol!
-                calcValue = 0;
-                break;
-            }
+            symbolValue = entry.symbol_value;
+            calcValue   = relocation_cursor::calc_value( entry );
         }
 
         return ret;
@@ -278,6 +475,9 @@ template <class S> class relocation_section_accessor_template
                                                     addend );
             }
         }
+        relocation_section->mark_data_modified(
+            index * relocation_section->get_entry_size(),
+            relocation_section->get_entry_size() );
 
         return true;
     }
@@ -411,6 +611,66 @@ template <class S> class relocation_section_accessor_template
         return (Elf_Half)relocation_section->get_link();
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Read the value and the name of a symbol of the linked table.
+    //!        The symbol table and its string table are located once and
+    //!        located again only if the section links change
+    //! \param symbol Index of the symbol
+    //! \param value Value of the symbol
+    //! \param name Name of the symbol, empty if it is not terminated
+    //! \return True if the symbol exists, false otherwise
+    template <class T>
+    bool generic_resolve_symbol( Elf_Word     symbol,
+                                 Elf64_Addr&  value,
+                                 std::string& name ) const
+    {
+        Elf_Word symbols_link = relocation_section->get_link();
+        if ( symbol_table == nullptr || symbols_link != symbol_table_link ) {
+            symbol_table      = elf_file.sections[(Elf_Half)symbols_link];
+            symbol_table_link = symbols_link;
+            string_table      = nullptr;
+        }
+        if ( symbol_table == nullptr ||
+             symbol_table->get_entry_size() < sizeof( T ) ) {
+            return false;
+        }
+        Elf_Word strings_link = symbol_table->get_link();
+        if ( string_table == nullptr || strings_link != string_table_link ) {
+            string_table      = elf_file.sections[(Elf_Half)strings_link];
+            string_table_link = strings_link;
+        }
+
+        // Each pointer is used before the next section data is requested,
+        // so a data cache may release them afterwards
+        const char* symbols = symbol_table->get_data();
+        if ( symbols == nullptr ||
+             symbol >= symbol_table->get_size() /
+                           symbol_table->get_entry_size() ) {
+            return false;
+        }
+        const auto* sym = reinterpret_cast<const T*>(
+            symbols + symbol * symbol_table->get_entry_size() );
+        const auto& convertor   = elf_file.get_convertor();
+        Elf_Word    name_offset = ( *convertor )( sym->st_name );
+        value                   = ( *convertor )( sym->st_value );
+
+        name.clear();
+        const char* strings =
+            string_table != nullptr ? string_table->get_data() : nullptr;
+        Elf_Xword strings_size =
+            string_table != nullptr ? string_table->get_size() : 0;
+        if ( strings != nullptr && name_offset < strings_size ) {
+            const char* str = strings + name_offset;
+            const void* end =
+                std::memchr( str, '\0', size_t( strings_size - name_offset ) );
+            if ( end != nullptr ) {
+                name.assign( str, static_cast<const char*>( end ) );
+            }
+        }
+
+        return true;
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Get a generic entry for REL type
     //! \param index Index of the entry
@@ -584,6 +844,10 @@ template <class S> class relocation_section_accessor_template
   private:
     const elfio& elf_file;
     S*           relocation_section = nullptr;
+    mutable const section* symbol_table = nullptr; //!< Linked symbol table
+    mutable const section* string_table = nullptr; //!< Its string table
+    mutable Elf_Word symbol_table_link = 0; //!< Link of the symbol_table
+    mutable Elf_Word string_table_link = 0; //!< Link of the string_table
 };
 
 using relocation_section_accessor =
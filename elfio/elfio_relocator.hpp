@@ -0,0 +1,1363 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ELFIO_RELOCATOR_HPP
+#define ELFIO_RELOCATOR_HPP
+
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <elfio/elfio.hpp>
+
+namespace ELFIO {
+
+//------------------------------------------------------------------------------
+//! \enum relocation_status
+//! \brief Result of applying a relocation
+enum class relocation_status
+{
+    applied,       //!< The relocation was applied
+    unsupported,   //!< The relocation type is not supported
+    unresolved,    //!< The symbol of the relocation has no value
+    overflow,      //!< The value does not fit into the relocated field
+    out_of_bounds, //!< The relocated field is outside of the target buffer
+};
+
+//------------------------------------------------------------------------------
+//! \struct relocation_issue
+//! \brief Relocation that was not applied
+struct relocation_issue
+{
+    Elf_Xword         index;  //!< Index of the relocation entry
+    unsigned          type;   //!< Type of the relocation
+    relocation_status status; //!< Reason the relocation was not applied
+};
+
+//------------------------------------------------------------------------------
+//! \struct relocation_report
+//! \brief Outcome of applying a relocation section
+struct relocation_report
+{
+    Elf_Xword                     applied = 0; //!< Number of applied entries
+    std::vector<relocation_issue> issues;      //!< Entries not applied
+};
+
+//------------------------------------------------------------------------------
+//! \struct relocation_values
+//! \brief Values of a relocation entry used by relocation calculations
+struct relocation_values
+{
+    Elf64_Addr S       = 0;     //!< Value of the symbol
+    Elf_Sxword A       = 0;     //!< Explicit addend of a RELA entry
+    Elf64_Addr P       = 0;     //!< Address of the relocated field
+    Elf64_Addr B       = 0;     //!< Base address of the loaded image
+    bool       is_rela = false; //!< Whether A holds the addend
+    bool       is_64   = false; //!< Whether the file is ELFCLASS64
+};
+
+//------------------------------------------------------------------------------
+//! \class relocation_place
+//! \brief Bounds checked access to the fields of a relocation target buffer
+class relocation_place
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param data The target buffer
+    //! \param size Size of the target buffer
+    //! \param data_convertor Endianness of the data fields
+    //! \param code_convertor Endianness of the instructions
+    relocation_place( char*                       data,
+                      size_t                      size,
+                      const endianness_convertor& data_convertor,
+                      const endianness_convertor& code_convertor )
+        : data( data ), size( size ), data_convertor( data_convertor ),
+          code_convertor( code_convertor )
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the offset of the relocated field in the target buffer
+    //! \param value The offset
+    void set_position( Elf64_Addr value ) { position = value; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read a data field
+    //! \param value The value read
+    //! \param offset Offset from the relocated field
+    //! \return True if the field is inside of the buffer, false otherwise
+    template <class U> bool read( U& value, size_t offset = 0 ) const
+    {
+        return read( value, offset, data_convertor );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Write a data field
+    //! \param value The value to write
+    //! \param offset Offset from the relocated field
+    //! \return True if the field is inside of the buffer, false otherwise
+    template <class U> bool write( U value, size_t offset = 0 )
+    {
+        return write( value, offset, data_convertor );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Read an instruction
+    //! \param value The value read
+    //! \param offset Offset from the relocated field
+    //! \return True if the instruction is inside of the buffer, false otherwise
+    template <class U> bool read_code( U& value, size_t offset = 0 ) const
+    {
+        return read( value, offset, code_convertor );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Write an instruction
+    //! \param value The value to write
+    //! \param offset Offset from the relocated field
+    //! \return True if the instruction is inside of the buffer, false otherwise
+    template <class U> bool write_code( U value, size_t offset = 0 )
+    {
+        return write( value, offset, code_convertor );
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    bool is_inside( size_t offset, size_t length ) const
+    {
+        return position <= size && offset <= size - position &&
+               length <= size - position - offset;
+    }
+
+    //------------------------------------------------------------------------------
+    template <class U>
+    bool read( U&                          value,
+               size_t                      offset,
+               const endianness_convertor& convertor ) const
+    {
+        if ( !is_inside( offset, sizeof( U ) ) ) {
+            return false;
+        }
+        std::memcpy( &value, data + position + offset, sizeof( U ) );
+        value = convertor( value );
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    template <class U>
+    bool write( U value, size_t offset, const endianness_convertor& convertor )
+    {
+        if ( !is_inside( offset, sizeof( U ) ) ) {
+            return false;
+        }
+        value = convertor( value );
+        std::memcpy( data + position + offset, &value, sizeof( U ) );
+        return true;
+    }
+
+    char*                       data;           //!< The target buffer
+    size_t                      size;           //!< Size of the target buffer
+    Elf64_Addr                  position = 0;   //!< Offset of the field
+    const endianness_convertor& data_convertor; //!< Endianness of data
+    const endianness_convertor& code_convertor; //!< Endianness of code
+};
+
+//------------------------------------------------------------------------------
+//! \class relocation_kernel_base
+//! \brief Calculations shared by the relocation kernels of the architectures.
+//!
+//! A kernel applies one relocation by its type in apply(). The relocator
+//! creates one kernel object for every relocation section it applies
+class relocation_kernel_base
+{
+  protected:
+    //------------------------------------------------------------------------------
+    //! \brief Overflow check of a relocated data field
+    enum class range
+    {
+        none,      //!< The value is truncated to the field
+        is_signed, //!< The value has to fit as a signed value
+        is_unsigned, //!< The value has to fit as an unsigned value
+        any,         //!< The value has to fit as a signed or unsigned value
+    };
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether a value fits into a signed field
+    //! \param value The value
+    //! \param bits Width of the field
+    //! \return True if the value fits, false otherwise
+    static bool fits_signed( Elf_Sxword value, unsigned bits )
+    {
+        return value >= -( Elf_Sxword( 1 ) << ( bits - 1 ) ) &&
+               value < ( Elf_Sxword( 1 ) << ( bits - 1 ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether a value fits into a field
+    //! \param value The value
+    //! \param bits Width of the field
+    //! \param check The kind of the check
+    //! \return True if the value fits, false otherwise
+    static bool fits( Elf_Sxword value, unsigned bits, range check )
+    {
+        if ( bits >= 64 ) {
+            return true;
+        }
+
+        switch ( check ) {
+        case range::is_signed:
+            return fits_signed( value, bits );
+        case range::is_unsigned:
+            return Elf_Xword( value ) < ( Elf_Xword( 1 ) << bits );
+        case range::any:
+            return value >= -( Elf_Sxword( 1 ) << ( bits - 1 ) ) &&
+                   value < ( Elf_Sxword( 1 ) << bits );
+        default:
+            return true;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the addend of a relocation. REL entries keep it in
+    //!        the relocated data field
+    //! \param v The relocation values
+    //! \param place The relocated field
+    //! \param addend The addend
+    //! \return True if successful, false if the field is out of bounds
+    template <class U>
+    static bool get_addend( const relocation_values& v,
+                            const relocation_place&  place,
+                            Elf_Sxword&              addend )
+    {
+        if ( v.is_rela ) {
+            addend = v.A;
+            return true;
+        }
+
+        U value;
+        if ( !place.read( value ) ) {
+            return false;
+        }
+        addend = Elf_Sxword( std::make_signed_t<U>( value ) );
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Write a value into a data field
+    //! \param place The relocated field
+    //! \param value The value
+    //! \return applied or out_of_bounds
+    template <class U>
+    static relocation_status store( relocation_place& place, Elf64_Addr value )
+    {
+        return place.write( U( value ) ) ? relocation_status::applied
+                                         : relocation_status::out_of_bounds;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Apply S + A, or S + A - P, to a data field
+    //! \param v The relocation values
+    //! \param place The relocated field
+    //! \param is_relative Whether P is subtracted
+    //! \param check Overflow check of the value
+    //! \return Status of the relocation
+    template <class U>
+    static relocation_status store_symbol( const relocation_values& v,
+                                           relocation_place&        place,
+                                           bool  is_relative,
+                                           range check )
+    {
+        Elf_Sxword addend;
+        if ( !get_addend<U>( v, place, addend ) ) {
+            return relocation_status::out_of_bounds;
+        }
+
+        Elf_Sxword value =
+            Elf_Sxword( v.S + addend - ( is_relative ? v.P : 0 ) );
+        if ( !fits( value, sizeof( U ) * 8, check ) ) {
+            return relocation_status::overflow;
+        }
+        return store<U>( place, Elf64_Addr( value ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Apply B + A to a data field
+    //! \param v The relocation values
+    //! \param place The relocated field
+    //! \return Status of the relocation
+    template <class U>
+    static relocation_status store_relative( const relocation_values& v,
+                                             relocation_place&        place )
+    {
+        Elf_Sxword addend;
+        if ( !get_addend<U>( v, place, addend ) ) {
+            return relocation_status::out_of_bounds;
+        }
+        return store<U>( place, v.B + addend );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Replace bits of an instruction
+    //! \param place The relocated field
+    //! \param mask The bits to replace
+    //! \param bits The new bits
+    //! \return applied or out_of_bounds
+    template <class U>
+    static relocation_status
+    patch( relocation_place& place, U mask, U bits, size_t offset = 0 )
+    {
+        U insn;
+        if ( !place.read_code( insn, offset ) ||
+             !place.write_code( U( ( insn & ~mask ) | ( bits & mask ) ),
+                                offset ) ) {
+            return relocation_status::out_of_bounds;
+        }
+        return relocation_status::applied;
+    }
+};
+
+//------------------------------------------------------------------------------
+//! \class i386_relocation_kernel
+//! \brief Relocations of EM_386
+class i386_relocation_kernel : public relocation_kernel_base
+{
+  public:
+    //------------------------------------------------------------------------------
+    relocation_status
+    apply( unsigned type, const relocation_values& v, relocation_place& place )
+    {
+        using std::uint16_t;
+        using std::uint32_t;
+        using std::uint8_t;
+
+        switch ( type ) {
+        case R_386_NONE:
+            return relocation_status::applied;
+        case R_386_32: // S + A
+            return store_symbol<uint32_t>( v, place, false, range::none );
+        case R_386_PC32:  // S + A - P
+        case R_386_PLT32: // L + A - P, bound directly to the symbol
+            return store_symbol<uint32_t>( v, place, true, range::none );
+        case R_386_GLOB_DAT: // S
+        case R_386_JMP_SLOT: // S
+            return store<uint32_t>( place, v.S );
+        case R_386_RELATIVE: // B + A
+            return store_relative<uint32_t>( v, place );
+        case R_386_16:
+            return store_symbol<uint16_t>( v, place, false, range::any );
+        case R_386_PC16:
+            return store_symbol<uint16_t>( v, place, true, range::is_signed );
+        case R_386_8:
+            return store_symbol<uint8_t>( v, place, false, range::any );
+        case R_386_PC8:
+            return store_symbol<uint8_t>( v, place, true, range::is_signed );
+        default:
+            return relocation_status::unsupported;
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+//! \class x86_64_relocation_kernel
+//! \brief Relocations of EM_X86_64
+class x86_64_relocation_kernel : public relocation_kernel_base
+{
+  public:
+    //------------------------------------------------------------------------------
+    relocation_status
+    apply( unsigned type, const relocation_values& v, relocation_place& place )
+    {
+        using std::uint16_t;
+        using std::uint32_t;
+        using std::uint64_t;
+        using std::uint8_t;
+
+        switch ( type ) {
+        case R_X86_64_NONE:
+            return relocation_status::applied;
+        case R_X86_64_64: // S + A
+            return store_symbol<uint64_t>( v, place, false, range::none );
+        case R_X86_64_PC32:  // S + A - P
+        case R_X86_64_PLT32: // L + A - P, bound directly to the symbol
+            return store_symbol<uint32_t>( v, place, true, range::is_signed );
+        case R_X86_64_GLOB_DAT:  // S
+        case R_X86_64_JUMP_SLOT: // S
+            return store<uint64_t>( place, v.S );
+        case R_X86_64_RELATIVE: // B + A
+            return store_relative<uint64_t>( v, place );
+        case R_X86_64_32: // S + A, zero extended
+            return store_symbol<uint32_t>( v, place, false,
+                                           range::is_unsigned );
+        case R_X86_64_32S: // S + A, sign extended
+            return store_symbol<uint32_t>( v, place, false, range::is_signed );
+        case R_X86_64_16:
+            return store_symbol<uint16_t>( v, place, false, range::any );
+        case R_X86_64_PC16:
+            return store_symbol<uint16_t>( v, place, true, range::is_signed );
+        case R_X86_64_8:
+            return store_symbol<uint8_t>( v, place, false, range::any );
+        case R_X86_64_PC8:
+            return store_symbol<uint8_t>( v, place, true, range::is_signed );
+        case R_X86_64_PC64: // S + A - P
+            return store_symbol<uint64_t>( v, place, true, range::none );
+        default:
+            return relocation_status::unsupported;
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+//! \class aarch64_relocation_kernel
+//! \brief Relocations of EM_AARCH64
+class aarch64_relocation_kernel : public relocation_kernel_base
+{
+  public:
+    //------------------------------------------------------------------------------
+    relocation_status
+    apply( unsigned type, const relocation_values& v, relocation_place& place )
+    {
+        using std::uint16_t;
+        using std::uint32_t;
+        using std::uint64_t;
+
+        Elf_Sxword x = Elf_Sxword( v.S + v.A );
+        Elf_Sxword r = Elf_Sxword( v.S + v.A - v.P );
+        switch ( type ) {
+        case R_AARCH64_NONE:
+            return relocation_status::applied;
+        case R_AARCH64_ABS64:     // S + A
+        case R_AARCH64_GLOB_DAT:  // S + A
+        case R_AARCH64_JUMP_SLOT: // S + A
+            return store_symbol<uint64_t>( v, place, false, range::none );
+        case R_AARCH64_ABS32:
+            return store_symbol<uint32_t>( v, place, false, range::any );
+        case R_AARCH64_ABS16:
+            return store_symbol<uint16_t>( v, place, false, range::any );
+        case R_AARCH64_PREL64: // S + A - P
+            return store_symbol<uint64_t>( v, place, true, range::none );
+        case R_AARCH64_PREL32:
+            return store_symbol<uint32_t>( v, place, true, range::any );
+        case R_AARCH64_PREL16:
+            return store_symbol<uint16_t>( v, place, true, range::any );
+        case R_AARCH64_RELATIVE: // B + A
+            return store_relative<uint64_t>( v, place );
+        case R_AARCH64_CALL26:
+        case R_AARCH64_JUMP26:
+            return branch( place, r, 28, 0, 0x03ffffff );
+        case R_AARCH64_CONDBR19:
+        case R_AARCH64_LD_PREL_LO19:
+            return branch( place, r, 21, 5, 0x7ffff );
+        case R_AARCH64_TSTBR14:
+            return branch( place, r, 16, 5, 0x3fff );
+        case R_AARCH64_ADR_PREL_LO21:
+            if ( !fits_signed( r, 21 ) ) {
+                return relocation_status::overflow;
+            }
+            return adr( place, r );
+        case R_AARCH64_ADR_PREL_PG_HI21:
+        case R_AARCH64_ADR_PREL_PG_HI21_NC: {
+            Elf_Sxword page = Elf_Sxword( ( Elf64_Addr( x ) & ~0xFFFull ) -
+                                          ( v.P & ~0xFFFull ) );
+            if ( type == R_AARCH64_ADR_PREL_PG_HI21 &&
+                 !fits_signed( page, 33 ) ) {
+                return relocation_status::overflow;
+            }
+            return adr( place, page >> 12 );
+        }
+        case R_AARCH64_ADD_ABS_LO12_NC:
+        case R_AARCH64_LDST8_ABS_LO12_NC:
+            return imm12( place, x, 0 );
+        case R_AARCH64_LDST16_ABS_LO12_NC:
+            return imm12( place, x, 1 );
+        case R_AARCH64_LDST32_ABS_LO12_NC:
+            return imm12( place, x, 2 );
+        case R_AARCH64_LDST64_ABS_LO12_NC:
+            return imm12( place, x, 3 );
+        case R_AARCH64_LDST128_ABS_LO12_NC:
+            return imm12( place, x, 4 );
+        case R_AARCH64_MOVW_UABS_G0:
+        case R_AARCH64_MOVW_UABS_G0_NC:
+            return movw( place, x, 0, type == R_AARCH64_MOVW_UABS_G0 );
+        case R_AARCH64_MOVW_UABS_G1:
+        case R_AARCH64_MOVW_UABS_G1_NC:
+            return movw( place, x, 1, type == R_AARCH64_MOVW_UABS_G1 );
+        case R_AARCH64_MOVW_UABS_G2:
+        case R_AARCH64_MOVW_UABS_G2_NC:
+            return movw( place, x, 2, type == R_AARCH64_MOVW_UABS_G2 );
+        case R_AARCH64_MOVW_UABS_G3:
+            return movw( place, x, 3, false );
+        default:
+            return relocation_status::unsupported;
+        }
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    //! \brief Encode the word offset of a branch or a literal load
+    static relocation_status branch(
+        relocation_place& place, Elf_Sxword value, unsigned bits,
+        unsigned shift, std::uint32_t mask )
+    {
+        if ( !fits_signed( value, bits ) ) {
+            return relocation_status::overflow;
+        }
+        return patch<std::uint32_t>(
+            place, mask << shift,
+            std::uint32_t( ( ( value >> 2 ) & mask ) << shift ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Encode the 21 bit immediate of ADR and ADRP
+    static relocation_status adr( relocation_place& place, Elf_Sxword value )
+    {
+        return patch<std::uint32_t>(
+            place, 0x60ffffe0,
+            std::uint32_t( ( ( value & 0x3 ) << 29 ) |
+                           ( ( ( value >> 2 ) & 0x7ffff ) << 5 ) ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Encode the low 12 bits of an address, scaled by the access size
+    static relocation_status
+    imm12( relocation_place& place, Elf_Sxword value, unsigned scale )
+    {
+        return patch<std::uint32_t>(
+            place, 0x003ffc00,
+            std::uint32_t( ( ( value & 0xfff ) >> scale ) << 10 ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Encode a 16 bit group of an address into MOVZ or MOVK
+    static relocation_status movw( relocation_place& place,
+                                   Elf_Sxword        value,
+                                   unsigned          group,
+                                   bool              is_checked )
+    {
+        if ( is_checked &&
+             !fits( value, 16 * ( group + 1 ), range::is_unsigned ) ) {
+            return relocation_status::overflow;
+        }
+        return patch<std::uint32_t>(
+            place, 0x001fffe0,
+            std::uint32_t( ( ( Elf64_Addr( value ) >> ( 16 * group ) ) &
+                             0xffff )
+                           << 5 ) );
+    }
+};
+
+//------------------------------------------------------------------------------
+//! \class riscv_relocation_kernel
+//! \brief Relocations of EM_RISCV
+//!
+//! The low parts of PC relative addresses refer to the instruction holding
+//! the high part. The kernel remembers the high parts it applied, so both
+//! have to be in the same relocation section, the high part first
+class riscv_relocation_kernel : public relocation_kernel_base
+{
+  public:
+    //------------------------------------------------------------------------------
+    relocation_status
+    apply( unsigned type, const relocation_values& v, relocation_place& place )
+    {
+        using std::uint16_t;
+        using std::uint32_t;
+        using std::uint64_t;
+        using std::uint8_t;
+
+        Elf_Sxword x = Elf_Sxword( v.S + v.A );
+        Elf_Sxword r = Elf_Sxword( v.S + v.A - v.P );
+        switch ( type ) {
+        case R_RISCV_NONE:
+        case R_RISCV_RELAX:
+            return relocation_status::applied;
+        case R_RISCV_32:
+            return store<uint32_t>( place, Elf64_Addr( x ) );
+        case R_RISCV_64:
+            return store<uint64_t>( place, Elf64_Addr( x ) );
+        case R_RISCV_RELATIVE: // B + A
+            return v.is_64 ? store<uint64_t>( place, v.B + v.A )
+                           : store<uint32_t>( place, v.B + v.A );
+        case R_RISCV_JUMP_SLOT: // S
+            return v.is_64 ? store<uint64_t>( place, v.S )
+                           : store<uint32_t>( place, v.S );
+        case R_RISCV_32_PCREL:
+            return store<uint32_t>( place, Elf64_Addr( r ) );
+        case R_RISCV_ADD8:
+            return add<uint8_t>( place, x );
+        case R_RISCV_ADD16:
+            return add<uint16_t>( place, x );
+        case R_RISCV_ADD32:
+            return add<uint32_t>( place, x );
+        case R_RISCV_ADD64:
+            return add<uint64_t>( place, x );
+        case R_RISCV_SUB8:
+            return add<uint8_t>( place, -x );
+        case R_RISCV_SUB16:
+            return add<uint16_t>( place, -x );
+        case R_RISCV_SUB32:
+            return add<uint32_t>( place, -x );
+        case R_RISCV_SUB64:
+            return add<uint64_t>( place, -x );
+        case R_RISCV_SUB6:
+            return patch6( place, x, true );
+        case R_RISCV_SET6:
+            return patch6( place, x, false );
+        case R_RISCV_SET8:
+            return store<uint8_t>( place, Elf64_Addr( x ) );
+        case R_RISCV_SET16:
+            return store<uint16_t>( place, Elf64_Addr( x ) );
+        case R_RISCV_SET32:
+            return store<uint32_t>( place, Elf64_Addr( x ) );
+        case R_RISCV_HI20:
+            return hi20( place, x );
+        case R_RISCV_LO12_I:
+            return lo12_i( place, x );
+        case R_RISCV_LO12_S:
+            return lo12_s( place, x );
+        case R_RISCV_PCREL_HI20:
+            pcrel_hi[v.P] = r;
+            return hi20( place, r );
+        case R_RISCV_PCREL_LO12_I:
+        case R_RISCV_PCREL_LO12_S: {
+            // The symbol is the label of the AUIPC instruction
+            auto hi = pcrel_hi.find( v.S );
+            if ( hi == pcrel_hi.end() ) {
+                return relocation_status::unresolved;
+            }
+            return type == R_RISCV_PCREL_LO12_I ? lo12_i( place, hi->second )
+                                                : lo12_s( place, hi->second );
+        }
+        case R_RISCV_BRANCH:
+            if ( !fits_signed( r, 13 ) ) {
+                return relocation_status::overflow;
+            }
+            return patch<uint32_t>(
+                place, 0xfe000f80,
+                uint32_t( ( ( r & 0x1000 ) << 19 ) | ( ( r & 0x7e0 ) << 20 ) |
+                          ( ( r & 0x1e ) << 7 ) | ( ( r & 0x800 ) >> 4 ) ) );
+        case R_RISCV_JAL:
+            if ( !fits_signed( r, 21 ) ) {
+                return relocation_status::overflow;
+            }
+            return patch<uint32_t>(
+                place, 0xfffff000,
+                uint32_t( ( ( r & 0x100000 ) << 11 ) | ( ( r & 0x7fe ) << 20 ) |
+                          ( ( r & 0x800 ) << 9 ) | ( r & 0xff000 ) ) );
+        case R_RISCV_CALL:
+        case R_RISCV_CALL_PLT: {
+            // AUIPC and JALR pair
+            if ( v.is_64 && !fits_signed( r + 0x800, 32 ) ) {
+                return relocation_status::overflow;
+            }
+            relocation_status status = hi20( place, r );
+            if ( status != relocation_status::applied ) {
+                return status;
+            }
+            return patch<uint32_t>( place, 0xfff00000,
+                                    uint32_t( ( r & 0xfff ) << 20 ), 4 );
+        }
+        case R_RISCV_RVC_BRANCH:
+            if ( !fits_signed( r, 9 ) ) {
+                return relocation_status::overflow;
+            }
+            return patch<uint16_t>(
+                place, 0x1c7c,
+                uint16_t( ( ( r & 0x100 ) << 4 ) | ( ( r & 0x18 ) << 7 ) |
+                          ( ( r & 0xc0 ) >> 1 ) | ( ( r & 0x6 ) << 2 ) |
+                          ( ( r & 0x20 ) >> 3 ) ) );
+        case R_RISCV_RVC_JUMP:
+            if ( !fits_signed( r, 12 ) ) {
+                return relocation_status::overflow;
+            }
+            return patch<uint16_t>(
+                place, 0x1ffc,
+                uint16_t( ( ( r & 0x800 ) << 1 ) | ( ( r & 0x10 ) << 7 ) |
+                          ( ( r & 0x300 ) << 1 ) | ( ( r & 0x400 ) >> 2 ) |
+                          ( ( r & 0x40 ) << 1 ) | ( ( r & 0x80 ) >> 1 ) |
+                          ( ( r & 0xe ) << 2 ) | ( ( r & 0x20 ) >> 3 ) ) );
+        default:
+            // R_RISCV_ALIGN needs code to be removed, which changes
+            // the layout of the section
+            return relocation_status::unsupported;
+        }
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    //! \brief Add a value to a data field
+    template <class U>
+    static relocation_status add( relocation_place& place, Elf_Sxword value )
+    {
+        U field;
+        if ( !place.read( field ) ) {
+            return relocation_status::out_of_bounds;
+        }
+        return store<U>( place, Elf64_Addr( field + U( value ) ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set or subtract the low 6 bits of a byte
+    static relocation_status
+    patch6( relocation_place& place, Elf_Sxword value, bool is_subtracted )
+    {
+        std::uint8_t field;
+        if ( !place.read( field ) ) {
+            return relocation_status::out_of_bounds;
+        }
+        std::uint8_t bits =
+            std::uint8_t( is_subtracted ? field - value : value );
+        return store<std::uint8_t>(
+            place, std::uint8_t( ( field & 0xc0 ) | ( bits & 0x3f ) ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Encode the upper 20 bits of LUI or AUIPC, rounded for the
+    //!        sign extended low part
+    static relocation_status hi20( relocation_place& place, Elf_Sxword value )
+    {
+        return patch<std::uint32_t>(
+            place, 0xfffff000,
+            std::uint32_t( ( value + 0x800 ) & 0xfffff000 ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Encode the low 12 bits of an I-type instruction
+    static relocation_status lo12_i( relocation_place& place, Elf_Sxword value )
+    {
+        return patch<std::uint32_t>( place, 0xfff00000,
+                                     std::uint32_t( ( value & 0xfff ) << 20 ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Encode the low 12 bits of an S-type instruction
+    static relocation_status lo12_s( relocation_place& place, Elf_Sxword value )
+    {
+        return patch<std::uint32_t>(
+            place, 0xfe000f80,
+            std::uint32_t( ( ( value & 0xfe0 ) << 20 ) |
+                           ( ( value & 0x1f ) << 7 ) ) );
+    }
+
+    //! PC relative values applied by R_RISCV_PCREL_HI20, by their address
+    std::unordered_map<Elf64_Addr, Elf_Sxword> pcrel_hi;
+};
+
+//------------------------------------------------------------------------------
+//! \class arm_relocation_kernel
+//! \brief Relocations of EM_ARM.
+//!
+//! Calls between ARM and Thumb code are switched between BL and BLX.
+//! Jumps between them would need veneers and are not supported
+class arm_relocation_kernel : public relocation_kernel_base
+{
+  public:
+    //------------------------------------------------------------------------------
+    relocation_status
+    apply( unsigned type, const relocation_values& v, relocation_place& place )
+    {
+        using std::uint32_t;
+
+        switch ( type ) {
+        case R_ARM_NONE:
+        case R_ARM_V4BX:
+            return relocation_status::applied;
+        case R_ARM_ABS32: // (S + A) | T
+        case R_ARM_TARGET1:
+            return store_symbol<uint32_t>( v, place, false, range::none );
+        case R_ARM_REL32: // ((S + A) | T) - P
+            return store_symbol<uint32_t>( v, place, true, range::none );
+        case R_ARM_GLOB_DAT:  // (S + A) | T
+        case R_ARM_JUMP_SLOT: // (S + A) | T
+            return store<uint32_t>( place, v.S + ( v.is_rela ? v.A : 0 ) );
+        case R_ARM_RELATIVE: // B + A
+            return store_relative<uint32_t>( v, place );
+        case R_ARM_PREL31:
+            return prel31( v, place );
+        case R_ARM_CALL:
+        case R_ARM_JUMP24:
+        case R_ARM_PC24:
+            return branch( type, v, place );
+        case R_ARM_MOVW_ABS_NC:
+        case R_ARM_MOVT_ABS:
+        case R_ARM_MOVW_PREL_NC:
+        case R_ARM_MOVT_PREL:
+            return movw( type, v, place );
+        case R_ARM_THM_CALL:
+        case R_ARM_THM_JUMP24:
+            return thumb_branch( type, v, place );
+        case R_ARM_THM_MOVW_ABS_NC:
+        case R_ARM_THM_MOVT_ABS:
+        case R_ARM_THM_MOVW_PREL_NC:
+        case R_ARM_THM_MOVT_PREL:
+            return thumb_movw( type, v, place );
+        default:
+            return relocation_status::unsupported;
+        }
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    //! \brief Apply the 31 bit offset of an exception table entry
+    static relocation_status prel31( const relocation_values& v,
+                                     relocation_place&        place )
+    {
+        std::uint32_t field;
+        if ( !place.read( field ) ) {
+            return relocation_status::out_of_bounds;
+        }
+        Elf_Sxword addend =
+            v.is_rela ? v.A : Elf_Sxword( std::int32_t( field << 1 ) >> 1 );
+        Elf_Sxword value = Elf_Sxword( v.S + addend - v.P );
+        if ( !fits_signed( value, 31 ) ) {
+            return relocation_status::overflow;
+        }
+        return store<std::uint32_t>(
+            place, ( field & 0x80000000 ) | ( value & 0x7fffffff ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Apply BL, BLX and B
+    static relocation_status branch( unsigned                 type,
+                                     const relocation_values& v,
+                                     relocation_place&        place )
+    {
+        std::uint32_t insn;
+        if ( !place.read_code( insn ) ) {
+            return relocation_status::out_of_bounds;
+        }
+        bool       is_blx = ( insn & 0xfe000000 ) == 0xfa000000;
+        Elf_Sxword addend = v.A;
+        if ( !v.is_rela ) {
+            // BLX keeps bit 1 of the offset in the H bit
+            addend = Elf_Sxword( std::int32_t( insn << 8 ) >> 6 ) |
+                     ( is_blx ? ( insn >> 23 ) & 2 : 0 );
+        }
+        Elf_Sxword value = Elf_Sxword( v.S + addend - v.P );
+
+        bool is_thumb_target = ( value & 1 ) != 0;
+        if ( type == R_ARM_CALL && is_thumb_target != is_blx ) {
+            insn   = is_thumb_target ? 0xfa000000
+                                     : 0xeb000000 | ( insn & 0x00ffffff );
+            is_blx = is_thumb_target;
+        }
+        else if ( type != R_ARM_CALL && is_thumb_target ) {
+            return relocation_status::unsupported;
+        }
+        if ( is_blx ) {
+            insn = ( insn & ~0x01000000u ) |
+                   ( std::uint32_t( value & 2 ) << 23 );
+        }
+
+        if ( !fits_signed( value, 26 ) ) {
+            return relocation_status::overflow;
+        }
+        insn = ( insn & 0xff000000 ) |
+               ( std::uint32_t( value >> 2 ) & 0x00ffffff );
+        return place.write_code( insn ) ? relocation_status::applied
+                                        : relocation_status::out_of_bounds;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Apply MOVW and MOVT
+    static relocation_status movw( unsigned                 type,
+                                   const relocation_values& v,
+                                   relocation_place&        place )
+    {
+        std::uint32_t insn;
+        if ( !place.read_code( insn ) ) {
+            return relocation_status::out_of_bounds;
+        }
+        Elf_Sxword addend =
+            v.is_rela ? v.A
+                      : Elf_Sxword( std::int16_t( ( ( insn >> 4 ) & 0xf000 ) |
+                                                  ( insn & 0x0fff ) ) );
+        std::uint32_t value = std::uint32_t( v.S + addend );
+        if ( type == R_ARM_MOVW_PREL_NC || type == R_ARM_MOVT_PREL ) {
+            value -= std::uint32_t( v.P );
+        }
+        if ( type == R_ARM_MOVT_ABS || type == R_ARM_MOVT_PREL ) {
+            value >>= 16;
+        }
+
+        insn = ( insn & ~0x000f0fffu ) | ( ( value & 0xf000 ) << 4 ) |
+               ( value & 0x0fff );
+        return place.write_code( insn ) ? relocation_status::applied
+                                        : relocation_status::out_of_bounds;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Apply Thumb BL, BLX and B.W
+    static relocation_status thumb_branch( unsigned                 type,
+                                           const relocation_values& v,
+                                           relocation_place&        place )
+    {
+        std::uint16_t hi;
+        std::uint16_t lo;
+        if ( !place.read_code( hi ) || !place.read_code( lo, 2 ) ) {
+            return relocation_status::out_of_bounds;
+        }
+
+        Elf_Sxword addend = v.A;
+        if ( !v.is_rela ) {
+            std::uint32_t s  = ( hi >> 10 ) & 1;
+            std::uint32_t i1 = ( ( lo >> 13 ) & 1 ) ^ s ? 0 : 1;
+            std::uint32_t i2 = ( ( lo >> 11 ) & 1 ) ^ s ? 0 : 1;
+            addend           = Elf_Sxword(
+                std::int32_t( ( ( s << 24 ) | ( i1 << 23 ) | ( i2 << 22 ) |
+                                ( ( hi & 0x3ffu ) << 12 ) |
+                                ( ( lo & 0x7ffu ) << 1 ) )
+                              << 7 ) >>
+                7 );
+        }
+        Elf_Sxword value = Elf_Sxword( v.S + addend - v.P );
+
+        bool is_thumb_target = ( value & 1 ) != 0;
+        bool is_blx          = ( lo & 0x5000 ) == 0x4000;
+        if ( type == R_ARM_THM_CALL && is_thumb_target == is_blx ) {
+            lo     = is_thumb_target ? lo | 0x1000 : lo & ~0x1000;
+            is_blx = !is_thumb_target;
+        }
+        else if ( type == R_ARM_THM_JUMP24 && !is_thumb_target ) {
+            return relocation_status::unsupported;
+        }
+        if ( is_blx ) {
+            // BLX is relative to the word aligned address
+            value = ( value + 3 ) & ~Elf_Sxword( 3 );
+        }
+
+        if ( !fits_signed( value, 25 ) ) {
+            return relocation_status::overflow;
+        }
+        hi = std::uint16_t( 0xf000 | ( ( value >> 14 ) & 0x0400 ) |
+                            ( ( value >> 12 ) & 0x03ff ) );
+        Elf_Sxword j1 = ~( value >> 10 ) ^ ( value >> 11 );
+        Elf_Sxword j2 = ~( value >> 11 ) ^ ( value >> 13 );
+        lo = std::uint16_t( ( lo & 0xd000 ) | ( j1 & 0x2000 ) |
+                            ( j2 & 0x0800 ) | ( ( value >> 1 ) & 0x07ff ) );
+        return place.write_code( hi ) && place.write_code( lo, 2 )
+                   ? relocation_status::applied
+                   : relocation_status::out_of_bounds;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Apply Thumb MOVW and MOVT
+    static relocation_status thumb_movw( unsigned                 type,
+                                         const relocation_values& v,
+                                         relocation_place&        place )
+    {
+        std::uint16_t hi;
+        std::uint16_t lo;
+        if ( !place.read_code( hi ) || !place.read_code( lo, 2 ) ) {
+            return relocation_status::out_of_bounds;
+        }
+
+        Elf_Sxword addend =
+            v.is_rela
+                ? v.A
+                : Elf_Sxword( std::int16_t(
+                      ( ( hi & 0x000f ) << 12 ) | ( ( hi & 0x0400 ) << 1 ) |
+                      ( ( lo & 0x7000 ) >> 4 ) | ( lo & 0x00ff ) ) );
+        std::uint32_t value = std::uint32_t( v.S + addend );
+        if ( type == R_ARM_THM_MOVW_PREL_NC || type == R_ARM_THM_MOVT_PREL ) {
+            value -= std::uint32_t( v.P );
+        }
+        if ( type == R_ARM_THM_MOVT_ABS || type == R_ARM_THM_MOVT_PREL ) {
+            value >>= 16;
+        }
+
+        hi = std::uint16_t( ( hi & 0xfbf0 ) | ( ( value >> 1 ) & 0x0400 ) |
+                            ( ( value >> 12 ) & 0x000f ) );
+        lo = std::uint16_t( ( lo & 0x8f00 ) | ( ( value << 4 ) & 0x7000 ) |
+                            ( value & 0x00ff ) );
+        return place.write_code( hi ) && place.write_code( lo, 2 )
+                   ? relocation_status::applied
+                   : relocation_status::out_of_bounds;
+    }
+};
+
+//------------------------------------------------------------------------------
+//! \class relocator
+//! \brief Applies relocation sections to target buffers.
+//!
+//! Supports EM_386, EM_X86_64, EM_AARCH64, EM_RISCV and EM_ARM. All entries
+//! of a section are applied in one pass by the kernel of the architecture.
+//! Values of the symbols are computed once per symbol and kept until reset()
+//! is called. The symbol tables used so far stay pinned until then, so
+//! a data cache doesn't release them. The relocator is not thread safe
+class relocator
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Function resolving undefined symbols
+    //! \param name Name of the symbol
+    //! \param value Value of the symbol
+    //! \return True if the symbol was resolved, false otherwise
+    using symbol_resolver =
+        std::function<bool( std::string_view name, Elf64_Addr& value )>;
+
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param elf_file Reference to the ELF file. The symbol tables of
+    //!                 the file have to outlive the relocator
+    explicit relocator( const elfio& elf_file )
+        : elf_file( elf_file ), convertor( elf_file.get_convertor() )
+    {
+        // AArch64 and BE8 Arm images keep instructions little-endian
+        bool is_le_code =
+            elf_file.get_machine() == EM_AARCH64 ||
+            ( elf_file.get_machine() == EM_ARM &&
+              ( elf_file.get_flags() & EF_ARM_BE8 ) != 0 );
+        code_convertor.setup( is_le_code ? ELFDATA2LSB
+                                         : elf_file.get_encoding() );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether the relocations of the file's architecture are
+    //!        supported
+    //! \return True if supported, false otherwise
+    bool is_supported() const
+    {
+        switch ( elf_file.get_machine() ) {
+        case EM_386:
+        case EM_X86_64:
+        case EM_AARCH64:
+        case EM_RISCV:
+        case EM_ARM:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the base address the image is loaded at. It is added to
+    //!        the addresses and the values of the defined symbols
+    //! \param value The base address
+    void set_base( Elf64_Addr value )
+    {
+        base = value;
+        reset();
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the base address the image is loaded at
+    //! \return The base address
+    Elf64_Addr get_base() const { return base; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Set the function resolving undefined symbols. Undefined weak
+    //!        symbols it doesn't resolve have the value 0
+    //! \param value The function
+    void set_symbol_resolver( const symbol_resolver& value )
+    {
+        resolver = value;
+        reset();
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Forget the symbol values computed so far. Has to be called
+    //!        after addresses of sections are changed
+    void reset() { symbol_tables.clear(); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Apply all entries of a relocation section to a target buffer
+    //! \param relocations The relocation section
+    //! \param data The target buffer
+    //! \param size Size of the target buffer
+    //! \param address Address of the first byte of the buffer without
+    //!                the base. For ET_REL files the relocation offsets
+    //!                are relative to the buffer, and it is the address
+    //!                assigned to the relocated section
+    //! \param report Optional report of the applied and skipped entries
+    //! \return True if all entries were applied, false otherwise
+    bool apply( const section*     relocations,
+                char*              data,
+                size_t             size,
+                Elf64_Addr         address,
+                relocation_report* report = nullptr )
+    {
+        if ( relocations == nullptr ||
+             ( relocations->get_type() != SHT_REL &&
+               relocations->get_type() != SHT_RELA ) ) {
+            return false;
+        }
+
+        switch ( elf_file.get_machine() ) {
+        case EM_386:
+            return apply<i386_relocation_kernel>( relocations, data, size,
+                                                  address, report );
+        case EM_X86_64:
+            return apply<x86_64_relocation_kernel>( relocations, data, size,
+                                                    address, report );
+        case EM_AARCH64:
+            return apply<aarch64_relocation_kernel>( relocations, data, size,
+                                                     address, report );
+        case EM_RISCV:
+            return apply<riscv_relocation_kernel>( relocations, data, size,
+                                                   address, report );
+        case EM_ARM:
+            return apply<arm_relocation_kernel>( relocations, data, size,
+                                                 address, report );
+        default:
+            return false;
+        }
+    }
+
+  private:
+    //------------------------------------------------------------------------------
+    //! \struct symbol_table
+    //! \brief Symbol table with the values of the symbols used so far
+    struct symbol_table
+    {
+        const char*             data         = nullptr;
+        Elf_Xword               entry_size   = 0;
+        Elf_Xword               symbols_num  = 0;
+        const char*             strings      = nullptr;
+        Elf_Xword               strings_size = 0;
+        data_pin<section>       symbols_pin; //!< Kept until reset()
+        data_pin<section>       strings_pin; //!< Kept until reset()
+        std::vector<Elf64_Addr> values;
+        //! 0 - not computed yet, 1 - resolved, 2 - unresolved
+        std::vector<unsigned char> states;
+    };
+
+    //------------------------------------------------------------------------------
+    template <class Kernel>
+    bool apply( const section*     relocations,
+                char*              data,
+                size_t             size,
+                Elf64_Addr         address,
+                relocation_report* report )
+    {
+        bool is_rela = relocations->get_type() == SHT_RELA;
+        if ( elf_file.get_class() == ELFCLASS64 ) {
+            return is_rela ? apply<Kernel, Elf64_Rela, Elf64_Sym>(
+                                 relocations, data, size, address, report )
+                           : apply<Kernel, Elf64_Rel, Elf64_Sym>(
+                                 relocations, data, size, address, report );
+        }
+        return is_rela ? apply<Kernel, Elf32_Rela, Elf32_Sym>(
+                             relocations, data, size, address, report )
+                       : apply<Kernel, Elf32_Rel, Elf32_Sym>(
+                             relocations, data, size, address, report );
+    }
+
+    //------------------------------------------------------------------------------
+    template <class Kernel, class T, class Sym>
+    bool apply( const section*     relocations,
+                char*              data,
+                size_t             size,
+                Elf64_Addr         address,
+                relocation_report* report )
+    {
+        data_pin<section> entries_pin( relocations );
+        const char*       entries    = entries_pin.get();
+        Elf_Xword         entry_size = relocations->get_entry_size();
+        if ( entries == nullptr || entry_size < sizeof( T ) ) {
+            return relocations->get_size() == 0;
+        }
+        Elf_Xword        entries_num = relocations->get_size() / entry_size;
+        symbol_table*    symbols =
+            get_symbol_table<Sym>( relocations->get_link() );
+        bool             is_rel_file = elf_file.get_type() == ET_REL;
+        Kernel           kernel;
+        relocation_place place( data, size, *convertor, code_convertor );
+
+        relocation_values v;
+        v.B       = base;
+        v.is_rela = std::is_same_v<T, Elf32_Rela> ||
+                    std::is_same_v<T, Elf64_Rela>;
+        v.is_64   = std::is_same_v<Sym, Elf64_Sym>;
+
+        Elf_Xword applied = 0;
+        bool      is_ok   = true;
+        for ( Elf_Xword i = 0; i < entries_num; ++i ) {
+            const T*   rel    = reinterpret_cast<const T*>( entries +
+                                                         i * entry_size );
+            Elf64_Addr offset = ( *convertor )( rel->r_offset );
+            Elf_Xword  info   = ( *convertor )( rel->r_info );
+            Elf_Word   symbol = get_sym_and_type<T>::get_r_sym( info );
+            unsigned   type   = get_sym_and_type<T>::get_r_type( info );
+            if constexpr ( std::is_same_v<T, Elf32_Rela> ||
+                           std::is_same_v<T, Elf64_Rela> ) {
+                v.A = ( *convertor )( rel->r_addend );
+            }
+
+            // Positions before the buffer wrap around and are out of bounds
+            Elf64_Addr position = is_rel_file ? offset : offset - address;
+            place.set_position( position );
+            v.P = base + address + position;
+
+            relocation_status status = relocation_status::unresolved;
+            if ( get_symbol_value<Sym>( symbols, symbol, v.S ) ) {
+                status = kernel.apply( type, v, place );
+            }
+
+            if ( status == relocation_status::applied ) {
+                ++applied;
+                continue;
+            }
+            is_ok = false;
+            if ( report != nullptr ) {
+                report->issues.push_back( { i, type, status } );
+            }
+        }
+
+        if ( report != nullptr ) {
+            report->applied += applied;
+        }
+        return is_ok;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the symbol table of a relocation section
+    template <class Sym> symbol_table* get_symbol_table( Elf_Word index )
+    {
+        auto it = symbol_tables.find( index );
+        if ( it != symbol_tables.end() ) {
+            return &it->second;
+        }
+
+        symbol_table&  table   = symbol_tables[index];
+        const section* symbols = elf_file.sections[(Elf_Half)index];
+        table.symbols_pin      = data_pin<section>( symbols );
+        if ( symbols == nullptr || table.symbols_pin.get() == nullptr ||
+             symbols->get_entry_size() < sizeof( Sym ) ) {
+            return &table;
+        }
+
+        table.data        = table.symbols_pin.get();
+        table.entry_size  = symbols->get_entry_size();
+        table.symbols_num = symbols->get_size() / table.entry_size;
+        table.values.resize( table.symbols_num );
+        table.states.resize( table.symbols_num );
+
+        const section* strings =
+            elf_file.sections[(Elf_Half)symbols->get_link()];
+        table.strings_pin = data_pin<section>( strings );
+        if ( table.strings_pin.get() != nullptr ) {
+            table.strings      = table.strings_pin.get();
+            table.strings_size = strings->get_size();
+        }
+
+        return &table;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the value of a symbol, computing it on first use
+    //! \return True if the symbol has a value, false otherwise
+    template <class Sym>
+    bool
+    get_symbol_value( symbol_table* table, Elf_Word index, Elf64_Addr& value )
+    {
+        if ( index == STN_UNDEF ) {
+            value = 0;
+            return true;
+        }
+        if ( index >= table->symbols_num ) {
+            return false;
+        }
+
+        if ( table->states[index] == 0 ) {
+            table->states[index] =
+                compute_symbol_value<Sym>( *table, index, table->values[index] )
+                    ? 1
+                    : 2;
+        }
+        value = table->values[index];
+        return table->states[index] == 1;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Compute the value of a symbol
+    //! \return True if the symbol has a value, false otherwise
+    template <class Sym>
+    bool compute_symbol_value( const symbol_table& table,
+                               Elf_Word            index,
+                               Elf64_Addr&         value ) const
+    {
+        const Sym* sym = reinterpret_cast<const Sym*>(
+            table.data + index * table.entry_size );
+        Elf64_Addr sym_value = ( *convertor )( sym->st_value );
+        Elf_Half   shndx     = ( *convertor )( sym->st_shndx );
+
+        if ( shndx == SHN_ABS ) {
+            value = sym_value;
+            return true;
+        }
+        if ( shndx == SHN_UNDEF ) {
+            if ( resolver && resolver( get_name( table, sym ), value ) ) {
+                return true;
+            }
+            value = 0;
+            return ELF_ST_BIND( sym->st_info ) == STB_WEAK;
+        }
+        if ( shndx >= SHN_LORESERVE ) {
+            return false;
+        }
+
+        value = base + sym_value;
+        if ( elf_file.get_type() == ET_REL ) {
+            // Symbol values of relocatable files are section offsets
+            const section* sec = elf_file.sections[shndx];
+            if ( sec == nullptr ) {
+                return false;
+            }
+            value += sec->get_address();
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the name of a symbol
+    template <class Sym>
+    std::string_view get_name( const symbol_table& table, const Sym* sym ) const
+    {
+        Elf_Word name = ( *convertor )( sym->st_name );
+        if ( name >= table.strings_size ) {
+            return {};
+        }
+
+        const char* str = table.strings + name;
+        const void* end = std::memchr( str, '\0', table.strings_size - name );
+        if ( end == nullptr ) {
+            return {};
+        }
+        return { str, size_t( static_cast<const char*>( end ) - str ) };
+    }
+
+    const elfio&                          elf_file;  //!< The ELF file
+    std::shared_ptr<endianness_convertor> convertor; //!< Endianness of data
+    endianness_convertor code_convertor;  //!< Endianness of instructions
+    Elf64_Addr           base = 0;        //!< Base address of the image
+    symbol_resolver      resolver;        //!< Resolver of undefined symbols
+    //! Symbol tables used so far, by their section index
+    std::unordered_map<Elf_Word, symbol_table> symbol_tables;
+};
+
+} // namespace ELFIO
+
+#endif // ELFIO_RELOCATOR_HPP
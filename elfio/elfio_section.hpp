@@ -27,6 +27,12 @@ THE SOFTWARE.
 #include <iostream>
 #include <new>
 #include <limits>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace ELFIO {
 
@@ -42,7 +48,13 @@ class section
     virtual ~section() = default;
 
     ELFIO_GET_ACCESS_DECL( Elf_Half, index );
-    ELFIO_GET_SET_ACCESS_DECL( std::string, name );
+    /**
+     * @brief Get the name of the section.
+     * The reference stays valid until the section is renamed.
+     * @return Name of the section.
+     */
+    virtual const std::string& get_name() const = 0;
+    virtual void set_name( const std::string& value ) = 0;
     ELFIO_GET_SET_ACCESS_DECL( Elf_Word, type );
     ELFIO_GET_SET_ACCESS_DECL( Elf_Xword, flags );
     ELFIO_GET_SET_ACCESS_DECL( Elf_Word, info );
@@ -65,6 +77,18 @@ class section
      */
     virtual void free_data() const = 0;
 
+    /**
+     * @brief Keep the data loaded until unpin_data() is called, even when
+     *        a data cache releases data to load data of other objects.
+     *        Pins are counted. Pin the section before calling get_data().
+     */
+    virtual void pin_data() const = 0;
+
+    /**
+     * @brief Remove a pin added by pin_data().
+     */
+    virtual void unpin_data() const = 0;
+
     /**
      * @brief Set the data of the section.
      * @param raw_data Pointer to the raw data.
@@ -107,6 +131,21 @@ class section
      */
     virtual void insert_data( Elf_Xword pos, const std::string& data ) = 0;
 
+    /**
+     * @brief Mark the data of the section as modified.
+     * Call it after changing the buffer returned by get_data() in place.
+     */
+    virtual void mark_data_modified() = 0;
+
+    /**
+     * @brief Mark a part of the data of the section as modified.
+     * Call it after changing the buffer returned by get_data() in place.
+     * Only the marked parts are written by elfio::save_in_place().
+     * @param offset Offset of the modified bytes in the section data.
+     * @param size Number of the modified bytes.
+     */
+    virtual void mark_data_modified( Elf_Xword offset, Elf_Xword size ) = 0;
+
     /**
      * @brief Get the size of the stream.
      * @return Size of the stream.
@@ -123,8 +162,19 @@ class section
     ELFIO_SET_ACCESS_DECL( Elf64_Off, offset );
     ELFIO_SET_ACCESS_DECL( Elf_Half, index );
 
+    /**
+     * @brief Load the section.
+     * @param context Load parameters shared by all sections of the file.
+     * @param header_data Raw section header as read from the stream.
+     * @return True if successful, false otherwise.
+     */
+    virtual bool load( const load_context& context,
+                       const char*         header_data ) = 0;
+
     /**
      * @brief Load the section from a stream.
+     * Kept for compatibility: reads the header and calls the load()
+     * taking a load_context.
      * @param stream Input stream.
      * @param header_offset Offset of the header.
      * @param is_lazy Whether to load lazily.
@@ -144,6 +194,67 @@ class section
                        std::streampos header_offset,
                        std::streampos data_offset ) = 0;
 
+    /**
+     * @brief Add the section header and data to an ordered output list.
+     * @param chunks Output list.
+     * @param header_offset Offset of the header.
+     * @param data_offset Offset of the data.
+     */
+    virtual void gather( output_chunks& chunks,
+                         Elf64_Off      header_offset,
+                         Elf64_Off      data_offset ) = 0;
+
+    /**
+     * @brief Add the section parts changed since the last load or save
+     *        to an output list.
+     * @param chunks Output list.
+     * @param header_offset Offset of the header.
+     * @return False if the section does not fit its place in the file.
+     */
+    virtual bool gather_changes( output_chunks& chunks,
+                                 Elf64_Off      header_offset ) const = 0;
+
+    /**
+     * @brief Record the current state as the one stored in the file.
+     */
+    virtual void set_saved() = 0;
+
+    /**
+     * @brief Compress the data of a compressed section before the layout
+     *        of the saved file is computed. The section size is the
+     *        compressed size until release_compressed_data() is called.
+     *        Different sections may be compressed concurrently.
+     * @return True if successful or nothing is to be compressed,
+     *         false otherwise.
+     */
+    virtual bool compress_data() = 0;
+
+    /**
+     * @brief Release the compressed data and restore the section size.
+     */
+    virtual void release_compressed_data() = 0;
+
+    /**
+     * @brief Read the section data deferred by load().
+     *        Different sections may be read concurrently when a file is given.
+     * @param file File to read from, or nullptr to read from the stream
+     *        given on load().
+     * @return True if successful, false otherwise.
+     */
+    virtual bool load_deferred_data( const positional_file* file ) = 0;
+
+    /**
+     * @brief Decompress the data of a compressed section after it was read.
+     *        Different sections may be decompressed concurrently.
+     */
+    virtual void inflate_data() = 0;
+
+    /**
+     * @brief Defer the name resolution until the name is used.
+     * @param name_table Section name string table, or nullptr.
+     */
+    virtual void defer_name( const section* name_table ) = 0;
+
     /**
      * @brief Check if the address is initialized.
      * @return True if initialized, false otherwise.
@@ -156,7 +267,8 @@ class section
  * @brief Implementation of the section class.
  * @tparam T Type of the section header.
  */
-template <class T> class section_impl : public section
+template <class T>
+class section_impl : public section, public cached_object
 {
   public:
     /**
@@ -164,13 +276,25 @@ template <class T> class section_impl : public section
      * @param convertor Pointer to the endianness convertor.
      * @param translator Pointer to the address translator.
      * @param compression Shared pointer to the compression interface.
+     * @param names_version Counter incremented on every name change.
      */
     section_impl( std::shared_ptr<endianness_convertor>  convertor,
                   std::shared_ptr<address_translator>    translator,
-                  std::shared_ptr<compression_interface> compression )
+                  std::shared_ptr<compression_interface> compression,
+                  std::shared_ptr<size_t> names_version = nullptr )
         : convertor( convertor ), translator( translator ),
-          compression( compression )
+          compression( compression ), names_version( names_version )
+    {
+    }
+
+    /**
+     * @brief Destructor. Stops tracking of the data by the data cache.
+     */
+    ~section_impl() override
     {
+        if ( cache ) {
+            cache->remove( this );
+        }
     }
 
     // Section info functions
@@ -194,7 +318,13 @@ template <class T> class section_impl : public section
      * @brief Get the name of the section.
      * @return Name of the section.
      */
-    std::string get_name() const override { return name; }
+    const std::string& get_name() const override
+    {
+        if ( is_name_deferred ) {
+            resolve_name();
+        }
+        return name;
+    }
 
     /**
      * @brief Set the name of the section.
@@ -202,7 +332,11 @@ template <class T> class section_impl : public section
      */
     void set_name( const std::string& name_prm ) override
     {
-        this->name = name_prm;
+        this->name       = name_prm;
+        is_name_deferred = false;
+        if ( names_version ) {
+            ++*names_version;
+        }
     }
 
     /**
@@ -232,14 +366,23 @@ template <class T> class section_impl : public section
         // When lazy loading, attempts to call get_data() on it after initial load are useless
         // When loading non-lazily, that load_data() will attempt to read data from
         // the stream specified on load() call, which might be freed by this point
-        if ( !is_loaded && can_be_loaded ) {
-            bool res = load_data();
+        if ( cache ) {
+            return get_cached_data();
+        }
 
-            if ( !res ) {
-                can_be_loaded = false;
+        if ( !is_loaded && can_be_loaded ) {
+            // Concurrent readers of the section wait for a single load.
+            // Readers of other sections are not blocked
+            std::lock_guard<std::mutex> lock( load_mutex );
+            if ( !is_loaded && can_be_loaded ) {
+                bool res = load_data( reader.get() );
+
+                if ( !res ) {
+                    can_be_loaded = false;
+                }
             }
         }
-        return data.get();
+        return get_data_ptr();
     }
 
     /**
@@ -248,11 +391,55 @@ template <class T> class section_impl : public section
     void free_data() const override
     {
         if ( is_lazy ) {
-            data.reset( nullptr );
-            is_loaded = false;
+            {
+                std::lock_guard<std::mutex> lock( load_mutex );
+                data.reset( nullptr );
+                mapped_data = nullptr;
+                is_loaded   = false;
+            }
+            if ( cache ) {
+                cache->remove( this );
+            }
+        }
+    }
+
+    /**
+     * @brief Keep the data loaded until unpin_data() is called.
+     */
+    void pin_data() const override
+    {
+        if ( cache ) {
+            cache->pin( this );
         }
     }
 
+    /**
+     * @brief Remove a pin added by pin_data().
+     */
+    void unpin_data() const override
+    {
+        if ( cache ) {
+            cache->unpin( this );
+        }
+    }
+
+    /**
+     * @brief Release the data loaded on demand for the data cache.
+     * @return True if the data was released, false if it has to be kept.
+     */
+    bool release_cached_data() const override
+    {
+        std::lock_guard<std::mutex> lock( load_mutex );
+        // Modified data can't be loaded again from the file
+        if ( !is_lazy || is_data_modified || !is_loaded || !data ) {
+            return false;
+        }
+
+        data.reset( nullptr );
+        is_loaded = false;
+        return true;
+    }
+
     /**
      * @brief Set the data of the section.
      * @param raw_data Pointer to the raw data.
@@ -261,7 +448,8 @@ template <class T> class section_impl : public section
     void set_data( const char* raw_data, Elf_Xword size ) override
     {
         if ( get_type() != SHT_NOBITS ) {
-            data = std::unique_ptr<char[]>(
+            mapped_data = nullptr;
+            data        = std::unique_ptr<char[]>(
                 new ( std::nothrow ) char[(size_t)size] );
             if ( nullptr != data.get() && nullptr != raw_data ) {
                 data_size = size;
@@ -270,6 +458,7 @@ template <class T> class section_impl : public section
             else {
                 data_size = 0;
             }
+            set_data_modified();
         }
 
         set_size( data_size );
@@ -321,6 +510,12 @@ template <class T> class section_impl : public section
                 return; // Invalid position
             }
 
+            // The data referenced in the file mapping is read-only from
+            // the section's point of view. Make a private copy first
+            if ( nullptr != mapped_data && !detach_mapped_data() ) {
+                return; // Allocation failed
+            }
+
             // Check for integer overflow in size calculation
             Elf_Xword new_size = get_size();
             if ( size > std::numeric_limits<Elf_Xword>::max() - new_size ) {
@@ -371,6 +566,8 @@ template <class T> class section_impl : public section
                 }
             }
             set_size( new_size );
+            // The data before the insertion point is unchanged
+            set_data_modified( pos );
             if ( translator->empty() ) {
                 set_stream_size( get_stream_size() + (size_t)size );
             }
@@ -387,6 +584,23 @@ template <class T> class section_impl : public section
         return insert_data( pos, str_data.c_str(), (Elf_Word)str_data.size() );
     }
 
+    /**
+     * @brief Mark the data of the section as modified.
+     */
+    void mark_data_modified() override { set_data_modified(); }
+
+    /**
+     * @brief Mark a part of the data of the section as modified.
+     * @param offset Offset of the modified bytes in the section data.
+     * @param size Number of the modified bytes.
+     */
+    void mark_data_modified( Elf_Xword offset, Elf_Xword size ) override
+    {
+        if ( size != 0 ) {
+            set_data_modified( offset, size );
+        }
+    }
+
     /**
      * @brief Get the size of the stream.
      * @return Size of the stream.
@@ -419,6 +633,40 @@ template <class T> class section_impl : public section
                compression != nullptr;
     }
 
+    /**
+     * @brief Load the section.
+     * @param context Load parameters shared by all sections of the file.
+     * @param header_data Raw section header as read from the stream.
+     * @return True if successful, false otherwise.
+     */
+    bool load( const load_context& context,
+               const char*         header_data ) override
+    {
+        pstream      = context.stream;
+        is_lazy      = context.is_lazy;
+        mapping      = context.mapping;
+        stream_mutex = context.stream_mutex;
+        cache        = is_lazy ? context.cache : nullptr;
+        // The file is kept open only for reading the data on demand
+        reader = is_lazy ? context.file : nullptr;
+        set_stream_size( context.stream_size );
+
+        std::copy( header_data, header_data + sizeof( header ),
+                   reinterpret_cast<char*>( &header ) );
+        file_header   = header;
+        is_in_file    = true;
+        stream_offset = ( *convertor )( header.sh_offset );
+
+        // The data of deferred loads is read later by load_deferred_data()
+        if ( !( is_lazy || is_loaded || context.is_deferred ) ) {
+            bool ret = get_data();
+            inflate_data();
+            return ret;
+        }
+
+        return true;
+    }
+
     /**
      * @brief Load the section from a stream.
      * @param stream Input stream.
@@ -430,48 +678,87 @@ template <class T> class section_impl : public section
                std::streampos header_offset,
                bool           is_lazy_ ) override
     {
-        pstream = &stream;
-        is_lazy = is_lazy_;
-
+        load_context context;
+        context.stream  = &stream;
+        context.is_lazy = is_lazy_;
         if ( translator->empty() ) {
             stream.seekg( 0, std::istream::end );
-            set_stream_size( size_t( stream.tellg() ) );
+            context.stream_size = size_t( stream.tellg() );
         }
         else {
-            set_stream_size( std::numeric_limits<size_t>::max() );
+            context.stream_size = std::numeric_limits<size_t>::max();
         }
 
+        T raw_header = {};
         stream.seekg( ( *translator )[header_offset] );
-        stream.read( reinterpret_cast<char*>( &header ), sizeof( header ) );
+        if ( !stream.read( reinterpret_cast<char*>( &raw_header ),
+                           sizeof( raw_header ) ) ) {
+            return false;
+        }
 
-        if ( !( is_lazy || is_loaded ) ) {
-            bool ret = get_data();
+        return load( context, reinterpret_cast<const char*>( &raw_header ) );
+    }
 
-            if ( is_compressed() ) {
-                Elf_Xword size              = get_size();
-                Elf_Xword uncompressed_size = 0;
-                auto      decompressed_data = compression->inflate(
-                    data.get(), convertor, size, uncompressed_size );
-                if ( decompressed_data != nullptr ) {
-                    set_size( uncompressed_size );
-                    data = std::move( decompressed_data );
-                }
-            }
+    /**
+     * @brief Read the section data deferred by load().
+     * @param file File to read from, or nullptr to read from the stream
+     *        given on load().
+     * @return True if successful, false otherwise.
+     */
+    bool load_deferred_data( const positional_file* file ) override
+    {
+        if ( is_loaded || !can_be_loaded ) {
+            return is_loaded;
+        }
 
-            return ret;
+        if ( !load_data( file ) ) {
+            can_be_loaded = false;
+            return false;
         }
 
         return true;
     }
 
+    /**
+     * @brief Decompress the data of a compressed section after it was read.
+     */
+    void inflate_data() override
+    {
+        if ( !is_compressed() || nullptr == get_data_ptr() ) {
+            return;
+        }
+
+        Elf_Xword size              = get_size();
+        Elf_Xword uncompressed_size = 0;
+        auto      decompressed_data = compression->inflate(
+            get_data_ptr(), convertor, size, uncompressed_size );
+        if ( decompressed_data != nullptr ) {
+            set_size( uncompressed_size );
+            data        = std::move( decompressed_data );
+            mapped_data = nullptr;
+        }
+    }
+
+    /**
+     * @brief Defer the name resolution until the name is used.
+     * @param name_table_prm Section name string table, or nullptr.
+     */
+    void defer_name( const section* name_table_prm ) override
+    {
+        name_table       = name_table_prm;
+        is_name_deferred = ( name_table != nullptr );
+    }
+
     /**
      * @brief Load the data of the section.
+     * @param file File to read from, or nullptr to read from the stream
+     *        given on load().
      * @return True if successful, false otherwise.
      */
-    bool load_data() const
+    bool load_data( const positional_file* file = nullptr ) const
     {
-        Elf_Xword sh_offset =
-            ( *translator )[( *convertor )( header.sh_offset )];
+        // The header offset changes when the file is saved
+        Elf_Xword sh_offset = ( *translator )[stream_offset];
         Elf_Xword size = get_size();
 
         // Check for integer overflow in offset calculation
@@ -486,8 +773,16 @@ template <class T> class section_impl : public section
         }
 
         // Check if we need to load data
-        if ( nullptr == data && SHT_NULL != get_type() &&
+        if ( nullptr == get_data_ptr() && SHT_NULL != get_type() &&
              SHT_NOBITS != get_type() ) {
+            // No copy is needed when the file is memory mapped
+            if ( mapping ) {
+                mapped_data = mapping->get_data() + sh_offset;
+                data_size   = size;
+                is_loaded   = true;
+                return true;
+            }
+
             // Check if size can be safely converted to size_t
             if ( size > std::numeric_limits<size_t>::max() - 1 ) {
                 return false;
@@ -496,9 +791,22 @@ template <class T> class section_impl : public section
             data.reset( new ( std::nothrow ) char[size_t( size ) + 1] );
 
             if ( ( 0 != size ) && ( nullptr != data ) ) {
-                pstream->seekg( sh_offset );
-                pstream->read( data.get(), size );
-                if ( static_cast<Elf_Xword>( pstream->gcount() ) != size ) {
+                bool is_read = false;
+                if ( nullptr != file ) {
+                    is_read = file->read( sh_offset, data.get(), size );
+                }
+                else {
+                    // The stream position is shared by all sections
+                    std::unique_lock<std::mutex> lock;
+                    if ( stream_mutex ) {
+                        lock = std::unique_lock<std::mutex>( *stream_mutex );
+                    }
+                    pstream->seekg( sh_offset );
+                    pstream->read( data.get(), size );
+                    is_read =
+                        static_cast<Elf_Xword>( pstream->gcount() ) == size;
+                }
+                if ( !is_read ) {
                     data.reset( nullptr );
                     data_size = 0;
                     return false;
@@ -519,8 +827,8 @@ template <class T> class section_impl : public section
         }
 
         // Data already loaded or doesn't need loading
-        is_loaded = ( nullptr != data ) || ( SHT_NULL == get_type() ) ||
-                    ( SHT_NOBITS == get_type() );
+        is_loaded = ( nullptr != get_data_ptr() ) ||
+                    ( SHT_NULL == get_type() ) || ( SHT_NOBITS == get_type() );
         return is_loaded;
     }
 
@@ -541,12 +849,298 @@ template <class T> class section_impl : public section
 
         save_header( stream, header_offset );
         if ( get_type() != SHT_NOBITS && get_type() != SHT_NULL &&
-             get_size() != 0 && data != nullptr ) {
+             get_size() != 0 && get_saved_data() != nullptr ) {
             save_data( stream, data_offset );
         }
     }
 
+    /**
+     * @brief Add the section header and data to an ordered output list.
+     * @param chunks Output list.
+     * @param header_offset Offset of the header.
+     * @param data_offset Offset of the data.
+     */
+    void gather( output_chunks& chunks,
+                 Elf64_Off      header_offset,
+                 Elf64_Off      data_offset ) override
+    {
+        if ( 0 != get_index() ) {
+            header.sh_offset = decltype( header.sh_offset )( data_offset );
+            header.sh_offset = ( *convertor )( header.sh_offset );
+        }
+
+        chunks.add( header_offset, reinterpret_cast<const char*>( &header ),
+                    sizeof( header ) );
+        if ( get_type() == SHT_NOBITS || get_type() == SHT_NULL ||
+             get_size() == 0 ) {
+            return;
+        }
+
+        if ( compressed_data != nullptr ) {
+            chunks.add( data_offset, compressed_data.get(), get_size() );
+        }
+        else if ( get_saved_data() != nullptr ) {
+            chunks.add( data_offset, get_saved_data(), get_size() );
+        }
+    }
+
+    /**
+     * @brief Add the section parts changed since the last load or save
+     *        to an output list.
+     * @param chunks Output list.
+     * @param header_offset Offset of the header.
+     * @return False if the section does not fit its place in the file.
+     */
+    bool gather_changes( output_chunks& chunks,
+                         Elf64_Off      header_offset ) const override
+    {
+        bool is_header_modified =
+            !std::equal( reinterpret_cast<const char*>( &header ),
+                         reinterpret_cast<const char*>( &header + 1 ),
+                         reinterpret_cast<const char*>( &file_header ) );
+        if ( !is_header_modified && !is_data_modified ) {
+            return true;
+        }
+
+        // The stored header of a compressed section differs from
+        // the one in memory. The data would need to be compressed again
+        if ( !is_in_file || is_compressed() ||
+             header.sh_offset != file_header.sh_offset ||
+             ( get_type() != SHT_NOBITS &&
+               header.sh_size != file_header.sh_size ) ) {
+            return false;
+        }
+
+        if ( is_header_modified ) {
+            chunks.add( header_offset,
+                        reinterpret_cast<const char*>( &header ),
+                        sizeof( header ) );
+        }
+        if ( is_data_modified && get_type() != SHT_NOBITS &&
+             get_type() != SHT_NULL && get_data_ptr() != nullptr ) {
+            for ( const auto& range : modified_ranges ) {
+                if ( range.first < get_size() ) {
+                    Elf_Xword end = std::min( range.second, get_size() );
+                    chunks.add( get_offset() + range.first,
+                                get_data_ptr() + range.first,
+                                end - range.first );
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Record the current state as the one stored in the file.
+     */
+    void set_saved() override
+    {
+        file_header      = header;
+        is_in_file       = true;
+        is_data_modified = false;
+        modified_ranges.clear();
+    }
+
+    /**
+     * @brief Compress the data of a compressed section before the layout
+     *        of the saved file is computed.
+     * @return True if successful or nothing is to be compressed,
+     *         false otherwise.
+     */
+    bool compress_data() override
+    {
+        if ( !is_compressed() || compressed_data != nullptr ||
+             get_type() == SHT_NOBITS || get_type() == SHT_NULL ||
+             get_size() == 0 || get_saved_data() == nullptr ) {
+            return true;
+        }
+
+        Elf_Xword compressed_size = 0;
+        compressed_data = compression->deflate( get_saved_data(), convertor,
+                                                get_size(), compressed_size );
+        if ( compressed_data == nullptr ) {
+            return false;
+        }
+
+        uncompressed_size = get_size();
+        set_size( compressed_size );
+        return true;
+    }
+
+    /**
+     * @brief Release the compressed data and restore the section size.
+     */
+    void release_compressed_data() override
+    {
+        if ( compressed_data != nullptr ) {
+            compressed_data.reset();
+            set_size( uncompressed_size );
+        }
+    }
+
   private:
+    /**
+     * @brief Read the deferred name from the section name string table.
+     *        Concurrent readers of the name wait for a single resolution.
+     */
+    void resolve_name() const
+    {
+        std::lock_guard<std::mutex> lock( name_mutex );
+        if ( !is_name_deferred ) {
+            return;
+        }
+
+        const char* table  = name_table->get_data();
+        size_t      size   = static_cast<size_t>( name_table->get_size() );
+        Elf_Word    offset = get_name_string_offset();
+        if ( table != nullptr && offset < size ) {
+            const char* end = static_cast<const char*>(
+                std::memchr( table + offset, '\0', size - offset ) );
+            if ( end != nullptr ) {
+                name.assign( table + offset, end );
+            }
+        }
+        is_name_deferred = false;
+    }
+
+    /**
+     * @brief Get the data of a section tracked by the data cache.
+     *        The data may be released by the cache at any time, so
+     *        the pointer is taken under the lock of the section.
+     * @return Pointer to the data.
+     */
+    const char* get_cached_data() const
+    {
+        const char* result      = nullptr;
+        Elf_Xword   loaded_size = 0;
+        {
+            std::lock_guard<std::mutex> lock( load_mutex );
+            if ( !is_loaded && can_be_loaded ) {
+                if ( !load_data( reader.get() ) ) {
+                    can_be_loaded = false;
+                }
+                else if ( data ) {
+                    loaded_size = data_size;
+                }
+            }
+            result = get_data_ptr();
+        }
+
+        // The cache may release data of other sections. It is called
+        // without holding the lock to avoid lock order inversion
+        if ( loaded_size != 0 ) {
+            cache->add( this, (size_t)loaded_size );
+        }
+        else if ( result != nullptr ) {
+            cache->touch( this );
+        }
+        return result;
+    }
+
+    /**
+     * @brief Mark the data as modified. It is not released by the data cache
+     *        anymore, as it can't be loaded again from the file.
+     * @param offset Offset of the modified bytes in the section data.
+     * @param size Number of the modified bytes. All bytes up to the end of
+     *        the data by default.
+     */
+    void
+    set_data_modified( Elf_Xword offset = 0,
+                       Elf_Xword size = std::numeric_limits<Elf_Xword>::max() )
+    {
+        Elf_Xword end = size > std::numeric_limits<Elf_Xword>::max() - offset
+                            ? std::numeric_limits<Elf_Xword>::max()
+                            : offset + size;
+        add_modified_range( offset, end );
+
+        is_data_modified = true;
+        if ( cache ) {
+            cache->remove( this );
+        }
+    }
+
+    /**
+     * @brief Add a range to the sorted list of the disjoint modified ranges.
+     *        Overlapping and adjacent ranges are merged. When the list grows
+     *        too long, the two ranges with the smallest gap are merged.
+     * @param begin Offset of the first modified byte.
+     * @param end Offset past the last modified byte.
+     */
+    void add_modified_range( Elf_Xword begin, Elf_Xword end )
+    {
+        // The first range ending at or after the new one begins
+        auto first = std::lower_bound(
+            modified_ranges.begin(), modified_ranges.end(), begin,
+            []( const std::pair<Elf_Xword, Elf_Xword>& range,
+                Elf_Xword value ) { return range.second < value; } );
+        auto last = first;
+        while ( last != modified_ranges.end() && last->first <= end ) {
+            begin = std::min( begin, last->first );
+            end   = std::max( end, last->second );
+            ++last;
+        }
+        first = modified_ranges.erase( first, last );
+        modified_ranges.insert( first, { begin, end } );
+
+        if ( modified_ranges.size() > max_modified_ranges ) {
+            size_t closest = 0;
+            for ( size_t i = 1; i + 1 < modified_ranges.size(); ++i ) {
+                if ( modified_ranges[i + 1].first - modified_ranges[i].second <
+                     modified_ranges[closest + 1].first -
+                         modified_ranges[closest].second ) {
+                    closest = i;
+                }
+            }
+            modified_ranges[closest].second =
+                modified_ranges[closest + 1].second;
+            modified_ranges.erase( modified_ranges.begin() + closest + 1 );
+        }
+    }
+
+    /**
+     * @brief Get the data to be saved. Data released by the data cache is
+     *        loaded again, so the saved file does not depend on the cache.
+     *        The caller keeps the section pinned until the data is written.
+     * @return Pointer to the data.
+     */
+    const char* get_saved_data() const
+    {
+        return cache ? get_data() : get_data_ptr();
+    }
+
+    /**
+     * @brief Get the current data without triggering a load.
+     * @return Pointer to the owned data or to the file mapping.
+     */
+    const char* get_data_ptr() const
+    {
+        return data ? data.get() : mapped_data;
+    }
+
+    /**
+     * @brief Replace the reference to the file mapping by an owned copy.
+     * @return True if successful, false otherwise.
+     */
+    bool detach_mapped_data()
+    {
+        Elf_Xword size = get_size();
+        if ( size > std::numeric_limits<size_t>::max() - 1 ) {
+            return false;
+        }
+
+        data.reset( new ( std::nothrow ) char[size_t( size ) + 1] );
+        if ( nullptr == data ) {
+            return false;
+        }
+
+        std::copy( mapped_data, mapped_data + size, data.get() );
+        data.get()[size] = 0;
+        data_size        = size;
+        mapped_data      = nullptr;
+        return true;
+    }
+
     /**
      * @brief Save the header of the section to a stream.
      * @param stream Output stream.
@@ -568,17 +1162,11 @@ template <class T> class section_impl : public section
     {
         adjust_stream_size( stream, data_offset );
 
-        if ( ( ( get_flags() & SHF_COMPRESSED ) ||
-               ( get_flags() & SHF_RPX_DEFLATE ) ) &&
-             compression != nullptr ) {
-            Elf_Xword decompressed_size = get_size();
-            Elf_Xword compressed_size   = 0;
-            auto      compressed_ptr    = compression->deflate(
-                data.get(), convertor, decompressed_size, compressed_size );
-            stream.write( compressed_ptr.get(), compressed_size );
+        if ( compressed_data != nullptr ) {
+            stream.write( compressed_data.get(), get_size() );
         }
         else {
-            stream.write( get_data(), get_size() );
+            stream.write( get_saved_data(), get_size() );
         }
     }
 
@@ -586,24 +1174,57 @@ template <class T> class section_impl : public section
     mutable std::istream* pstream =
         nullptr; /**< Pointer to the input stream. */
     T                               header = {};   /**< Section header. */
+    T file_header = {}; /**< Section header as stored in the file. */
     Elf_Half                        index  = 0;    /**< Index of the section. */
-    std::string                     name;          /**< Name of the section. */
+    mutable std::string             name;          /**< Name of the section. */
     mutable std::unique_ptr<char[]> data;          /**< Pointer to the data. */
     mutable Elf_Xword               data_size = 0; /**< Size of the data. */
+    std::unique_ptr<char[]>
+        compressed_data; /**< Data compressed for the file being saved. */
+    Elf_Xword uncompressed_size =
+        0; /**< Section size while compressed_data is set. */
+    mutable const char*             mapped_data =
+        nullptr; /**< Pointer to the data inside the file mapping. */
+    std::shared_ptr<const mapped_file> mapping =
+        nullptr; /**< File mapping, if the file is memory mapped. */
+    std::shared_ptr<const positional_file> reader =
+        nullptr; /**< File for reading the data on demand, if any. */
+    std::shared_ptr<std::mutex> stream_mutex =
+        nullptr; /**< Lock of the stream position shared by all sections. */
+    mutable std::mutex load_mutex; /**< Lock of the data load. */
+    const section*     name_table =
+        nullptr; /**< Section name string table of a deferred name. */
+    mutable std::mutex name_mutex; /**< Lock of the name resolution. */
+    mutable std::atomic<bool> is_name_deferred{
+        false }; /**< Flag indicating if the name is not read yet. */
+    std::shared_ptr<data_cache> cache =
+        nullptr; /**< Cache of the data loaded on demand, if any. */
     std::shared_ptr<endianness_convertor> convertor =
         nullptr; /**< Pointer to the endianness convertor. */
     std::shared_ptr<address_translator> translator =
         nullptr; /**< Pointer to the address translator. */
     std::shared_ptr<compression_interface> compression =
         nullptr; /**< Shared pointer to the compression interface. */
+    std::shared_ptr<size_t> names_version =
+        nullptr; /**< Counter of section name changes. */
     bool is_address_set = false;  /**< Flag indicating if the address is set. */
+    bool is_in_file =
+        false; /**< Flag indicating if the section is stored in the file. */
+    bool is_data_modified =
+        false; /**< Flag indicating if the data differs from the file. */
+    std::vector<std::pair<Elf_Xword, Elf_Xword>>
+        modified_ranges; /**< Sorted disjoint [begin, end) offsets of the modified data. */
+    static constexpr size_t max_modified_ranges =
+        16; /**< Limit of the modified ranges kept apart. */
     size_t       stream_size = 0; /**< Size of the stream. */
+    Elf64_Off    stream_offset =
+        0; /**< Offset of the data in the stream given on load(). */
     mutable bool is_lazy =
         false; /**< Flag indicating if lazy loading is enabled. */
-    mutable bool is_loaded =
-        false; /**< Flag indicating if the data is loaded. */
-    mutable bool can_be_loaded =
-        true; /**< Flag indicating if the data can loaded. This is not the case if the section is corrupted. */
+    mutable std::atomic<bool> is_loaded{
+        false }; /**< Flag indicating if the data is loaded. */
+    mutable std::atomic<bool> can_be_loaded{
+        true }; /**< Flag indicating if the data can loaded. This is not the case if the section is corrupted. */
 };
 
 } // namespace ELFIO
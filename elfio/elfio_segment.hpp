@@ -27,6 +27,8 @@ THE SOFTWARE.
 #include <vector>
 #include <new>
 #include <limits>
+#include <atomic>
+#include <mutex>
 
 namespace ELFIO {
 
@@ -85,6 +87,16 @@ class segment
     //! \brief Free the data of the segment
     virtual void free_data() const = 0;
 
+    //------------------------------------------------------------------------------
+    //! \brief Keep the data loaded until unpin_data() is called, even when
+    //!        a data cache releases data to load data of other objects.
+    //!        Pins are counted. Pin the segment before calling get_data()
+    virtual void pin_data() const = 0;
+
+    //------------------------------------------------------------------------------
+    //! \brief Remove a pin added by pin_data()
+    virtual void unpin_data() const = 0;
+
     //------------------------------------------------------------------------------
     //! \brief Add a section to the segment
     //! \param psec Pointer to the section
@@ -128,7 +140,15 @@ class segment
     virtual const std::vector<Elf_Half>& get_sections() const = 0;
 
     //------------------------------------------------------------------------------
-    //! \brief Load the segment from a stream
+    //! \brief Load the segment
+    //! \param context Load parameters shared by all segments of the file
+    //! \param header_data Raw segment header as read from the stream
+    //! \return True if successful, false otherwise
+    virtual bool load( const load_context& context,
+                       const char*         header_data ) = 0;
+    //------------------------------------------------------------------------------
+    //! \brief Load the segment from a stream. Kept for compatibility:
+    //!        reads the header and calls the load() taking a load_context
     //! \param stream Input stream
     //! \param header_offset Offset of the segment header
     //! \param is_lazy Whether to load the segment lazily
@@ -144,12 +164,32 @@ class segment
     virtual void save( std::ostream&  stream,
                        std::streampos header_offset,
                        std::streampos data_offset ) = 0;
+    //------------------------------------------------------------------------------
+    //! \brief Add the segment header to an ordered output list
+    //! \param chunks Output list
+    //! \param header_offset Offset of the segment header
+    //! \param data_offset Offset of the segment data
+    virtual void gather( output_chunks& chunks,
+                         Elf64_Off      header_offset,
+                         Elf64_Off      data_offset ) = 0;
+    //------------------------------------------------------------------------------
+    //! \brief Add the segment header to an output list if it was changed
+    //!        since the last load or save
+    //! \param chunks Output list
+    //! \param header_offset Offset of the segment header
+    //! \return False if the segment does not fit its place in the file
+    virtual bool gather_changes( output_chunks& chunks,
+                                 Elf64_Off      header_offset ) const = 0;
+    //------------------------------------------------------------------------------
+    //! \brief Record the current state as the one stored in the file
+    virtual void set_saved() = 0;
 };
 
 //------------------------------------------------------------------------------
 //! \class segment_impl
 //! \brief Implementation of the segment class
-template <class T> class segment_impl : public segment
+template <class T>
+class segment_impl : public segment, public cached_object
 {
   public:
     //------------------------------------------------------------------------------
@@ -162,6 +202,15 @@ template <class T> class segment_impl : public segment
     {
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Destructor. Stops tracking of the data by the data cache
+    ~segment_impl() override
+    {
+        if ( cache ) {
+            cache->remove( this );
+        }
+    }
+
     //------------------------------------------------------------------------------
     // Section info functions
     ELFIO_GET_SET_ACCESS( Elf_Word, type, ph.p_type );
@@ -183,10 +232,18 @@ template <class T> class segment_impl : public segment
     //! \return Pointer to the data
     const char* get_data() const override
     {
+        if ( cache ) {
+            return get_cached_data();
+        }
+
         if ( !is_loaded ) {
-            load_data();
+            // Concurrent readers of the segment wait for a single load
+            std::lock_guard<std::mutex> lock( load_mutex );
+            if ( !is_loaded ) {
+                load_data();
+            }
         }
-        return data.get();
+        return data ? data.get() : mapped_data;
     }
 
     //------------------------------------------------------------------------------
@@ -194,11 +251,51 @@ template <class T> class segment_impl : public segment
     void free_data() const override
     {
         if ( is_lazy ) {
-            data.reset( nullptr );
-            is_loaded = false;
+            {
+                std::lock_guard<std::mutex> lock( load_mutex );
+                data.reset( nullptr );
+                mapped_data = nullptr;
+                is_loaded   = false;
+            }
+            if ( cache ) {
+                cache->remove( this );
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Keep the data loaded until unpin_data() is called
+    void pin_data() const override
+    {
+        if ( cache ) {
+            cache->pin( this );
         }
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Remove a pin added by pin_data()
+    void unpin_data() const override
+    {
+        if ( cache ) {
+            cache->unpin( this );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Release the data loaded on demand for the data cache
+    //! \return True if the data was released, false if it has to be kept
+    bool release_cached_data() const override
+    {
+        std::lock_guard<std::mutex> lock( load_mutex );
+        if ( !is_lazy || !is_loaded || !data ) {
+            return false;
+        }
+
+        data.reset( nullptr );
+        is_loaded = false;
+        return true;
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Add a section index to the segment
     //! \param sec_index Index of the section
@@ -276,6 +373,37 @@ template <class T> class segment_impl : public segment
     //! \param value Index of the segment
     void set_index( const Elf_Half& value ) override { index = value; }
 
+    //------------------------------------------------------------------------------
+    //! \brief Load the segment
+    //! \param context Load parameters shared by all segments of the file
+    //! \param header_data Raw segment header as read from the stream
+    //! \return True if successful, false otherwise
+    bool load( const load_context& context,
+               const char*         header_data ) override
+    {
+        pstream      = context.stream;
+        is_lazy      = context.is_lazy;
+        mapping      = context.mapping;
+        stream_mutex = context.stream_mutex;
+        reader       = is_lazy ? context.file : nullptr;
+        cache        = is_lazy ? context.cache : nullptr;
+        set_stream_size( context.stream_size );
+
+        std::copy( header_data, header_data + sizeof( ph ),
+                   reinterpret_cast<char*>( &ph ) );
+        file_ph       = ph;
+        is_in_file    = true;
+        stream_offset = ( *convertor )( ph.p_offset );
+
+        is_offset_set = true;
+
+        if ( !( is_lazy || is_loaded ) ) {
+            return load_data();
+        }
+
+        return true;
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Load the segment from a stream
     //! \param stream Input stream
@@ -286,27 +414,25 @@ template <class T> class segment_impl : public segment
                std::streampos header_offset,
                bool           is_lazy_ ) override
     {
-        pstream = &stream;
-        is_lazy = is_lazy_;
-
+        load_context context;
+        context.stream  = &stream;
+        context.is_lazy = is_lazy_;
         if ( translator->empty() ) {
             stream.seekg( 0, std::istream::end );
-            set_stream_size( size_t( stream.tellg() ) );
+            context.stream_size = size_t( stream.tellg() );
         }
         else {
-            set_stream_size( std::numeric_limits<size_t>::max() );
+            context.stream_size = std::numeric_limits<size_t>::max();
         }
 
+        T raw_ph = {};
         stream.seekg( ( *translator )[header_offset] );
-        stream.read( reinterpret_cast<char*>( &ph ), sizeof( ph ) );
-
-        is_offset_set = true;
-
-        if ( !( is_lazy || is_loaded ) ) {
-            return load_data();
+        if ( !stream.read( reinterpret_cast<char*>( &raw_ph ),
+                           sizeof( raw_ph ) ) ) {
+            return false;
         }
 
-        return true;
+        return load( context, reinterpret_cast<const char*>( &raw_ph ) );
     }
 
     //------------------------------------------------------------------------------
@@ -318,7 +444,8 @@ template <class T> class segment_impl : public segment
             return true;
         }
 
-        Elf_Xword p_offset = ( *translator )[( *convertor )( ph.p_offset )];
+        // The header offset changes when the file is saved
+        Elf_Xword p_offset = ( *translator )[stream_offset];
         Elf_Xword size     = get_file_size();
 
         // Check for integer overflow in offset calculation
@@ -340,10 +467,30 @@ template <class T> class segment_impl : public segment
             return false;
         }
 
+        // No copy is needed when the file is memory mapped
+        if ( mapping ) {
+            mapped_data = mapping->get_data() + p_offset;
+            is_loaded   = true;
+            return true;
+        }
+
         data.reset( new ( std::nothrow ) char[(size_t)size + 1] );
 
-        pstream->seekg( p_offset );
-        if ( nullptr != data.get() && pstream->read( data.get(), size ) ) {
+        bool is_read = false;
+        if ( nullptr != data.get() && reader ) {
+            is_read = reader->read( p_offset, data.get(), size );
+        }
+        else if ( nullptr != data.get() ) {
+            // The stream position is shared by all segments and sections
+            std::unique_lock<std::mutex> lock;
+            if ( stream_mutex ) {
+                lock = std::unique_lock<std::mutex>( *stream_mutex );
+            }
+            pstream->seekg( p_offset );
+            is_read = bool( pstream->read( data.get(), size ) );
+        }
+
+        if ( is_read ) {
             data.get()[size] = 0;
         }
         else {
@@ -371,6 +518,54 @@ template <class T> class segment_impl : public segment
         stream.write( reinterpret_cast<const char*>( &ph ), sizeof( ph ) );
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Add the segment header to an ordered output list
+    //! \param chunks Output list
+    //! \param header_offset Offset of the segment header
+    //! \param data_offset Offset of the segment data
+    void gather( output_chunks& chunks,
+                 Elf64_Off      header_offset,
+                 Elf64_Off      data_offset ) override
+    {
+        ph.p_offset = decltype( ph.p_offset )( data_offset );
+        ph.p_offset = ( *convertor )( ph.p_offset );
+        chunks.add( header_offset, reinterpret_cast<const char*>( &ph ),
+                    sizeof( ph ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Add the segment header to an output list if it was changed
+    //!        since the last load or save
+    //! \param chunks Output list
+    //! \param header_offset Offset of the segment header
+    //! \return False if the segment does not fit its place in the file
+    bool gather_changes( output_chunks& chunks,
+                         Elf64_Off      header_offset ) const override
+    {
+        if ( std::equal( reinterpret_cast<const char*>( &ph ),
+                         reinterpret_cast<const char*>( &ph + 1 ),
+                         reinterpret_cast<const char*>( &file_ph ) ) ) {
+            return true;
+        }
+
+        if ( !is_in_file || ph.p_offset != file_ph.p_offset ||
+             ph.p_filesz != file_ph.p_filesz ) {
+            return false;
+        }
+
+        chunks.add( header_offset, reinterpret_cast<const char*>( &ph ),
+                    sizeof( ph ) );
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Record the current state as the one stored in the file
+    void set_saved() override
+    {
+        file_ph    = ph;
+        is_in_file = true;
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Get the stream size
     //! \return Stream size
@@ -383,21 +578,63 @@ template <class T> class segment_impl : public segment
 
     //------------------------------------------------------------------------------
   private:
+    //------------------------------------------------------------------------------
+    //! \brief Get the data of a segment tracked by the data cache.
+    //!        The data may be released by the cache at any time, so
+    //!        the pointer is taken under the lock of the segment
+    //! \return Pointer to the data
+    const char* get_cached_data() const
+    {
+        const char* result   = nullptr;
+        bool        is_added = false;
+        {
+            std::lock_guard<std::mutex> lock( load_mutex );
+            if ( !is_loaded ) {
+                is_added = load_data() && data && get_file_size() != 0;
+            }
+            result = data ? data.get() : mapped_data;
+        }
+
+        // The cache may release data of other segments and sections
+        if ( is_added ) {
+            cache->add( this, (size_t)get_file_size() );
+        }
+        else if ( result != nullptr ) {
+            cache->touch( this );
+        }
+        return result;
+    }
+
+    //------------------------------------------------------------------------------
     mutable std::istream* pstream = nullptr;  //!< Pointer to the input stream
     T                     ph      = {};       //!< Segment header
+    T                     file_ph = {};       //!< Segment header in the file
     Elf_Half              index   = 0;        //!< Index of the segment
     mutable std::unique_ptr<char[]> data;     //!< Pointer to the segment data
-    std::vector<Elf_Half>           sections; //!< Vector of section indices
+    mutable const char*             mapped_data =
+        nullptr; //!< Pointer to the segment data inside the file mapping
+    std::shared_ptr<const mapped_file> mapping =
+        nullptr; //!< File mapping, if the file is memory mapped
+    std::shared_ptr<const positional_file> reader =
+        nullptr; //!< File for reading the data on demand, if any
+    std::shared_ptr<std::mutex> stream_mutex =
+        nullptr; //!< Lock of the stream position shared by all segments
+    mutable std::mutex load_mutex; //!< Lock of the data load
+    std::shared_ptr<data_cache> cache =
+        nullptr; //!< Cache of the data loaded on demand, if any
+    std::vector<Elf_Half> sections; //!< Vector of section indices
     std::shared_ptr<endianness_convertor> convertor =
         nullptr; //!< Pointer to the endianness convertor
     std::shared_ptr<address_translator> translator =
         nullptr;                  //!< Pointer to the address translator
     size_t stream_size   = 0;     //!< Stream size
+    Elf64_Off stream_offset = 0;  //!< Offset of the data in the loaded stream
     bool   is_offset_set = false; //!< Flag indicating if the offset is set
+    bool   is_in_file    = false; //!< Flag indicating if stored in the file
     mutable bool is_lazy =
         false; //!< Flag indicating if the segment is loaded lazily
-    mutable bool is_loaded =
-        false; //!< Flag indicating if the segment is loaded
+    mutable std::atomic<bool> is_loaded{
+        false }; //!< Flag indicating if the segment is loaded
 };
 
 } // namespace ELFIO
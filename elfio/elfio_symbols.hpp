@@ -147,7 +147,20 @@ template <class S> class symbol_section_accessor_template
             }
         }
 
-        if ( !ret ) {
+        if ( !ret && is_name_index_built ) {
+            Elf_Xword index = 0;
+            if ( find_indexed_name( name, index ) ) {
+                // The name is known already, only the fields are read
+                ret = elf_file.get_class() == ELFCLASS32
+                          ? generic_get_symbol_fields<Elf32_Sym>(
+                                index, value, size, bind, type, section_index,
+                                other )
+                          : generic_get_symbol_fields<Elf64_Sym>(
+                                index, value, size, bind, type, section_index,
+                                other );
+            }
+        }
+        else if ( !ret ) {
             for ( Elf_Xword i = 0; !ret && i < get_symbols_num(); i++ ) {
                 std::string symbol_name;
                 if ( get_symbol( i, symbol_name, value, size, bind, type,
@@ -187,7 +200,19 @@ template <class S> class symbol_section_accessor_template
         bool       match = false;
         Elf64_Addr v     = 0;
 
-        if ( elf_file.get_class() == ELFCLASS32 ) {
+        if ( is_address_index_built ) {
+            // The first symbol with the value has the lowest index
+            auto it = std::lower_bound( address_index.begin(),
+                                        address_index.end(), value,
+                                        []( const auto& entry, Elf64_Addr a ) {
+                                            return entry.value < a;
+                                        } );
+            if ( it != address_index.end() && it->value == value ) {
+                match = true;
+                idx   = it->index;
+            }
+        }
+        else if ( elf_file.get_class() == ELFCLASS32 ) {
             match = generic_search_symbols<Elf32_Sym>(
                 [&]( const Elf32_Sym* sym ) {
                     return ( *convertor )( sym->st_value ) == value;
@@ -210,6 +235,139 @@ template <class S> class symbol_section_accessor_template
         return false;
     }
 
+    //------------------------------------------------------------------------------
+    // @brief Find the symbol containing the specified address
+    //
+    // A symbol contains the address if value <= address < value + size.
+    // If several symbols contain the address, the one with the highest
+    // value is chosen, and among those the one with the lowest index
+    // @param address Address to look for
+    // @param index Index of the found symbol
+    // @return True if the symbol is found, false otherwise
+    //------------------------------------------------------------------------------
+    bool find_symbol_containing( const Elf64_Addr& address,
+                                 Elf_Xword&        index ) const
+    {
+        if ( !is_address_index_built ) {
+            std::vector<address_index_entry> entries;
+            collect_address_entries( entries );
+            return find_containing( entries, address, index );
+        }
+
+        // The symbols before 'last' start at or below the address. Those
+        // ending above it contain the address
+        auto last = std::upper_bound( address_index.begin(),
+                                      address_index.end(), address,
+                                      []( Elf64_Addr a, const auto& entry ) {
+                                          return a < entry.value;
+                                      } );
+        size_t found = find_last_end_above(
+            1, 0, address_leaves, 0, size_t( last - address_index.begin() ),
+            address );
+        if ( found == npos ) {
+            return false;
+        }
+
+        // The lowest index among the containing symbols of the highest value
+        auto first = std::lower_bound( address_index.begin(),
+                                       address_index.begin() + found,
+                                       address_index[found].value,
+                                       []( const auto& entry, Elf64_Addr a ) {
+                                           return entry.value < a;
+                                       } );
+        found = find_first_end_above( 1, 0, address_leaves,
+                                      size_t( first - address_index.begin() ),
+                                      found + 1, address );
+        index = address_index[found].index;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Build an index of the symbols sorted by their values
+    //
+    // Lookups by value and find_symbol_containing() use the index once it
+    // is built. Adding or rearranging symbols through this accessor
+    // discards the index
+    //------------------------------------------------------------------------------
+    void build_address_index()
+    {
+        collect_address_entries( address_index );
+        std::stable_sort( address_index.begin(), address_index.end(),
+                          []( const auto& a, const auto& b ) {
+                              return a.value < b.value;
+                          } );
+
+        // A tree of the highest symbol ends over the sorted symbols. Leaves
+        // past the symbols end at 0 and never contain an address
+        address_leaves = 1;
+        while ( address_leaves < address_index.size() ) {
+            address_leaves *= 2;
+        }
+        address_ends.assign( 2 * address_leaves, 0 );
+        for ( size_t i = 0; i < address_index.size(); ++i ) {
+            const auto& entry = address_index[i];
+            Elf64_Addr  end   = entry.value + entry.size;
+            if ( end < entry.value ) {
+                end = std::numeric_limits<Elf64_Addr>::max();
+            }
+            address_ends[address_leaves + i] = end;
+        }
+        for ( size_t i = address_leaves - 1; i > 0; --i ) {
+            address_ends[i] =
+                std::max( address_ends[2 * i], address_ends[2 * i + 1] );
+        }
+        is_address_index_built = true;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Build an index of the symbols by their names
+    //
+    // Lookups by name use the index when the section has no hash table or
+    // the hash table does not contain the name. The index keeps the hashes
+    // of the names and their string table offsets, and the names are
+    // compared with the string table on lookup, so it doesn't refer to
+    // the string table data. It is discarded when symbols are added or
+    // rearranged through this accessor and shall be rebuilt after names
+    // were changed by other means
+    //------------------------------------------------------------------------------
+    void build_name_index()
+    {
+        name_index.clear();
+
+        const auto&    convertor = elf_file.get_convertor();
+        const section* string_table =
+            elf_file.sections[get_string_table_index()];
+        const_string_section_accessor str_reader( string_table );
+        data_pin<section>             pin( string_table );
+
+        Elf_Xword count = get_symbols_num();
+        name_index.reserve( count );
+        for ( Elf_Xword i = 0; i < count; ++i ) {
+            Elf_Word name_offset = 0;
+            if ( elf_file.get_class() == ELFCLASS32 ) {
+                const auto* sym = generic_get_symbol_ptr<Elf32_Sym>( i );
+                if ( sym == nullptr ) {
+                    break;
+                }
+                name_offset = ( *convertor )( sym->st_name );
+            }
+            else {
+                const auto* sym = generic_get_symbol_ptr<Elf64_Sym>( i );
+                if ( sym == nullptr ) {
+                    break;
+                }
+                name_offset = ( *convertor )( sym->st_name );
+            }
+
+            const char* str = str_reader.get_string( name_offset );
+            name_index.emplace(
+                std::hash<std::string_view>()( str != nullptr ? str : "" ),
+                name_index_entry{ i, name_offset } );
+        }
+        is_name_index_built = true;
+    }
+
     //------------------------------------------------------------------------------
     // @brief Add a symbol to the section
     // @param name Name of the symbol
@@ -229,6 +387,8 @@ template <class S> class symbol_section_accessor_template
     {
         Elf_Word nRet;
 
+        discard_indices();
+
         if ( symbol_section->get_size() == 0 ) {
             if ( elf_file.get_class() == ELFCLASS32 ) {
                 nRet = generic_add_symbol<Elf32_Sym>( 0, 0, 0, 0, 0, 0 );
@@ -332,6 +492,8 @@ template <class S> class symbol_section_accessor_template
     {
         Elf_Xword nRet = 0;
 
+        discard_indices();
+
         if ( elf_file.get_class() == ELFCLASS32 ) {
             nRet = generic_arrange_local_symbols<Elf32_Sym>( func );
         }
@@ -342,8 +504,369 @@ template <class S> class symbol_section_accessor_template
         return nRet;
     }
 
+    //------------------------------------------------------------------------------
+    // @brief Generate a GNU hash table (.gnu.hash) for the symbols
+    //
+    // The defined non-local symbols are hashed. They are moved after the
+    // other symbols and grouped by their hash buckets, as required by the
+    // GNU hash table format. Local symbols keep their positions at the
+    // beginning of the table. Symbol versions and relocations referring to
+    // the symbols have to be updated by the caller for each swap
+    // @param hash_section Section receiving the hash table
+    // @param func Function to be called for each pair of swapped symbols
+    // @return True if successful, false otherwise
+    //------------------------------------------------------------------------------
+    bool build_gnu_hash_section(
+        section*                                                 hash_section,
+        std::function<void( Elf_Xword first, Elf_Xword second )> func =
+            nullptr )
+    {
+        bool ret = false;
+
+        discard_indices();
+
+        if ( elf_file.get_class() == ELFCLASS32 ) {
+            ret = generic_build_gnu_hash_section<Elf32_Sym, std::uint32_t>(
+                hash_section, func );
+        }
+        else {
+            ret = generic_build_gnu_hash_section<Elf64_Sym, std::uint64_t>(
+                hash_section, func );
+        }
+
+        if ( ret ) {
+            this->hash_section = hash_section;
+            hash_section_index = hash_section->get_index();
+        }
+
+        return ret;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Generate a System V hash table (.hash) for the symbols
+    //
+    // All symbols are hashed. When both tables are needed, the GNU hash
+    // table shall be generated first, since it reorders the symbols
+    // @param hash_section Section receiving the hash table
+    // @return True if successful, false otherwise
+    //------------------------------------------------------------------------------
+    bool build_hash_section( section* hash_section )
+    {
+        const auto& convertor = elf_file.get_convertor();
+
+        Elf_Xword count = get_symbols_num();
+        if ( hash_section == nullptr || symbol_section->get_data() == nullptr ||
+             count == 0 || count > std::numeric_limits<Elf_Word>::max() ) {
+            return false;
+        }
+
+        std::vector<std::uint32_t> hashes;
+        if ( !get_symbol_hashes( hashes, elf_hash ) ) {
+            return false;
+        }
+
+        // Aim at chains of two symbols on average
+        Elf_Word              nbucket = get_hash_bucket_count( count / 2 );
+        std::vector<Elf_Word> table( 2 + nbucket + count, 0 );
+        Elf_Word*             buckets = table.data() + 2;
+        Elf_Word*             chains  = buckets + nbucket;
+        table[0]                      = nbucket;
+        table[1]                      = Elf_Word( count );
+        // Insert in reverse order, so each chain lists the lower indices
+        // first
+        for ( Elf_Xword i = count - 1; i > 0; --i ) {
+            Elf_Word bucket = hashes[i] % nbucket;
+            chains[i]       = buckets[bucket];
+            buckets[bucket] = Elf_Word( i );
+        }
+        for ( auto& word : table ) {
+            word = ( *convertor )( word );
+        }
+
+        hash_section->set_type( SHT_HASH );
+        hash_section->set_link( symbol_section->get_index() );
+        hash_section->set_entry_size( sizeof( Elf_Word ) );
+        hash_section->set_addr_align( sizeof( Elf_Word ) );
+        hash_section->set_data( reinterpret_cast<const char*>( table.data() ),
+                                table.size() * sizeof( Elf_Word ) );
+
+        this->hash_section = hash_section;
+        hash_section_index = hash_section->get_index();
+
+        return true;
+    }
+
     //------------------------------------------------------------------------------
   private:
+    //------------------------------------------------------------------------------
+    // @brief Get the number of hash buckets for the given target
+    // @param target Desired number of buckets
+    // @return The smallest prime number not less than the target
+    //------------------------------------------------------------------------------
+    static Elf_Word get_hash_bucket_count( Elf_Xword target )
+    {
+        auto is_prime = []( Elf_Xword n ) {
+            for ( Elf_Xword d = 2; d * d <= n; ++d ) {
+                if ( n % d == 0 ) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        Elf_Xword n = std::max<Elf_Xword>( target, 1 );
+        while ( n > 2 && !is_prime( n ) ) {
+            ++n;
+        }
+
+        return Elf_Word( n );
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Calculate the hashes of all symbol names
+    // @param hashes Receives a hash for each symbol
+    // @param hash_func Hash function
+    // @return True if successful, false otherwise
+    //------------------------------------------------------------------------------
+    bool get_symbol_hashes( std::vector<std::uint32_t>& hashes,
+                            std::uint32_t ( *hash_func )(
+                                const unsigned char* ) ) const
+    {
+        const auto& convertor = elf_file.get_convertor();
+        string_section_accessor str_reader(
+            elf_file.sections[get_string_table_index()] );
+
+        Elf_Xword count = get_symbols_num();
+        hashes.resize( count );
+        for ( Elf_Xword i = 0; i < count; ++i ) {
+            Elf_Word name_offset = 0;
+            if ( elf_file.get_class() == ELFCLASS32 ) {
+                const auto* sym = generic_get_symbol_ptr<Elf32_Sym>( i );
+                if ( sym == nullptr ) {
+                    return false;
+                }
+                name_offset = ( *convertor )( sym->st_name );
+            }
+            else {
+                const auto* sym = generic_get_symbol_ptr<Elf64_Sym>( i );
+                if ( sym == nullptr ) {
+                    return false;
+                }
+                name_offset = ( *convertor )( sym->st_name );
+            }
+            const char* str = str_reader.get_string( name_offset );
+            hashes[i] = hash_func( reinterpret_cast<const unsigned char*>(
+                str != nullptr ? str : "" ) );
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Position returned when no symbol is found in the address index
+    //------------------------------------------------------------------------------
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    //------------------------------------------------------------------------------
+    // @brief Entry of the address index
+    //------------------------------------------------------------------------------
+    struct address_index_entry
+    {
+        Elf64_Addr value; ///< Value of the symbol
+        Elf_Xword  size;  ///< Size of the symbol
+        Elf_Xword  index; ///< Index of the symbol
+    };
+
+    //------------------------------------------------------------------------------
+    // @brief Entry of the name index
+    //------------------------------------------------------------------------------
+    struct name_index_entry
+    {
+        Elf_Xword index;       ///< Index of the symbol
+        Elf_Word  name_offset; ///< Offset of the name in the string table
+    };
+
+    //------------------------------------------------------------------------------
+    // @brief Find a symbol by its name in the name index
+    // @param name Name of the symbol
+    // @param index Index of the found symbol. The first symbol wins for
+    //        duplicated names
+    // @return True if the symbol is found, false otherwise
+    //------------------------------------------------------------------------------
+    bool find_indexed_name( std::string_view name, Elf_Xword& index ) const
+    {
+        const section* string_table =
+            elf_file.sections[get_string_table_index()];
+        const_string_section_accessor str_reader( string_table );
+        data_pin<section>             pin( string_table );
+
+        bool found = false;
+        auto range = name_index.equal_range( std::hash<std::string_view>()(
+            name ) );
+        for ( auto it = range.first; it != range.second; ++it ) {
+            if ( found && it->second.index > index ) {
+                continue;
+            }
+            const char* str = str_reader.get_string( it->second.name_offset );
+            if ( str != nullptr && name == str ) {
+                index = it->second.index;
+                found = true;
+            }
+        }
+
+        return found;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Collect values and sizes of the symbols in the table order
+    // @param entries Receives the entries
+    //------------------------------------------------------------------------------
+    void collect_address_entries(
+        std::vector<address_index_entry>& entries ) const
+    {
+        entries.clear();
+        if ( elf_file.get_class() == ELFCLASS32 ) {
+            generic_collect_address_entries<Elf32_Sym>( entries );
+        }
+        else {
+            generic_collect_address_entries<Elf64_Sym>( entries );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Collect values and sizes of the symbols in the table order
+    // @param entries Receives the entries
+    //------------------------------------------------------------------------------
+    template <class T>
+    void generic_collect_address_entries(
+        std::vector<address_index_entry>& entries ) const
+    {
+        const auto& convertor = elf_file.get_convertor();
+
+        Elf_Xword count = get_symbols_num();
+        entries.reserve( count );
+        for ( Elf_Xword i = 0; i < count; ++i ) {
+            const T* sym = generic_get_symbol_ptr<T>( i );
+            if ( sym == nullptr ) {
+                break;
+            }
+            entries.push_back( { ( *convertor )( sym->st_value ),
+                                 ( *convertor )( sym->st_size ), i } );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Find the last sorted symbol in [begin, end) ending above an
+    //        address, searching the subtree of the end tree at a node
+    // @param node Node of the end tree
+    // @param node_begin First sorted symbol covered by the node
+    // @param node_size Number of the sorted symbols covered by the node
+    // @param begin First sorted symbol to search
+    // @param end Sorted symbol past the last one to search
+    // @param address Address to look for
+    // @return Position of the symbol in the address index, or npos
+    //------------------------------------------------------------------------------
+    size_t find_last_end_above( size_t     node,
+                                size_t     node_begin,
+                                size_t     node_size,
+                                size_t     begin,
+                                size_t     end,
+                                Elf64_Addr address ) const
+    {
+        if ( node_begin >= end || node_begin + node_size <= begin ||
+             address_ends[node] <= address ) {
+            return npos;
+        }
+        if ( node_size == 1 ) {
+            return node_begin;
+        }
+
+        size_t half  = node_size / 2;
+        size_t found = find_last_end_above( 2 * node + 1, node_begin + half,
+                                            half, begin, end, address );
+        if ( found == npos ) {
+            found = find_last_end_above( 2 * node, node_begin, half, begin,
+                                         end, address );
+        }
+
+        return found;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Find the first sorted symbol in [begin, end) ending above an
+    //        address, searching the subtree of the end tree at a node
+    // @param node Node of the end tree
+    // @param node_begin First sorted symbol covered by the node
+    // @param node_size Number of the sorted symbols covered by the node
+    // @param begin First sorted symbol to search
+    // @param end Sorted symbol past the last one to search
+    // @param address Address to look for
+    // @return Position of the symbol in the address index, or npos
+    //------------------------------------------------------------------------------
+    size_t find_first_end_above( size_t     node,
+                                 size_t     node_begin,
+                                 size_t     node_size,
+                                 size_t     begin,
+                                 size_t     end,
+                                 Elf64_Addr address ) const
+    {
+        if ( node_begin >= end || node_begin + node_size <= begin ||
+             address_ends[node] <= address ) {
+            return npos;
+        }
+        if ( node_size == 1 ) {
+            return node_begin;
+        }
+
+        size_t half  = node_size / 2;
+        size_t found = find_first_end_above( 2 * node, node_begin, half, begin,
+                                             end, address );
+        if ( found == npos ) {
+            found = find_first_end_above( 2 * node + 1, node_begin + half,
+                                          half, begin, end, address );
+        }
+
+        return found;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Find the symbol containing an address by a linear scan
+    // @param entries Symbols in the table order
+    // @param address Address to look for
+    // @param index Index of the found symbol
+    // @return True if the symbol is found, false otherwise
+    //------------------------------------------------------------------------------
+    static bool
+    find_containing( const std::vector<address_index_entry>& entries,
+                     Elf64_Addr                              address,
+                     Elf_Xword&                              index )
+    {
+        const address_index_entry* found = nullptr;
+        for ( const auto& entry : entries ) {
+            if ( entry.value <= address && address - entry.value < entry.size &&
+                 ( found == nullptr || entry.value > found->value ) ) {
+                found = &entry;
+            }
+        }
+        if ( found != nullptr ) {
+            index = found->index;
+        }
+
+        return found != nullptr;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Discard the indices after a modification of the symbols
+    //------------------------------------------------------------------------------
+    void discard_indices()
+    {
+        address_index.clear();
+        address_ends.clear();
+        is_address_index_built = false;
+        name_index.clear();
+        is_name_index_built = false;
+    }
+
     //------------------------------------------------------------------------------
     // @brief Find the hash section
     //------------------------------------------------------------------------------
@@ -530,6 +1053,54 @@ template <class S> class symbol_section_accessor_template
         return nullptr;
     }
 
+    //------------------------------------------------------------------------------
+    // @brief Get the fields of the symbol at the specified index except
+    //        its name
+    // @param index Index of the symbol
+    // @param value Value of the symbol
+    // @param size Size of the symbol
+    // @param bind Binding of the symbol
+    // @param type Type of the symbol
+    // @param section_index Section index of the symbol
+    // @param other Other attributes of the symbol
+    // @return True if the symbol exists, false otherwise
+    //------------------------------------------------------------------------------
+    template <class T>
+    bool generic_get_symbol_fields( Elf_Xword      index,
+                                    Elf64_Addr&    value,
+                                    Elf_Xword&     size,
+                                    unsigned char& bind,
+                                    unsigned char& type,
+                                    Elf_Half&      section_index,
+                                    unsigned char& other ) const
+    {
+        const T* sym = generic_get_symbol_ptr<T>( index );
+        if ( sym == nullptr ) {
+            return false;
+        }
+
+        const auto& convertor = elf_file.get_convertor();
+        value                 = ( *convertor )( sym->st_value );
+        size                  = ( *convertor )( sym->st_size );
+        bind                  = ELF_ST_BIND( sym->st_info );
+        type                  = ELF_ST_TYPE( sym->st_info );
+        section_index         = ( *convertor )( sym->st_shndx );
+        other                 = sym->st_other;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    // @brief Mark the symbol at the specified index as modified in place
+    // @param index Index of the symbol
+    //------------------------------------------------------------------------------
+    void mark_symbol_modified( Elf_Xword index )
+    {
+        symbol_section->mark_data_modified(
+            index * symbol_section->get_entry_size(),
+            symbol_section->get_entry_size() );
+    }
+
     //------------------------------------------------------------------------------
     // @brief Search for a symbol in the section
     // @param match Function to be called for each symbol
@@ -688,6 +1259,8 @@ template <class S> class symbol_section_accessor_template
                     func( first_not_local, current );
 
                 std::swap( *p1, *p2 );
+                mark_symbol_modified( first_not_local );
+                mark_symbol_modified( current );
             }
             else {
                 // Update 'info' field of the section
@@ -699,12 +1272,163 @@ template <class S> class symbol_section_accessor_template
         return first_not_local;
     }
 
+    //------------------------------------------------------------------------------
+    // @brief Generate a GNU hash table for the symbols
+    // @param hash_section Section receiving the hash table
+    // @param func Function to be called for each pair of swapped symbols
+    // @return True if successful, false otherwise
+    //------------------------------------------------------------------------------
+    template <class T, class W>
+    bool generic_build_gnu_hash_section(
+        section*                                                 hash_section,
+        std::function<void( Elf_Xword first, Elf_Xword second )> func )
+    {
+        const auto& convertor = elf_file.get_convertor();
+
+        Elf_Xword count = get_symbols_num();
+        if ( hash_section == nullptr || symbol_section->get_data() == nullptr ||
+             count == 0 || count > std::numeric_limits<Elf_Word>::max() ) {
+            return false;
+        }
+
+        std::vector<std::uint32_t> hashes;
+        if ( !get_symbol_hashes( hashes, elf_gnu_hash ) ) {
+            return false;
+        }
+
+        // Symbols that are not hashed keep their relative order before
+        // the hashed ones
+        std::vector<Elf_Xword> order;
+        std::vector<Elf_Xword> hashed;
+        order.reserve( count );
+        order.push_back( 0 );
+        for ( Elf_Xword i = 1; i < count; ++i ) {
+            const T* sym = generic_get_symbol_ptr<T>( i );
+            if ( ELF_ST_BIND( sym->st_info ) == STB_LOCAL ||
+                 ( *convertor )( sym->st_shndx ) == SHN_UNDEF ) {
+                order.push_back( i );
+            }
+            else {
+                hashed.push_back( i );
+            }
+        }
+        auto symoffset = std::uint32_t( order.size() );
+
+        // Fewer buckets than for the System V table: the Bloom filter
+        // rejects most of the missing names without walking the chains
+        auto nbuckets = std::uint32_t( get_hash_bucket_count(
+            std::max<Elf_Xword>( hashed.size() / 4, 1 ) ) );
+        std::stable_sort( hashed.begin(), hashed.end(),
+                          [&]( Elf_Xword a, Elf_Xword b ) {
+                              return hashes[a] % nbuckets <
+                                     hashes[b] % nbuckets;
+                          } );
+        order.insert( order.end(), hashed.begin(), hashed.end() );
+
+        // Bloom filter size, the same as chosen by GNU ld
+        const std::uint32_t word_bits = 8 * sizeof( W );
+        const std::uint32_t shift1    = word_bits == 64 ? 6 : 5;
+        std::uint32_t       maskbitslog2 = 1; // log2 rounded up, plus one
+        while ( ( Elf_Xword( 1 ) << ( maskbitslog2 - 1 ) ) < hashed.size() ) {
+            ++maskbitslog2;
+        }
+        if ( maskbitslog2 < 3 ) {
+            maskbitslog2 = 5;
+        }
+        else if ( ( Elf_Xword( 1 ) << ( maskbitslog2 - 2 ) ) & hashed.size() ) {
+            maskbitslog2 += 3;
+        }
+        else {
+            maskbitslog2 += 2;
+        }
+        maskbitslog2 = std::max( maskbitslog2, shift1 );
+        std::uint32_t bloom_size  = 1u << ( maskbitslog2 - shift1 );
+        std::uint32_t bloom_shift = maskbitslog2;
+
+        // Move the symbols into the new order
+        std::vector<Elf_Xword> position( count );
+        std::vector<Elf_Xword> symbol_at( count );
+        for ( Elf_Xword i = 0; i < count; ++i ) {
+            position[i]  = i;
+            symbol_at[i] = i;
+        }
+        for ( Elf_Xword i = 0; i < count; ++i ) {
+            Elf_Xword j = position[order[i]];
+            if ( j == i ) {
+                continue;
+            }
+            if ( func ) {
+                func( i, j );
+            }
+            auto* p1 = const_cast<T*>( generic_get_symbol_ptr<T>( i ) );
+            auto* p2 = const_cast<T*>( generic_get_symbol_ptr<T>( j ) );
+            std::swap( *p1, *p2 );
+            mark_symbol_modified( i );
+            mark_symbol_modified( j );
+            std::swap( hashes[i], hashes[j] );
+            position[symbol_at[i]] = j;
+            position[symbol_at[j]] = i;
+            std::swap( symbol_at[i], symbol_at[j] );
+        }
+
+        // Fill the table
+        std::vector<W>             bloom( bloom_size, 0 );
+        std::vector<std::uint32_t> buckets( nbuckets, 0 );
+        std::vector<std::uint32_t> chains( count - symoffset, 0 );
+        for ( Elf_Xword i = symoffset; i < count; ++i ) {
+            std::uint32_t hash = hashes[i];
+            bloom[( hash / word_bits ) % bloom_size] |=
+                ( W( 1 ) << ( hash % word_bits ) ) |
+                ( W( 1 ) << ( ( hash >> bloom_shift ) % word_bits ) );
+
+            std::uint32_t bucket = hash % nbuckets;
+            if ( buckets[bucket] == 0 ) {
+                buckets[bucket] = std::uint32_t( i );
+            }
+            bool is_last = ( i + 1 == count ) ||
+                           ( hashes[i + 1] % nbuckets != bucket );
+            chains[i - symoffset] = ( hash & ~1u ) | ( is_last ? 1 : 0 );
+        }
+
+        std::vector<char> data;
+        auto              append = [&]( auto value ) {
+            value = ( *convertor )( value );
+            data.insert( data.end(), reinterpret_cast<const char*>( &value ),
+                         reinterpret_cast<const char*>( &value ) +
+                             sizeof( value ) );
+        };
+        for ( std::uint32_t value :
+              { nbuckets, symoffset, bloom_size, bloom_shift } ) {
+            append( value );
+        }
+        std::for_each( bloom.begin(), bloom.end(), append );
+        std::for_each( buckets.begin(), buckets.end(), append );
+        std::for_each( chains.begin(), chains.end(), append );
+
+        hash_section->set_type( SHT_GNU_HASH );
+        hash_section->set_link( symbol_section->get_index() );
+        hash_section->set_entry_size( 0 );
+        hash_section->set_addr_align( sizeof( W ) );
+        hash_section->set_data( data.data(), data.size() );
+
+        return true;
+    }
+
     //------------------------------------------------------------------------------
   private:
     const elfio&   elf_file;                ///< Reference to the ELF file
     S*             symbol_section;          ///< Pointer to the symbol section
     Elf_Half       hash_section_index{ 0 }; ///< Index of the hash section
     const section* hash_section{ nullptr }; ///< Pointer to the hash section
+    std::vector<address_index_entry>
+        address_index; ///< Symbols sorted by value
+    std::vector<Elf64_Addr>
+           address_ends; ///< Tree of the highest ends of the sorted symbols
+    size_t address_leaves{ 0 };           ///< Number of leaves of address_ends
+    bool   is_address_index_built{ false }; ///< Whether address_index is used
+    std::unordered_multimap<std::size_t, name_index_entry>
+         name_index;                   ///< Symbols by the hashes of names
+    bool is_name_index_built{ false }; ///< Whether name_index is used
 };
 
 using symbol_section_accessor = symbol_section_accessor_template<section>;
@@ -0,0 +1,734 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ELFIO_TABLE_VIEW_HPP
+#define ELFIO_TABLE_VIEW_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+// This header is not included by elfio.hpp. It includes SIMD intrinsics.
+//
+// Bulk byte order conversion uses byte shuffles of SSSE3 or AVX2, selected
+// at run time, or of NEON. It may be disabled by defining ELFIO_NO_SIMD.
+// In this case the fields are converted one by one
+#ifndef ELFIO_NO_SIMD
+#if ( defined( __GNUC__ ) || defined( __clang__ ) ) &&                         \
+    ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <immintrin.h>
+#define ELFIO_HAS_X86_SHUFFLE 1
+#elif defined( __aarch64__ ) && defined( __ARM_NEON )
+#include <arm_neon.h>
+#define ELFIO_HAS_NEON_SHUFFLE 1
+#endif
+#endif // ELFIO_NO_SIMD
+
+#include <elfio/elfio.hpp>
+
+namespace ELFIO {
+
+//------------------------------------------------------------------------------
+//! \struct table_entry_traits
+//! \brief Layout of a table entry and conversion of its fields to the host
+//!        byte order
+template <class T> struct table_entry_traits;
+
+//------------------------------------------------------------------------------
+template <> struct table_entry_traits<Elf32_Rel>
+{
+    //! Sizes of the fields in declaration order
+    static constexpr unsigned char fields[] = { 4, 4 };
+
+    template <class C> static void convert( Elf32_Rel& entry, const C& conv )
+    {
+        entry.r_offset = conv( entry.r_offset );
+        entry.r_info   = conv( entry.r_info );
+    }
+};
+
+//------------------------------------------------------------------------------
+template <> struct table_entry_traits<Elf32_Rela>
+{
+    //! Sizes of the fields in declaration order
+    static constexpr unsigned char fields[] = { 4, 4, 4 };
+
+    template <class C> static void convert( Elf32_Rela& entry, const C& conv )
+    {
+        entry.r_offset = conv( entry.r_offset );
+        entry.r_info   = conv( entry.r_info );
+        entry.r_addend = conv( entry.r_addend );
+    }
+};
+
+//------------------------------------------------------------------------------
+template <> struct table_entry_traits<Elf64_Rel>
+{
+    //! Sizes of the fields in declaration order
+    static constexpr unsigned char fields[] = { 8, 8 };
+
+    template <class C> static void convert( Elf64_Rel& entry, const C& conv )
+    {
+        entry.r_offset = conv( entry.r_offset );
+        entry.r_info   = conv( entry.r_info );
+    }
+};
+
+//------------------------------------------------------------------------------
+template <> struct table_entry_traits<Elf64_Rela>
+{
+    //! Sizes of the fields in declaration order
+    static constexpr unsigned char fields[] = { 8, 8, 8 };
+
+    template <class C> static void convert( Elf64_Rela& entry, const C& conv )
+    {
+        entry.r_offset = conv( entry.r_offset );
+        entry.r_info   = conv( entry.r_info );
+        entry.r_addend = conv( entry.r_addend );
+    }
+};
+
+//------------------------------------------------------------------------------
+template <> struct table_entry_traits<Elf32_Sym>
+{
+    //! Sizes of the fields in declaration order
+    static constexpr unsigned char fields[] = { 4, 4, 4, 1, 1, 2 };
+
+    template <class C> static void convert( Elf32_Sym& entry, const C& conv )
+    {
+        entry.st_name  = conv( entry.st_name );
+        entry.st_value = conv( entry.st_value );
+        entry.st_size  = conv( entry.st_size );
+        entry.st_shndx = conv( entry.st_shndx );
+    }
+};
+
+//------------------------------------------------------------------------------
+template <> struct table_entry_traits<Elf64_Sym>
+{
+    //! Sizes of the fields in declaration order
+    static constexpr unsigned char fields[] = { 4, 1, 1, 2, 8, 8 };
+
+    template <class C> static void convert( Elf64_Sym& entry, const C& conv )
+    {
+        entry.st_name  = conv( entry.st_name );
+        entry.st_shndx = conv( entry.st_shndx );
+        entry.st_value = conv( entry.st_value );
+        entry.st_size  = conv( entry.st_size );
+    }
+};
+
+//------------------------------------------------------------------------------
+template <> struct table_entry_traits<Elf32_Dyn>
+{
+    //! Sizes of the fields in declaration order
+    static constexpr unsigned char fields[] = { 4, 4 };
+
+    template <class C> static void convert( Elf32_Dyn& entry, const C& conv )
+    {
+        entry.d_tag      = conv( entry.d_tag );
+        entry.d_un.d_val = conv( entry.d_un.d_val );
+    }
+};
+
+//------------------------------------------------------------------------------
+template <> struct table_entry_traits<Elf64_Dyn>
+{
+    //! Sizes of the fields in declaration order
+    static constexpr unsigned char fields[] = { 8, 8 };
+
+    template <class C> static void convert( Elf64_Dyn& entry, const C& conv )
+    {
+        entry.d_tag      = conv( entry.d_tag );
+        entry.d_un.d_val = conv( entry.d_un.d_val );
+    }
+};
+
+//------------------------------------------------------------------------------
+//! \class table_entry_swapper
+//! \brief Reverses the byte order of the fields of packed table entries.
+//!
+//! Entries are processed in blocks of whole entries filling whole vectors.
+//! Fields are naturally aligned and never cross a 16 byte lane, so every
+//! lane is converted by one byte shuffle
+//! \tparam T Entry type with table_entry_traits
+template <class T> class table_entry_swapper
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Reverse the byte order of the entries
+    //! \param dst Destination of the converted entries. May be equal to src
+    //! \param src Entries to convert
+    //! \param count Number of entries
+    static void swap( void* dst, const void* src, size_t count )
+    {
+        auto*       d    = static_cast<char*>( dst );
+        const auto* s    = static_cast<const char*>( src );
+        size_t      done = 0;
+#if defined( ELFIO_HAS_X86_SHUFFLE )
+        static const int level = get_x86_level();
+        if ( level == 2 ) {
+            done = swap_avx2( d, s, count );
+        }
+        else if ( level == 1 ) {
+            done = swap_ssse3( d, s, count );
+        }
+#elif defined( ELFIO_HAS_NEON_SHUFFLE )
+        done = swap_neon( d, s, count );
+#endif
+        swap_portable( d + done * sizeof( T ), s + done * sizeof( T ),
+                       count - done );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Reverse the byte order of the entries one field at a time
+    //! \param dst Destination of the converted entries. May be equal to src
+    //! \param src Entries to convert
+    //! \param count Number of entries
+    static void swap_portable( void* dst, const void* src, size_t count )
+    {
+        static const endianness_convertor swapper = get_swapper();
+
+        auto*       d = static_cast<char*>( dst );
+        const auto* s = static_cast<const char*>( src );
+        for ( size_t i = 0; i < count; ++i ) {
+            T entry;
+            std::memcpy( &entry, s + i * sizeof( T ), sizeof( T ) );
+            table_entry_traits<T>::convert( entry, swapper );
+            std::memcpy( d + i * sizeof( T ), &entry, sizeof( T ) );
+        }
+    }
+
+  private:
+    //! Whole entries filling whole 32 byte vectors
+    static constexpr size_t block_size = std::lcm( sizeof( T ), size_t( 32 ) );
+
+    //------------------------------------------------------------------------------
+    //! \struct shuffle_masks
+    //! \brief Source byte of every byte of a block, relative to its lane
+    struct shuffle_masks
+    {
+        alignas( 32 ) unsigned char bytes[block_size];
+
+        shuffle_masks()
+        {
+            for ( size_t i = 0; i < block_size; ++i ) {
+                size_t offset = i % sizeof( T );
+                size_t start  = 0;
+                for ( unsigned char size : table_entry_traits<T>::fields ) {
+                    if ( offset < start + size ) {
+                        // Last byte of the field goes first
+                        size_t source = i - offset + start +
+                                        ( start + size - 1 - offset );
+                        size_t lane   = i & ~size_t( 15 );
+                        bytes[i]      = (unsigned char)( source - lane );
+                        break;
+                    }
+                    start += size;
+                }
+            }
+        }
+    };
+
+    //------------------------------------------------------------------------------
+    static endianness_convertor get_swapper()
+    {
+        const int           one = 1;
+        endianness_convertor swapper;
+        swapper.setup( *reinterpret_cast<const char*>( &one ) == 1
+                           ? ELFDATA2MSB
+                           : ELFDATA2LSB );
+        return swapper;
+    }
+
+#if defined( ELFIO_HAS_X86_SHUFFLE )
+    //------------------------------------------------------------------------------
+    //! \brief Get the best shuffle supported by the processor
+    //! \return 2 for AVX2, 1 for SSSE3, 0 for none
+    static int get_x86_level()
+    {
+        __builtin_cpu_init();
+        if ( __builtin_cpu_supports( "avx2" ) ) {
+            return 2;
+        }
+        return __builtin_cpu_supports( "ssse3" ) ? 1 : 0;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \return Number of entries converted
+    __attribute__( ( target( "avx2" ) ) ) static size_t
+    swap_avx2( char* dst, const char* src, size_t count )
+    {
+        static const shuffle_masks masks;
+
+        size_t blocks = count * sizeof( T ) / block_size;
+        for ( size_t i = 0; i < blocks * block_size; i += block_size ) {
+            for ( size_t j = 0; j < block_size; j += 32 ) {
+                __m256i value = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>( src + i + j ) );
+                __m256i mask = _mm256_load_si256(
+                    reinterpret_cast<const __m256i*>( masks.bytes + j ) );
+                _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i + j ),
+                                     _mm256_shuffle_epi8( value, mask ) );
+            }
+        }
+        return blocks * block_size / sizeof( T );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \return Number of entries converted
+    __attribute__( ( target( "ssse3" ) ) ) static size_t
+    swap_ssse3( char* dst, const char* src, size_t count )
+    {
+        static const shuffle_masks masks;
+
+        size_t blocks = count * sizeof( T ) / block_size;
+        for ( size_t i = 0; i < blocks * block_size; i += block_size ) {
+            for ( size_t j = 0; j < block_size; j += 16 ) {
+                __m128i value = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>( src + i + j ) );
+                __m128i mask = _mm_load_si128(
+                    reinterpret_cast<const __m128i*>( masks.bytes + j ) );
+                _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i + j ),
+                                  _mm_shuffle_epi8( value, mask ) );
+            }
+        }
+        return blocks * block_size / sizeof( T );
+    }
+#elif defined( ELFIO_HAS_NEON_SHUFFLE )
+    //------------------------------------------------------------------------------
+    //! \return Number of entries converted
+    static size_t swap_neon( char* dst, const char* src, size_t count )
+    {
+        static const shuffle_masks masks;
+
+        size_t blocks = count * sizeof( T ) / block_size;
+        for ( size_t i = 0; i < blocks * block_size; i += block_size ) {
+            for ( size_t j = 0; j < block_size; j += 16 ) {
+                uint8x16_t value = vld1q_u8(
+                    reinterpret_cast<const uint8_t*>( src + i + j ) );
+                uint8x16_t mask = vld1q_u8( masks.bytes + j );
+                vst1q_u8( reinterpret_cast<uint8_t*>( dst + i + j ),
+                          vqtbl1q_u8( value, mask ) );
+            }
+        }
+        return blocks * block_size / sizeof( T );
+    }
+#endif
+};
+
+//------------------------------------------------------------------------------
+//! \class table_view
+//! \brief Read-only random access view of the entries of a table section.
+//!
+//! The entries are decoded to the host byte order on access, and the data
+//! is not copied. The section data has to stay loaded while the view is
+//! used; keep a data_pin of the section when a data cache is set.
+//! The iterators are proxy iterators, like those of std::vector<bool>:
+//! they return the entries by value, so the view works with
+//! the non-modifying standard algorithms but can't be written through
+//! \tparam T Entry type, one of Elf32_Rel, Elf32_Rela, Elf64_Rel, Elf64_Rela,
+//!           Elf32_Sym, Elf64_Sym, Elf32_Dyn or Elf64_Dyn
+//! \tparam C Endianness convertor type, endianness_convertor or
+//!           static_endianness_convertor
+template <class T, class C = endianness_convertor> class table_view
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \class const_iterator
+    //! \brief Random access proxy iterator. Dereferencing decodes the entry
+    //!        and returns it by value instead of a reference, so reference
+    //!        is T and operator-> returns the decoded entry wrapped in
+    //!        arrow_proxy. Algorithms needing only the iterator arithmetic,
+    //!        e.g. std::lower_bound and std::distance, stay O(log n) and
+    //!        O(1). Algorithms writing through the iterators are not supported
+    class const_iterator
+    {
+      public:
+        //------------------------------------------------------------------------------
+        //! \brief Holds a decoded entry for operator->
+        struct arrow_proxy
+        {
+            T        entry; //!< The decoded entry
+            const T* operator->() const { return &entry; }
+        };
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = arrow_proxy;
+        using reference         = T;
+
+        const_iterator() = default;
+        const_iterator( const table_view* view, Elf_Xword index )
+            : view( view ), index( index )
+        {
+        }
+
+        T           operator*() const { return ( *view )[index]; }
+        arrow_proxy operator->() const { return { ( *view )[index] }; }
+        T operator[]( difference_type n ) const
+        {
+            return ( *view )[index + n];
+        }
+
+        const_iterator& operator++()
+        {
+            ++index;
+            return *this;
+        }
+        const_iterator operator++( int )
+        {
+            const_iterator tmp = *this;
+            ++index;
+            return tmp;
+        }
+        const_iterator& operator--()
+        {
+            --index;
+            return *this;
+        }
+        const_iterator operator--( int )
+        {
+            const_iterator tmp = *this;
+            --index;
+            return tmp;
+        }
+        const_iterator& operator+=( difference_type n )
+        {
+            index += n;
+            return *this;
+        }
+        const_iterator& operator-=( difference_type n )
+        {
+            index -= n;
+            return *this;
+        }
+        const_iterator operator+( difference_type n ) const
+        {
+            return const_iterator( view, index + n );
+        }
+        friend const_iterator operator+( difference_type       n,
+                                         const const_iterator& it )
+        {
+            return it + n;
+        }
+        const_iterator operator-( difference_type n ) const
+        {
+            return const_iterator( view, index - n );
+        }
+        difference_type operator-( const const_iterator& other ) const
+        {
+            return difference_type( index - other.index );
+        }
+
+        bool operator==( const const_iterator& other ) const
+        {
+            return index == other.index;
+        }
+        bool operator!=( const const_iterator& other ) const
+        {
+            return index != other.index;
+        }
+        bool operator<( const const_iterator& other ) const
+        {
+            return index < other.index;
+        }
+        bool operator>( const const_iterator& other ) const
+        {
+            return index > other.index;
+        }
+        bool operator<=( const const_iterator& other ) const
+        {
+            return index <= other.index;
+        }
+        bool operator>=( const const_iterator& other ) const
+        {
+            return index >= other.index;
+        }
+
+      private:
+        const table_view* view  = nullptr; //!< The view iterated
+        Elf_Xword         index = 0;       //!< Index of the entry
+    };
+
+    using value_type = T;
+    using size_type  = Elf_Xword;
+    using iterator   = const_iterator;
+
+    //------------------------------------------------------------------------------
+    //! \brief Create an empty view
+    table_view() = default;
+
+    //------------------------------------------------------------------------------
+    //! \brief Create a view of raw table data
+    //! \param data Pointer to the table data
+    //! \param size Size of the table data
+    //! \param entry_size Distance between the entries. Tables with entries
+    //!                   smaller than T give an empty view
+    //! \param convertor Endianness convertor of the file
+    table_view( const char* data,
+                Elf_Xword   size,
+                Elf_Xword   entry_size,
+                const C&    convertor )
+        : data( data ), entry_size( entry_size ), convertor( convertor )
+    {
+        if ( data != nullptr && entry_size >= sizeof( T ) ) {
+            entries_num = size / entry_size;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Create a view of a section. The entry size of the section is used
+    //! \param sec The table section
+    //! \param convertor Endianness convertor of the file
+    table_view( const section* sec, const C& convertor )
+        : table_view( sec != nullptr ? sec->get_data() : nullptr,
+                      sec != nullptr ? sec->get_size() : 0,
+                      sec != nullptr ? sec->get_entry_size() : 0,
+                      convertor )
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the number of entries
+    //! \return Number of entries
+    Elf_Xword size() const { return entries_num; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether the view has no entries
+    //! \return True if empty, false otherwise
+    bool empty() const { return entries_num == 0; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the distance between the entries
+    //! \return Entry size
+    Elf_Xword get_entry_size() const { return entry_size; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get an entry. The index is not checked
+    //! \param index Index of the entry
+    //! \return The entry in the host byte order
+    T operator[]( Elf_Xword index ) const
+    {
+        T entry;
+        std::memcpy( &entry, data + index * entry_size, sizeof( T ) );
+        if ( !is_native() ) {
+            table_entry_traits<T>::convert( entry, convertor );
+        }
+        return entry;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the first entry. The view must not be empty
+    //! \return The entry in the host byte order
+    T front() const { return ( *this )[0]; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the last entry. The view must not be empty
+    //! \return The entry in the host byte order
+    T back() const { return ( *this )[entries_num - 1]; }
+
+    //------------------------------------------------------------------------------
+    const_iterator begin() const { return const_iterator( this, 0 ); }
+    const_iterator end() const { return const_iterator( this, entries_num ); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Copy all entries in the host byte order. Packed tables of
+    //!        the other byte order are converted in bulk
+    //! \param entries Receives the entries
+    void copy_to( std::vector<T>& entries ) const
+    {
+        entries.resize( entries_num );
+        if ( entry_size != sizeof( T ) ) {
+            std::copy( begin(), end(), entries.begin() );
+        }
+        else if ( is_native() ) {
+            std::memcpy( entries.data(), data, entries_num * sizeof( T ) );
+        }
+        else {
+            table_entry_swapper<T>::swap( entries.data(), data, entries_num );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether the table is in the host byte order
+    //! \return True if no conversion is needed, false otherwise
+    bool is_native() const { return !convertor.is_conversion_needed(); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the entries as a plain array. Available when the table is in
+    //!        the host byte order, the entries are packed and aligned
+    //! \return Pointer to the first entry, nullptr if not available
+    const T* native_data() const
+    {
+        if ( empty() || !is_native() || entry_size != sizeof( T ) ||
+             reinterpret_cast<std::uintptr_t>( data ) % alignof( T ) != 0 ) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T*>( data );
+    }
+
+  private:
+    const char* data        = nullptr; //!< Table data
+    Elf_Xword   entry_size  = 0;       //!< Distance between the entries
+    Elf_Xword   entries_num = 0;       //!< Number of entries
+    C           convertor;             //!< Endianness convertor of the file
+};
+
+//------------------------------------------------------------------------------
+//! \brief Create a view of a table section of an ELF file
+//! \param elf_file The ELF file
+//! \param sec The table section
+//! \return The view
+template <class T>
+table_view<T> make_table_view( const elfio& elf_file, const section* sec )
+{
+    return table_view<T>( sec, *elf_file.get_convertor() );
+}
+
+//------------------------------------------------------------------------------
+//! \class static_symbol_section_accessor
+//! \brief Reads the symbols of files whose class and encoding are known at
+//!        compile time.
+//!
+//! The symbol table and its string table are located once on construction.
+//! The entry layout and the byte order are fixed by the template arguments,
+//! so reading a symbol needs neither class checks, nor run time byte order
+//! checks, nor calls through the section interface. Files of another class
+//! or encoding give an empty accessor. Both sections are pinned while
+//! the accessor exists. Symbol names refer to the string table data and
+//! stay valid while the accessor exists and the data is not changed or freed
+//! \tparam Class ELFCLASS32 or ELFCLASS64
+//! \tparam Encoding ELFDATA2LSB or ELFDATA2MSB
+template <unsigned char Class, unsigned char Encoding>
+class static_symbol_section_accessor
+{
+  public:
+    using symbol_type =
+        std::conditional_t<Class == ELFCLASS64, Elf64_Sym, Elf32_Sym>;
+    using convertor_type = static_endianness_convertor<Encoding>;
+    using view_type      = table_view<symbol_type, convertor_type>;
+
+    //------------------------------------------------------------------------------
+    //! \brief Constructor
+    //! \param elf_file Reference to the ELF file
+    //! \param symbol_section Pointer to the symbol table section
+    static_symbol_section_accessor( const elfio&   elf_file,
+                                    const section* symbol_section )
+    {
+        if ( symbol_section == nullptr || elf_file.get_class() != Class ||
+             elf_file.get_encoding() != Encoding ) {
+            return;
+        }
+
+        symbols_pin = data_pin<section>( symbol_section );
+        symbols     = view_type( symbol_section, convertor_type() );
+
+        const section* strings =
+            elf_file.sections[(Elf_Half)symbol_section->get_link()];
+        strings_pin = data_pin<section>( strings );
+        if ( strings_pin.get() != nullptr ) {
+            strings_data = strings_pin.get();
+            strings_size = strings->get_size();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the number of symbols
+    //! \return Number of symbols
+    Elf_Xword get_symbols_num() const { return symbols.size(); }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the view of the symbol table entries
+    //! \return The view
+    const view_type& get_symbols() const { return symbols; }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get a symbol by its index
+    //! \param index Index of the symbol
+    //! \param name Name of the symbol
+    //! \param value Value of the symbol
+    //! \param size Size of the symbol
+    //! \param bind Binding of the symbol
+    //! \param type Type of the symbol
+    //! \param section_index Section index of the symbol
+    //! \param other Other attributes of the symbol
+    //! \return True if the symbol exists, false otherwise
+    bool get_symbol( Elf_Xword         index,
+                     std::string_view& name,
+                     Elf64_Addr&       value,
+                     Elf_Xword&        size,
+                     unsigned char&    bind,
+                     unsigned char&    type,
+                     Elf_Half&         section_index,
+                     unsigned char&    other ) const
+    {
+        if ( index >= symbols.size() ) {
+            return false;
+        }
+
+        symbol_type sym = symbols[index];
+        name            = get_name( sym.st_name );
+        value           = sym.st_value;
+        size            = sym.st_size;
+        bind            = ELF_ST_BIND( sym.st_info );
+        type            = ELF_ST_TYPE( sym.st_info );
+        section_index   = sym.st_shndx;
+        other           = sym.st_other;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get a string of the string table of the symbols
+    //! \param offset Offset of the string
+    //! \return The string, empty if the offset is out of the table
+    std::string_view get_name( Elf_Word offset ) const
+    {
+        if ( offset >= strings_size ) {
+            return std::string_view();
+        }
+
+        const char* str = strings_data + offset;
+        const void* end = std::memchr( str, '\0', strings_size - offset );
+        if ( end == nullptr ) {
+            return std::string_view();
+        }
+        return std::string_view(
+            str, size_t( static_cast<const char*>( end ) - str ) );
+    }
+
+  private:
+    data_pin<section> symbols_pin; //!< Pin of the symbol table
+    data_pin<section> strings_pin; //!< Pin of the string table
+    view_type   symbols;                //!< Entries of the symbol table
+    const char* strings_data = nullptr; //!< String table data
+    Elf_Xword   strings_size = 0;       //!< Size of the string table
+};
+
+} // namespace ELFIO
+
+#endif // ELFIO_TABLE_VIEW_HPP
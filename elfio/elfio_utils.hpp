@@ -26,6 +26,12 @@ THE SOFTWARE.
 #include <cstdint>
 #include <ostream>
 #include <cstring>
+#include <atomic>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <mutex>
+#include <type_traits>
 
 #define ELFIO_GET_ACCESS_DECL( TYPE, NAME ) virtual TYPE get_##NAME() const = 0
 
@@ -69,6 +75,11 @@ class endianness_convertor
         need_conversion = ( elf_file_encoding != get_host_encoding() );
     }
 
+    //------------------------------------------------------------------------------
+    //! \brief Check whether the values are converted
+    //! \return True if the file encoding differs from the host one
+    bool is_conversion_needed() const { return need_conversion; }
+
     //------------------------------------------------------------------------------
     //! \brief Convert a 64-bit unsigned integer
     //! \param value The value to convert
@@ -189,6 +200,64 @@ class endianness_convertor
     bool need_conversion = false; //!< Flag indicating if conversion is needed
 };
 
+//------------------------------------------------------------------------------
+//! \class static_endianness_convertor
+//! \brief Endianness convertor for an encoding known at compile time.
+//!
+//! It converts values like endianness_convertor, but the decision whether
+//! to convert is made by the compiler. The host encoding is taken from
+//! __BYTE_ORDER__ where the compiler defines it, otherwise the host is
+//! assumed to be little endian
+//! \tparam Encoding The encoding of the ELF file
+template <unsigned char Encoding> class static_endianness_convertor
+{
+  public:
+#if defined( __BYTE_ORDER__ ) && defined( __ORDER_BIG_ENDIAN__ ) &&           \
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static constexpr unsigned char host_encoding = ELFDATA2MSB;
+#else
+    static constexpr unsigned char host_encoding = ELFDATA2LSB;
+#endif
+
+    //------------------------------------------------------------------------------
+    //! \brief Check whether the values are converted
+    //! \return True if the file encoding differs from the host one
+    static constexpr bool is_conversion_needed()
+    {
+        return Encoding != host_encoding;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Convert an integer
+    //! \param value The value to convert
+    //! \return The converted value
+    template <class T> T operator()( T value ) const
+    {
+        static_assert( std::is_integral<T>::value,
+                       "Only integers are converted" );
+        if constexpr ( !is_conversion_needed() || sizeof( T ) == 1 ) {
+            return value;
+        }
+        else if constexpr ( sizeof( T ) == 2 ) {
+            auto v = std::uint16_t( value );
+            return T( std::uint16_t( ( v << 8 ) | ( v >> 8 ) ) );
+        }
+        else if constexpr ( sizeof( T ) == 4 ) {
+            auto v = std::uint32_t( value );
+            v      = ( ( v & 0x00FF00FF ) << 8 ) | ( ( v >> 8 ) & 0x00FF00FF );
+            return T( ( v << 16 ) | ( v >> 16 ) );
+        }
+        else {
+            auto v = std::uint64_t( value );
+            v      = ( ( v & 0x00FF00FF00FF00FFuLL ) << 8 ) |
+                ( ( v >> 8 ) & 0x00FF00FF00FF00FFuLL );
+            v = ( ( v & 0x0000FFFF0000FFFFuLL ) << 16 ) |
+                ( ( v >> 16 ) & 0x0000FFFF0000FFFFuLL );
+            return T( ( v << 32 ) | ( v >> 32 ) );
+        }
+    }
+};
+
 //------------------------------------------------------------------------------
 //! \struct address_translation
 //! \brief Structure for address translation
@@ -214,6 +283,22 @@ struct address_translation
 class address_translator
 {
   public:
+    //------------------------------------------------------------------------------
+    address_translator() = default;
+    address_translator( const address_translator& other )
+        : addr_translations( other.addr_translations ),
+          max_ends( other.max_ends ), is_disjoint( other.is_disjoint )
+    {
+    }
+    address_translator& operator=( const address_translator& other )
+    {
+        addr_translations = other.addr_translations;
+        max_ends          = other.max_ends;
+        is_disjoint       = other.is_disjoint;
+        last_hit          = 0;
+        return *this;
+    }
+
     //------------------------------------------------------------------------------
     //! \brief Set address translation
     //! \param addr_trans Vector of address translations
@@ -221,11 +306,27 @@ class address_translator
     {
         addr_translations = addr_trans;
 
-        std::sort( addr_translations.begin(), addr_translations.end(),
-                   []( const address_translation& a,
-                       const address_translation& b ) -> bool {
-                       return a.start < b.start;
-                   } );
+        std::stable_sort( addr_translations.begin(), addr_translations.end(),
+                          []( const address_translation& a,
+                              const address_translation& b ) -> bool {
+                              return a.start < b.start;
+                          } );
+
+        // Running maximum of the range ends allows to stop the backward
+        // search as soon as no earlier range can contain the address
+        max_ends.clear();
+        is_disjoint = true;
+
+        std::streamoff max_end = 0;
+        for ( const auto& t : addr_translations ) {
+            if ( std::streamoff( t.start ) < max_end ) {
+                is_disjoint = false;
+            }
+            max_end = std::max( max_end, std::streamoff( t.start ) +
+                                             std::streamoff( t.size ) );
+            max_ends.push_back( max_end );
+        }
+        last_hit = 0;
     }
 
     //------------------------------------------------------------------------------
@@ -238,12 +339,38 @@ class address_translator
             return value;
         }
 
-        for ( auto& t : addr_translations ) {
+        // Consecutive reads usually hit the same range
+        if ( is_disjoint ) {
+            const auto& t = addr_translations[last_hit.load(
+                std::memory_order_relaxed )];
             if ( ( t.start <= value ) && ( ( value - t.start ) < t.size ) ) {
                 return value - t.start + t.mapped_to;
             }
         }
 
+        // The first range (in the order of the start addresses) containing
+        // the value is used
+        auto it = std::upper_bound( addr_translations.begin(),
+                                    addr_translations.end(), value,
+                                    []( std::streampos v,
+                                        const address_translation& t ) {
+                                        return v < t.start;
+                                    } );
+        size_t found = addr_translations.size();
+        for ( auto i = size_t( it - addr_translations.begin() );
+              i > 0 && max_ends[i - 1] > std::streamoff( value ); --i ) {
+            const auto& t = addr_translations[i - 1];
+            if ( ( value - t.start ) < t.size ) {
+                found = i - 1;
+            }
+        }
+
+        if ( found != addr_translations.size() ) {
+            last_hit.store( found, std::memory_order_relaxed );
+            const auto& t = addr_translations[found];
+            return value - t.start + t.mapped_to;
+        }
+
         return value;
     }
 
@@ -255,6 +382,34 @@ class address_translator
   private:
     std::vector<address_translation>
         addr_translations; //!< Vector of address translations
+    std::vector<std::streamoff>
+        max_ends; //!< Highest range end up to each range
+    bool is_disjoint = true; //!< Whether no ranges overlap
+    mutable std::atomic<size_t> last_hit{ 0 }; //!< Range of the last hit
+};
+
+class mapped_file;
+class positional_file;
+class data_cache;
+
+//------------------------------------------------------------------------------
+//! \struct load_context
+//! \brief Parameters shared by all sections and segments of a single load
+struct load_context
+{
+    std::istream* stream      = nullptr; //!< Input stream the file is read from
+    size_t        stream_size = 0;       //!< Size of the input stream
+    bool          is_lazy     = false;   //!< Whether the data is loaded lazily
+    bool          is_deferred = false;   //!< Whether the section data is
+                                         //!< loaded after all headers
+    std::shared_ptr<const mapped_file>
+        mapping; //!< Memory mapping of the file, if loaded by load_mapped()
+    std::shared_ptr<const positional_file>
+        file; //!< File for concurrent reads of the section data, if any
+    std::shared_ptr<std::mutex>
+        stream_mutex; //!< Lock of the stream position for lazy loads
+    std::shared_ptr<data_cache>
+        cache; //!< Cache of the data loaded on demand, if any
 };
 
 //------------------------------------------------------------------------------
@@ -322,6 +477,169 @@ inline void adjust_stream_size( std::ostream& stream, std::streamsize offset )
     stream.seekp( offset );
 }
 
+//------------------------------------------------------------------------------
+//! \brief Call a function for every index of a range using several threads
+//!
+//! The calling thread is one of the workers. Fewer threads are used when
+//! the system cannot start more of them
+//! \param count Number of indices. The function is called for [0, count)
+//! \param threads_num Maximal number of threads
+//! \param func The function to call. It has to be safe to call it
+//!             concurrently for different indices
+inline void parallel_for( size_t                               count,
+                          unsigned                             threads_num,
+                          const std::function<void( size_t )>& func )
+{
+    std::atomic<size_t> next{ 0 };
+    auto                worker = [&]() {
+        for ( size_t i = next++; i < count; i = next++ ) {
+            func( i );
+        }
+    };
+
+    std::vector<std::thread> workers;
+    size_t threads = std::min<size_t>( threads_num, count );
+    for ( size_t i = 1; i < threads; ++i ) {
+        try {
+            workers.emplace_back( worker );
+        }
+        catch ( const std::system_error& ) {
+            break;
+        }
+    }
+
+    worker();
+    for ( auto& thread : workers ) {
+        thread.join();
+    }
+}
+
+//------------------------------------------------------------------------------
+//! \class output_chunks
+//! \brief Ordered list of file blocks written in one sequential pass
+//!
+//! The blocks are collected with their final file offsets first. write()
+//! emits them in offset order and fills the gaps with zeros, so the output
+//! stream is never repositioned
+class output_chunks
+{
+  public:
+    //------------------------------------------------------------------------------
+    //! \brief Add a block referring to memory owned by the caller
+    //! \param offset The file offset of the block
+    //! \param data Pointer to the block data. It must stay valid until write()
+    //! \param size Size of the block
+    void add( Elf64_Off offset, const char* data, Elf_Xword size )
+    {
+        if ( size != 0 ) {
+            chunks.push_back( { offset, data, size } );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Add a block taking ownership of its data
+    //! \param offset The file offset of the block
+    //! \param data The block data
+    //! \param size Size of the block
+    void add( Elf64_Off offset, std::unique_ptr<char[]> data, Elf_Xword size )
+    {
+        add( offset, data.get(), size );
+        owned.emplace_back( std::move( data ) );
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Sort the blocks by their offsets
+    //! \return False if some blocks overlap, true otherwise
+    bool sort()
+    {
+        std::stable_sort( chunks.begin(), chunks.end(),
+                          []( const chunk& a, const chunk& b ) {
+                              return a.offset < b.offset;
+                          } );
+
+        Elf64_Off end = 0;
+        for ( const auto& c : chunks ) {
+            if ( c.offset < end || c.offset + c.size < c.offset ) {
+                return false;
+            }
+            end = c.offset + c.size;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Write the sorted blocks starting at the stream's beginning
+    //! \param stream The output stream positioned at the file start
+    //! \return True if successful, false otherwise
+    bool write( std::ostream& stream ) const
+    {
+        static const char zeros[4096] = {};
+
+        Elf64_Off pos = 0;
+        for ( const auto& c : chunks ) {
+            while ( pos < c.offset && stream.good() ) {
+                Elf64_Off gap = std::min<Elf64_Off>( c.offset - pos,
+                                                     sizeof( zeros ) );
+                stream.write( zeros, std::streamsize( gap ) );
+                pos += gap;
+            }
+            stream.write( c.data, std::streamsize( c.size ) );
+            pos += c.size;
+        }
+
+        return stream.good();
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Overwrite the blocks at their offsets leaving the rest of
+    //!        the stream unchanged
+    //! \param stream The output stream
+    //! \return True if successful, false otherwise
+    bool write_in_place( std::ostream& stream ) const
+    {
+        for ( const auto& c : chunks ) {
+            if ( !stream.seekp( std::streamoff( c.offset ) ) ) {
+                return false;
+            }
+            stream.write( c.data, std::streamsize( c.size ) );
+        }
+
+        return stream.good();
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Get the total size of the blocks
+    //! \return Number of bytes to be written
+    Elf_Xword get_size() const
+    {
+        Elf_Xword size = 0;
+        for ( const auto& c : chunks ) {
+            size += c.size;
+        }
+        return size;
+    }
+
+    //------------------------------------------------------------------------------
+    //! \brief Remove all blocks
+    void clear()
+    {
+        chunks.clear();
+        owned.clear();
+    }
+
+  private:
+    struct chunk
+    {
+        Elf64_Off   offset; //!< File offset of the block
+        const char* data;   //!< Block data
+        Elf_Xword   size;   //!< Block size
+    };
+
+    std::vector<chunk>                   chunks; //!< Blocks to be written
+    std::vector<std::unique_ptr<char[]>> owned;  //!< Data owned by the list
+};
+
 //------------------------------------------------------------------------------
 //! \brief Get the length of a string with a maximum length
 //! \param s The string
@@ -341,6 +659,11 @@ class compression_interface
   public:
     virtual ~compression_interface() = default;
 
+    //------------------------------------------------------------------------------
+    //! \brief Setup the compression for the class of the processed ELF file
+    //! \param file_class The class of the ELF file (ELFCLASS32 or ELFCLASS64)
+    virtual void setup( unsigned char file_class ) { (void)file_class; }
+
     //------------------------------------------------------------------------------
     //! \brief Decompress a compressed section
     //! \param data The buffer of compressed data
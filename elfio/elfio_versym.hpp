@@ -78,6 +78,8 @@ template <class S> class versym_section_accessor_template
     {
         if ( versym_section && ( no < get_entries_num() ) ) {
             ( (Elf_Half*)versym_section->get_data() )[no] = value;
+            versym_section->mark_data_modified( no * sizeof( Elf_Half ),
+                                                sizeof( Elf_Half ) );
             return true;
         }
 
@@ -44,33 +44,24 @@ diff before.txt after.txt
 
 #include <string>
 #include <iostream>
-#include <fstream>
+#include <algorithm>
 #include <elfio/elfio.hpp>
 
 using namespace ELFIO;
 
-void overwrite_data( const std::string& filename,
-                     Elf64_Off          offset,
-                     const std::string& str )
-{
-    std::ofstream file( filename,
-                        std::ios::in | std::ios::out | std::ios::binary );
-    if ( !file )
-        throw "Error opening file" + filename;
-    std::string data( str.length(), '-' );
-    file.seekp( (std::streampos)offset );
-    file.write( data.c_str(), data.length() + 1 );
-}
-
-void process_string_table( const section* s, const std::string& filename )
+void process_string_table( section* s )
 {
     std::cout << "Info: processing string table section" << std::endl;
+    // The data is changed in place. The section size remains the same
+    char*  data  = const_cast<char*>( s->get_data() );
     size_t index = 1;
     while ( index < s->get_size() ) {
-        auto str = std::string( s->get_data() + index );
+        auto str = std::string( data + index );
         // For the example purpose, we rename main function name only
-        if ( str == "main" )
-            overwrite_data( filename, s->get_offset() + index, str );
+        if ( str == "main" ) {
+            std::fill_n( data + index, str.length(), '-' );
+            s->mark_data_modified( index, str.length() );
+        }
         index += str.length() + 1;
     }
 }
@@ -95,8 +86,15 @@ int main( int argc, char** argv )
     for ( const auto& section : reader.sections ) {
         if ( section->get_type() == SHT_STRTAB &&
              std::string( section->get_name() ) == std::string( ".strtab" ) ) {
-            process_string_table( section.get(), filename );
+            process_string_table( section.get() );
         }
     }
+
+    // Only the modified parts of the file are written
+    if ( !reader.save_in_place( filename ) ) {
+        std::cerr << "File " << filename << " cannot be updated\n";
+        return 1;
+    }
+
     return 0;
 }
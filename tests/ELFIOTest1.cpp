@@ -501,6 +501,373 @@ TEST( ELFIOTest, get_symbol_64 )
     EXPECT_EQ( 21, size );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, get_symbol_address_index )
+{
+    for ( const std::string in :
+          { "elf_examples/hello_32", "elf_examples/hello_64",
+            "elf_examples/test_ppc", "elf_examples/hello_arm" } ) {
+        elfio elf;
+        ASSERT_EQ( elf.load( in ), true );
+        section* psymsec = elf.sections[".symtab"];
+        ASSERT_NE( psymsec, nullptr );
+
+        const symbol_section_accessor linear( elf, psymsec );
+        symbol_section_accessor       indexed( elf, psymsec );
+        indexed.build_address_index();
+
+        for ( Elf_Xword i = 0; i < linear.get_symbols_num(); ++i ) {
+            std::string   name;
+            Elf64_Addr    value;
+            Elf_Xword     size;
+            unsigned char bind;
+            unsigned char type;
+            Elf_Half      section_index;
+            unsigned char other;
+            ASSERT_EQ( linear.get_symbol( i, name, value, size, bind, type,
+                                          section_index, other ),
+                       true );
+
+            // Exact lookup returns the first symbol with the value
+            std::string name1;
+            std::string name2;
+            Elf_Xword   size1 = 0;
+            Elf_Xword   size2 = 0;
+            EXPECT_EQ( linear.get_symbol( value, name1, size1, bind, type,
+                                          section_index, other ),
+                       indexed.get_symbol( value, name2, size2, bind, type,
+                                           section_index, other ) );
+            EXPECT_EQ( name1, name2 );
+            EXPECT_EQ( size1, size2 );
+
+            // Containing lookup with and without the index
+            for ( Elf64_Addr address : { value, value + size / 2,
+                                         value + size - 1, value + size } ) {
+                Elf_Xword index1 = 0;
+                Elf_Xword index2 = 0;
+                const symbol_section_accessor not_indexed( elf, psymsec );
+                bool found1 =
+                    not_indexed.find_symbol_containing( address, index1 );
+                bool found2 = indexed.find_symbol_containing( address, index2 );
+                EXPECT_EQ( found1, found2 ) << in << " " << address;
+                EXPECT_EQ( index1, index2 ) << in << " " << address;
+                if ( size != 0 && address < value + size ) {
+                    EXPECT_TRUE( found2 );
+                }
+            }
+        }
+    }
+
+    elfio elf;
+    ASSERT_EQ( elf.load( "elf_examples/hello_64" ), true );
+    symbol_section_accessor symbols( elf, elf.sections[".symtab"] );
+    symbols.build_address_index();
+    Elf_Xword index = 0;
+    ASSERT_EQ( symbols.find_symbol_containing( 0x00400498 + 20, index ), true );
+    std::string   name;
+    Elf64_Addr    value;
+    Elf_Xword     size;
+    unsigned char bind;
+    unsigned char type;
+    Elf_Half      section_index;
+    unsigned char other;
+    symbols.get_symbol( index, name, value, size, bind, type, section_index,
+                        other );
+    EXPECT_EQ( "main", name );
+    EXPECT_EQ( symbols.find_symbol_containing( 0x00400498 + 21, index ) &&
+                   index == 0,
+               false );
+
+    // Added symbols are visible after the index is discarded
+    symbols.add_symbol( 0, 0x7000000, 16, STB_GLOBAL, STT_FUNC, 0, 1 );
+    ASSERT_EQ( symbols.find_symbol_containing( 0x7000008, index ), true );
+    EXPECT_EQ( index, symbols.get_symbols_num() - 1 );
+
+    // Large spans, nested and duplicated symbols agree with the linear scan
+    elfio writer;
+    writer.create( ELFCLASS64, ELFDATA2LSB );
+    section* symtab = writer.sections.add( ".symtab" );
+    symtab->set_type( SHT_SYMTAB );
+    symtab->set_entry_size( writer.get_default_entry_size( SHT_SYMTAB ) );
+    symbol_section_accessor spans( writer, symtab );
+    spans.add_symbol( 0, 0, 0, STB_LOCAL, STT_NOTYPE, 0, 0 );
+    spans.add_symbol( 0, 0x1000, 0x100000, STB_GLOBAL, STT_OBJECT, 0, 1 );
+    spans.add_symbol( 0, 0x1000, 0x100000, STB_GLOBAL, STT_OBJECT, 0, 1 );
+    spans.add_symbol( 0, 0x80000, 0x80000, STB_GLOBAL, STT_OBJECT, 0, 1 );
+    spans.add_symbol( 0, 0x10, ~Elf_Xword( 0 ), STB_GLOBAL, STT_OBJECT, 0, 1 );
+    std::uint32_t seed = 1;
+    for ( int i = 0; i < 500; ++i ) {
+        seed = seed * 1103515245 + 12345;
+        Elf64_Addr value = ( seed >> 8 ) % 0x200000;
+        seed             = seed * 1103515245 + 12345;
+        Elf_Xword size   = ( seed >> 8 ) % ( i % 50 == 0 ? 0x40000 : 0x40 );
+        spans.add_symbol( 0, value, size, STB_GLOBAL, STT_FUNC, 0, 1 );
+    }
+    const symbol_section_accessor linear_spans( writer, symtab );
+    spans.build_address_index();
+    for ( Elf64_Addr address = 0; address < 0x210000; address += 0x1f3 ) {
+        Elf_Xword index1 = 0;
+        Elf_Xword index2 = 0;
+        bool      found1 = linear_spans.find_symbol_containing( address, index1 );
+        bool      found2 = spans.find_symbol_containing( address, index2 );
+        ASSERT_EQ( found1, found2 ) << address;
+        EXPECT_EQ( index1, index2 ) << address;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, get_symbol_name_index )
+{
+    for ( const std::string in :
+          { "elf_examples/hello_32", "elf_examples/hello_64",
+            "elf_examples/test_ppc", "elf_examples/hello_arm" } ) {
+        elfio elf;
+        ASSERT_EQ( elf.load( in ), true );
+        section* psymsec = elf.sections[".symtab"];
+        ASSERT_NE( psymsec, nullptr );
+
+        const symbol_section_accessor linear( elf, psymsec );
+        symbol_section_accessor       indexed( elf, psymsec );
+        indexed.build_name_index();
+
+        for ( Elf_Xword i = 0; i < linear.get_symbols_num(); ++i ) {
+            std::string   name;
+            Elf64_Addr    value;
+            Elf_Xword     size;
+            unsigned char bind;
+            unsigned char type;
+            Elf_Half      section_index;
+            unsigned char other;
+            ASSERT_EQ( linear.get_symbol( i, name, value, size, bind, type,
+                                          section_index, other ),
+                       true );
+
+            Elf64_Addr value1 = 0;
+            Elf64_Addr value2 = 0;
+            Elf_Xword  size1  = 0;
+            Elf_Xword  size2  = 0;
+            EXPECT_EQ( linear.get_symbol( name, value1, size1, bind, type,
+                                          section_index, other ),
+                       true );
+            EXPECT_EQ( indexed.get_symbol( name, value2, size2, bind, type,
+                                           section_index, other ),
+                       true );
+            EXPECT_EQ( value1, value2 ) << in << " " << name;
+            EXPECT_EQ( size1, size2 ) << in << " " << name;
+        }
+
+        Elf64_Addr    value;
+        Elf_Xword     size;
+        unsigned char bind;
+        unsigned char type;
+        Elf_Half      section_index;
+        unsigned char other;
+        EXPECT_EQ( indexed.get_symbol( "no_such_symbol", value, size, bind,
+                                       type, section_index, other ),
+                   false );
+
+        // The index doesn't refer to the string table data, which is
+        // reallocated when the string table grows
+        std::string last_name;
+        ASSERT_EQ( linear.get_symbol( linear.get_symbols_num() - 1, last_name,
+                                      value, size, bind, type, section_index,
+                                      other ),
+                   true );
+        Elf64_Addr last_value = value;
+        string_section_accessor strings(
+            elf.sections[psymsec->get_link()] );
+        strings.add_string( std::string( 0x10000, 'x' ) );
+        value = 0;
+        EXPECT_EQ( indexed.get_symbol( last_name, value, size, bind, type,
+                                       section_index, other ),
+                   true );
+        EXPECT_EQ( value, last_value );
+
+        // Added symbols are found after the index is discarded
+        indexed.add_symbol( strings, "added_symbol", 0x1234, 8, STB_GLOBAL,
+                            STT_FUNC, 0, 1 );
+        EXPECT_EQ( indexed.get_symbol( "added_symbol", value, size, bind,
+                                       type, section_index, other ),
+                   true );
+        EXPECT_EQ( value, 0x1234 );
+        indexed.build_name_index();
+        value = 0;
+        EXPECT_EQ( indexed.get_symbol( "added_symbol", value, size, bind,
+                                       type, section_index, other ),
+                   true );
+        EXPECT_EQ( value, 0x1234 );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <class W> void check_gnu_hash_section( const elfio& elf )
+{
+    const section*                symsec  = elf.sections[".dynsym"];
+    const section*                hashsec = elf.sections[".gnu.hash.new"];
+    const_symbol_section_accessor symbols( elf, symsec );
+    const auto&                   conv = elf.get_convertor();
+    ASSERT_EQ( hashsec->get_type(), SHT_GNU_HASH );
+    ASSERT_EQ( hashsec->get_link(), symsec->get_index() );
+
+    const char* data = hashsec->get_data();
+    auto        word = [&]( size_t offset ) {
+        std::uint32_t value;
+        std::memcpy( &value, data + offset, sizeof( value ) );
+        return ( *conv )( value );
+    };
+    std::uint32_t nbuckets    = word( 0 );
+    std::uint32_t symoffset   = word( 4 );
+    std::uint32_t bloom_size  = word( 8 );
+    std::uint32_t bloom_shift = word( 12 );
+    Elf_Xword     count       = symbols.get_symbols_num();
+    size_t        buckets_pos = 16 + bloom_size * sizeof( W );
+    size_t        chains_pos  = buckets_pos + nbuckets * 4;
+    ASSERT_EQ( hashsec->get_size(), chains_pos + ( count - symoffset ) * 4 );
+    ASSERT_EQ( bloom_size & ( bloom_size - 1 ), 0 );
+
+    for ( Elf_Xword i = 1; i < count; ++i ) {
+        std::string   name;
+        Elf64_Addr    value;
+        Elf_Xword     size;
+        unsigned char bind;
+        unsigned char type;
+        Elf_Half      section_index;
+        unsigned char other;
+        symbols.get_symbol( i, name, value, size, bind, type, section_index,
+                            other );
+        bool is_hashed = bind != STB_LOCAL && section_index != SHN_UNDEF;
+        EXPECT_EQ( is_hashed, i >= symoffset ) << name;
+        if ( !is_hashed ) {
+            continue;
+        }
+
+        const auto* str = reinterpret_cast<const unsigned char*>( name.c_str() );
+        std::uint32_t hash = elf_gnu_hash( str );
+        const size_t  bits = 8 * sizeof( W );
+        W             bloom_word;
+        std::memcpy( &bloom_word,
+                     data + 16 +
+                         ( ( hash / bits ) % bloom_size ) * sizeof( W ),
+                     sizeof( W ) );
+        bloom_word = ( *conv )( bloom_word );
+        EXPECT_TRUE( ( bloom_word >> ( hash % bits ) ) & 1 );
+        EXPECT_TRUE( ( bloom_word >> ( ( hash >> bloom_shift ) % bits ) ) & 1 );
+
+        // The symbol is found in the chain of its bucket
+        std::uint32_t index = word( buckets_pos + ( hash % nbuckets ) * 4 );
+        ASSERT_GE( index, symoffset );
+        bool found = false;
+        while ( !found ) {
+            std::uint32_t chain =
+                word( chains_pos + ( index - symoffset ) * 4 );
+            found = index == i && ( chain | 1 ) == ( hash | 1 );
+            if ( chain & 1 ) {
+                break;
+            }
+            ++index;
+        }
+        EXPECT_TRUE( found ) << name;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, build_hash_sections )
+{
+    for ( const std::string in :
+          { "elf_examples/libfunc.so", "elf_examples/libfunc32.so" } ) {
+        elfio elf;
+        ASSERT_EQ( elf.load( in ), true );
+        section* symsec = elf.sections[".dynsym"];
+        ASSERT_NE( symsec, nullptr );
+
+        symbol_section_accessor symbols( elf, symsec );
+        std::vector<std::string> names;
+        for ( Elf_Xword i = 0; i < symbols.get_symbols_num(); ++i ) {
+            std::string   name;
+            Elf64_Addr    value;
+            Elf_Xword     size;
+            unsigned char bind;
+            unsigned char type;
+            Elf_Half      section_index;
+            unsigned char other;
+            symbols.get_symbol( i, name, value, size, bind, type,
+                                section_index, other );
+            names.push_back( name );
+        }
+
+        // Add an undefined symbol at the end, it has to be moved before the
+        // hashed symbols
+        string_section_accessor strings( elf.sections[symsec->get_link()] );
+        symbols.add_symbol( strings, "undefined_symbol", 0, 0, STB_GLOBAL,
+                            STT_FUNC, 0, SHN_UNDEF );
+        names.push_back( "undefined_symbol" );
+
+        section* gnu_hash = elf.sections.add( ".gnu.hash.new" );
+        ASSERT_EQ( symbols.build_gnu_hash_section(
+                       gnu_hash,
+                       [&]( Elf_Xword first, Elf_Xword second ) {
+                           std::swap( names[first], names[second] );
+                       } ),
+                   true );
+        if ( elf.get_class() == ELFCLASS64 ) {
+            check_gnu_hash_section<std::uint64_t>( elf );
+        }
+        else {
+            check_gnu_hash_section<std::uint32_t>( elf );
+        }
+
+        // The reported swaps describe the new order of the symbols
+        for ( Elf_Xword i = 0; i < symbols.get_symbols_num(); ++i ) {
+            std::string   name;
+            Elf64_Addr    value;
+            Elf_Xword     size;
+            unsigned char bind;
+            unsigned char type;
+            Elf_Half      section_index;
+            unsigned char other;
+            symbols.get_symbol( i, name, value, size, bind, type,
+                                section_index, other );
+            EXPECT_EQ( name, names[i] );
+        }
+
+        section* sysv_hash = elf.sections.add( ".hash.new" );
+        ASSERT_EQ( symbols.build_hash_section( sysv_hash ), true );
+        EXPECT_EQ( sysv_hash->get_type(), SHT_HASH );
+        EXPECT_EQ( sysv_hash->get_link(), symsec->get_index() );
+
+        const auto& conv = elf.get_convertor();
+        const char* data = sysv_hash->get_data();
+        auto        word = [&]( size_t index ) {
+            Elf_Word value;
+            std::memcpy( &value, data + index * 4, sizeof( value ) );
+            return ( *conv )( value );
+        };
+        Elf_Word nbucket = word( 0 );
+        ASSERT_EQ( word( 1 ), names.size() );
+        for ( Elf_Word i = 1; i < names.size(); ++i ) {
+            const auto* str =
+                reinterpret_cast<const unsigned char*>( names[i].c_str() );
+            Elf_Word y = word( 2 + elf_hash( str ) % nbucket );
+            while ( y != i && y != STN_UNDEF ) {
+                y = word( 2 + nbucket + y );
+            }
+            EXPECT_EQ( y, i ) << names[i];
+        }
+
+        // The accessor uses the generated tables for the lookups
+        Elf64_Addr    value;
+        Elf_Xword     size;
+        unsigned char bind;
+        unsigned char type;
+        Elf_Half      section_index;
+        unsigned char other;
+        EXPECT_EQ( symbols.get_symbol( "undefined_symbol", value, size, bind,
+                                       type, section_index, other ),
+                   true );
+        EXPECT_EQ( section_index, SHN_UNDEF );
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 TEST( ELFIOTest, null_section_inside_segment )
 {
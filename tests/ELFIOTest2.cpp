@@ -26,7 +26,11 @@ THE SOFTWARE.
 #endif
 
 #include <gtest/gtest.h>
+#include <thread>
 #include <elfio/elfio.hpp>
+#include <elfio/elfio_batch.hpp>
+#include <elfio/elfio_relocator.hpp>
+#include <elfio/elfio_table_view.hpp>
 
 using namespace ELFIO;
 
@@ -578,3 +582,1764 @@ TEST( ELFIOTest, address_translation_test )
     EXPECT_EQ( tr[2710], 2710 );
     EXPECT_EQ( tr[3710], 3710 );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, address_translation_lookup )
+{
+    std::vector<address_translation> ranges;
+    for ( std::uint64_t i = 10000; i > 0; --i ) {
+        ranges.emplace_back( i * 0x1000, 0x800, i * 0x10 );
+    }
+
+    address_translator tr;
+    tr.set_address_translation( ranges );
+
+    EXPECT_EQ( tr[0x1000], 0x10 );
+    EXPECT_EQ( tr[0x1010], 0x20 );
+    EXPECT_EQ( tr[0x1800], 0x1800 );
+    EXPECT_EQ( tr[0x2000 + 0x7FF], 0x20 + 0x7FF );
+    EXPECT_EQ( tr[0x2000 + 0x7FF], 0x20 + 0x7FF );
+    EXPECT_EQ( tr[0x2000 + 0x800], 0x2000 + 0x800 );
+    EXPECT_EQ( tr[10000 * 0x1000 + 5], 10000 * 0x10 + 5 );
+    EXPECT_EQ( tr[0x1000 + 5], 0x10 + 5 );
+    EXPECT_EQ( tr[10001 * 0x1000], 10001 * 0x1000 );
+
+    // Overlapping ranges: the range with the lowest start address wins
+    ranges.clear();
+    ranges.emplace_back( 100, 10, 5000 );
+    ranges.emplace_back( 0, 1000, 2000 );
+    ranges.emplace_back( 50, 10, 6000 );
+    tr.set_address_translation( ranges );
+
+    EXPECT_EQ( tr[55], 2055 );
+    EXPECT_EQ( tr[105], 2105 );
+    EXPECT_EQ( tr[999], 2999 );
+    EXPECT_EQ( tr[1000], 1000 );
+
+    address_translator copy( tr );
+    EXPECT_EQ( copy[105], 2105 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, load_mapped )
+{
+    const std::vector<std::string> files = { "elf_examples/hello_64",
+                                             "elf_examples/hello_32.o",
+                                             "elf_examples/test_ppc",
+                                             "elf_examples/libfunc.so" };
+
+    for ( const auto& file : files ) {
+        bool is_lazy = false;
+        do {
+            is_lazy = !is_lazy;
+
+            elfio r1;
+            elfio r2;
+            ASSERT_EQ( r1.load( file ), true );
+            ASSERT_EQ( r2.load_mapped( file, is_lazy ), true );
+            ASSERT_EQ( r1.sections.size(), r2.sections.size() );
+            ASSERT_EQ( r1.segments.size(), r2.segments.size() );
+
+            for ( Elf_Half i = 0; i < r1.sections.size(); ++i ) {
+                const section* s1 = r1.sections[i];
+                const section* s2 = r2.sections[i];
+                EXPECT_EQ( s1->get_name(), s2->get_name() );
+                ASSERT_EQ( s1->get_size(), s2->get_size() );
+                if ( s1->get_data() != nullptr && s1->get_size() != 0 ) {
+                    ASSERT_NE( s2->get_data(), nullptr );
+                    EXPECT_EQ( 0, std::memcmp( s1->get_data(), s2->get_data(),
+                                               size_t( s1->get_size() ) ) );
+                }
+            }
+
+            for ( Elf_Half i = 0; i < r1.segments.size(); ++i ) {
+                const segment* g1 = r1.segments[i];
+                const segment* g2 = r2.segments[i];
+                ASSERT_EQ( g1->get_file_size(), g2->get_file_size() );
+                EXPECT_EQ( g1->get_sections_num(), g2->get_sections_num() );
+                if ( g1->get_data() != nullptr ) {
+                    ASSERT_NE( g2->get_data(), nullptr );
+                    EXPECT_EQ( 0,
+                               std::memcmp( g1->get_data(), g2->get_data(),
+                                            size_t( g1->get_file_size() ) ) );
+                }
+            }
+        } while ( is_lazy );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, load_mapped_modify )
+{
+    const std::string in  = "elf_examples/hello_64";
+    const std::string out = "elf_examples/hello_64_mapped_copy";
+
+    elfio reader;
+    ASSERT_EQ( reader.load_mapped( in ), true );
+
+    section* comment = reader.sections[".comment"];
+    ASSERT_NE( comment, nullptr );
+    std::string original( comment->get_data(), comment->get_size() );
+
+    // Data is copied on modification only
+    comment->append_data( "ELFIO" );
+    EXPECT_EQ( comment->get_size(), original.size() + 5 );
+    EXPECT_EQ( std::string( comment->get_data(), original.size() ), original );
+    EXPECT_EQ( std::string( comment->get_data() + original.size(), 5 ),
+               "ELFIO" );
+
+    // Writing through the data pointer does not modify the source file
+    section* text = reader.sections[".text"];
+    ASSERT_NE( text, nullptr );
+    char first_byte = text->get_data()[0];
+
+    const_cast<char*>( text->get_data() )[0] = char( ~first_byte );
+
+    elfio check;
+    ASSERT_EQ( check.load( in ), true );
+    EXPECT_EQ( check.sections[".text"]->get_data()[0], first_byte );
+
+    ASSERT_EQ( reader.save( out ), true );
+
+    elfio saved;
+    ASSERT_EQ( saved.load( out ), true );
+    EXPECT_EQ( saved.sections[".text"]->get_data()[0], char( ~first_byte ) );
+    EXPECT_EQ( std::string( saved.sections[".comment"]->get_data(),
+                            saved.sections[".comment"]->get_size() ),
+               original + "ELFIO" );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, load_truncated_section_table )
+{
+    std::ifstream     file( "elf_examples/hello_64", std::ios::binary );
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string image = buffer.str();
+
+    elfio original;
+    ASSERT_EQ( original.load( "elf_examples/hello_64" ), true );
+    Elf_Half  num    = original.sections.size();
+    Elf64_Off offset = original.get_sections_offset();
+    ASSERT_LE( offset + num * sizeof( Elf64_Shdr ), image.size() );
+
+    // Cut the file in the middle of the last section header
+    image.resize( offset + num * sizeof( Elf64_Shdr ) -
+                  sizeof( Elf64_Shdr ) / 2 );
+    std::istringstream stream( image );
+
+    elfio reader;
+    reader.load( stream, true );
+    ASSERT_EQ( reader.sections.size(), num );
+    for ( Elf_Half i = 0; i < num - 1; ++i ) {
+        EXPECT_EQ( reader.sections[i]->get_type(),
+                   original.sections[i]->get_type() );
+        EXPECT_EQ( reader.sections[i]->get_offset(),
+                   original.sections[i]->get_offset() );
+        EXPECT_EQ( reader.sections[i]->get_size(),
+                   original.sections[i]->get_size() );
+        EXPECT_EQ( reader.sections[i]->get_name(),
+                   original.sections[i]->get_name() );
+    }
+    EXPECT_EQ( reader.sections[num - 1]->get_size(), 0 );
+    EXPECT_EQ( reader.segments.size(), original.segments.size() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, segment_section_mapping )
+{
+    const std::vector<std::string> files = {
+        "elf_examples/hello_64",   "elf_examples/hello_32",
+        "elf_examples/test_ppc",   "elf_examples/libfunc.so",
+        "elf_examples/asm64",      "elf_examples/x86_64_static",
+        "elf_examples/hello_arm",  "elf_examples/mismatched_segments.elf",
+        "elf_examples/main32",     "elf_examples/arm_v7m_test_debug.elf" };
+
+    for ( const auto& file : files ) {
+        elfio reader;
+        ASSERT_EQ( reader.load( file ), true ) << file;
+
+        // Compare with a straightforward check of every section
+        for ( const auto& seg : reader.segments ) {
+            std::vector<Elf_Half> expected;
+            for ( const auto& sec : reader.sections ) {
+                bool      is_alloc = ( sec->get_flags() & SHF_ALLOC ) != 0;
+                Elf64_Off begin =
+                    is_alloc ? sec->get_address() : sec->get_offset();
+                Elf64_Off seg_begin = is_alloc ? seg->get_virtual_address()
+                                               : seg->get_offset();
+                Elf64_Off seg_end =
+                    seg_begin + ( is_alloc ? seg->get_memory_size()
+                                           : seg->get_file_size() );
+                bool is_tls = ( sec->get_flags() & SHF_TLS ) != 0;
+                if ( seg_begin <= begin && begin + sec->get_size() <= seg_end &&
+                     begin < seg_end &&
+                     is_tls == ( seg->get_type() == PT_TLS ) ) {
+                    expected.push_back( sec->get_index() );
+                }
+            }
+            std::vector<Elf_Half> actual;
+            for ( Elf_Half j = 0; j < seg->get_sections_num(); ++j ) {
+                actual.push_back( seg->get_section_index_at( j ) );
+            }
+            EXPECT_EQ( actual, expected )
+                << file << " segment " << seg->get_index();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, section_name_lookup )
+{
+    elfio reader;
+    ASSERT_EQ( reader.load( "elf_examples/hello_64" ), true );
+
+    section* text = reader.sections[".text"];
+    ASSERT_NE( text, nullptr );
+    EXPECT_EQ( text->get_name(), ".text" );
+    EXPECT_EQ( reader.sections[std::string_view( ".data" )]->get_name(),
+               ".data" );
+    EXPECT_EQ( reader.sections[".no_such_section"], nullptr );
+
+    // Renaming is reflected by the lookup
+    text->set_name( ".text.renamed" );
+    EXPECT_EQ( reader.sections[".text"], nullptr );
+    EXPECT_EQ( reader.sections[".text.renamed"], text );
+
+    // Added sections are found, the first one wins for duplicated names
+    section* added1 = reader.sections.add( ".added" );
+    section* added2 = reader.sections.add( ".added" );
+    EXPECT_NE( added1, added2 );
+    EXPECT_EQ( reader.sections[".added"], added1 );
+
+    // Reloading replaces the sections
+    ASSERT_EQ( reader.load( "elf_examples/hello_32" ), true );
+    EXPECT_EQ( reader.sections[".added"], nullptr );
+    ASSERT_NE( reader.sections[".text"], nullptr );
+    EXPECT_EQ( reader.sections[".text"]->get_name(), ".text" );
+
+    elfio moved( std::move( reader ) );
+    ASSERT_NE( moved.sections[".text"], nullptr );
+    EXPECT_EQ( moved.sections[".text"]->get_name(), ".text" );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, validation_errors )
+{
+    elfio elf;
+    ASSERT_EQ( elf.load( "elf_examples/mismatched_segments.elf" ), true );
+
+    auto errors = elf.get_validation_errors();
+    ASSERT_EQ( errors.size(), 1 );
+    EXPECT_EQ( errors[0].type,
+               validation_error::kind::segment_address_conflict );
+    EXPECT_EQ( errors[0].first, 3 );
+    EXPECT_EQ( elf.sections[errors[0].second]->get_name(), ".ctors" );
+    EXPECT_EQ( errors[0].message,
+               "Virtual address of segment 3 (0x804948C) conflicts with "
+               "address of section .ctors (0x804948E) at offset 0x48E" );
+    EXPECT_EQ( elf.validate(), errors[0].message + "\n" );
+
+    ASSERT_EQ( elf.load( "elf_examples/hello_64" ), true );
+    EXPECT_TRUE( elf.get_validation_errors().empty() );
+    EXPECT_EQ( elf.validate(), "" );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, validation_large_sections )
+{
+    std::ifstream     file( "elf_examples/x86_64_static", std::ios::binary );
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string original_image = buffer.str();
+
+    elfio original;
+    ASSERT_EQ( original.load( "elf_examples/x86_64_static" ), true );
+    ASSERT_EQ( original.get_encoding(), ELFDATA2LSB );
+
+    const section* first = nullptr;
+    for ( const auto& sec : original.sections ) {
+        if ( sec->get_type() == SHT_PROGBITS ) {
+            first = sec.get();
+            break;
+        }
+    }
+    ASSERT_NE( first, nullptr );
+    Elf_Half comment = original.sections[".comment"]->get_index();
+
+    for ( bool is_wrapping : { false, true } ) {
+        std::string image     = original_image;
+        auto        set_field = [&]( Elf_Half index, size_t field,
+                                     Elf_Xword value ) {
+            size_t pos = original.get_sections_offset() +
+                         index * sizeof( Elf64_Shdr ) + field;
+            for ( size_t i = 0; i < sizeof( value ); ++i ) {
+                image[pos + i] = char( ( value >> ( 8 * i ) ) & 0xFF );
+            }
+        };
+        if ( !is_wrapping ) {
+            // Sections spanning the whole file hide the sections they cover
+            // from the segments, as the lowest section index wins
+            set_field( first->get_index(), offsetof( Elf64_Shdr, sh_offset ),
+                       0 );
+            set_field( first->get_index(), offsetof( Elf64_Shdr, sh_size ),
+                       0x10000000 );
+        }
+        else {
+            // A section whose end wraps around contains no offset
+            set_field( first->get_index(), offsetof( Elf64_Shdr, sh_offset ),
+                       0x100 );
+            set_field( first->get_index(), offsetof( Elf64_Shdr, sh_size ),
+                       ~Elf_Xword( 0x7F ) );
+        }
+        set_field( comment, offsetof( Elf64_Shdr, sh_offset ),
+                   is_wrapping ? 0 : 0x100 );
+        set_field( comment, offsetof( Elf64_Shdr, sh_size ), 0x1000000 );
+
+        std::istringstream stream( image );
+        elfio              elf;
+        ASSERT_EQ( elf.load( stream, true ), true );
+
+        std::vector<std::pair<Elf_Half, Elf_Half>> expected;
+        for ( const auto& seg : elf.segments ) {
+            if ( seg->get_type() != PT_LOAD || seg->get_file_size() == 0 ) {
+                continue;
+            }
+            Elf64_Off offset = seg->get_offset();
+            for ( const auto& sec : elf.sections ) {
+                if ( sec->get_type() == SHT_PROGBITS &&
+                     offset >= sec->get_offset() &&
+                     offset < sec->get_offset() + sec->get_size() ) {
+                    if ( sec->get_address() + offset - sec->get_offset() !=
+                         seg->get_virtual_address() ) {
+                        expected.emplace_back( seg->get_index(),
+                                               sec->get_index() );
+                    }
+                    break;
+                }
+            }
+        }
+        ASSERT_FALSE( expected.empty() ) << is_wrapping;
+
+        std::vector<std::pair<Elf_Half, Elf_Half>> conflicts;
+        for ( const auto& error : elf.get_validation_errors() ) {
+            if ( error.type ==
+                 validation_error::kind::segment_address_conflict ) {
+                conflicts.emplace_back( error.first, error.second );
+            }
+        }
+        EXPECT_EQ( conflicts, expected ) << is_wrapping;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, validation_section_overlaps )
+{
+    std::ifstream     file( "elf_examples/hello_64", std::ios::binary );
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string image = buffer.str();
+
+    elfio original;
+    ASSERT_EQ( original.load( "elf_examples/hello_64" ), true );
+    ASSERT_EQ( original.get_encoding(), ELFDATA2LSB );
+
+    // Move the file offsets of several sections on top of other sections
+    auto set_offset = [&]( Elf_Half index, Elf64_Off value ) {
+        size_t pos = original.get_sections_offset() +
+                     index * sizeof( Elf64_Shdr ) +
+                     offsetof( Elf64_Shdr, sh_offset );
+        for ( size_t i = 0; i < sizeof( value ); ++i ) {
+            image[pos + i] = char( ( value >> ( 8 * i ) ) & 0xFF );
+        }
+    };
+    const section* text = original.sections[".text"];
+    set_offset( original.sections[".rodata"]->get_index(),
+                text->get_offset() + 4 );
+    set_offset( original.sections[".comment"]->get_index(),
+                text->get_offset() );
+    set_offset( original.sections[".data"]->get_index(),
+                text->get_offset() + text->get_size() - 1 );
+    set_offset( original.sections[".init"]->get_index(),
+                std::numeric_limits<Elf64_Off>::max() - 1 );
+
+    std::istringstream stream( image );
+    elfio              elf;
+    ASSERT_EQ( elf.load( stream, true ), true );
+
+    // Compare with a check of each pair of sections
+    std::vector<std::pair<Elf_Half, Elf_Half>> expected;
+    auto in_section = []( Elf64_Off offset, const section* sec ) {
+        return offset >= sec->get_offset() &&
+               offset < sec->get_offset() + sec->get_size();
+    };
+    for ( Elf_Half i = 0; i < elf.sections.size(); ++i ) {
+        for ( Elf_Half j = i + 1; j < elf.sections.size(); ++j ) {
+            const section* a = elf.sections[i];
+            const section* b = elf.sections[j];
+            if ( ( a->get_type() & SHT_NOBITS ) == 0 &&
+                 ( b->get_type() & SHT_NOBITS ) == 0 && a->get_size() > 0 &&
+                 b->get_size() > 0 && a->get_offset() > 0 &&
+                 b->get_offset() > 0 &&
+                 ( in_section( a->get_offset(), b ) ||
+                   in_section( a->get_offset() + a->get_size() - 1, b ) ||
+                   in_section( b->get_offset(), a ) ||
+                   in_section( b->get_offset() + b->get_size() - 1, a ) ) ) {
+                expected.emplace_back( i, j );
+            }
+        }
+    }
+    ASSERT_GE( expected.size(), 3 );
+
+    std::vector<std::pair<Elf_Half, Elf_Half>> overlaps;
+    for ( const auto& error : elf.get_validation_errors() ) {
+        if ( error.type == validation_error::kind::section_overlap ) {
+            overlaps.emplace_back( error.first, error.second );
+            EXPECT_EQ( error.message,
+                       "Sections " + elf.sections[error.first]->get_name() +
+                           " and " + elf.sections[error.second]->get_name() +
+                           " overlap in file" );
+        }
+    }
+    EXPECT_EQ( overlaps, expected );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, save_sequential )
+{
+    for ( const std::string file_name :
+          { "elf_examples/hello_64", "elf_examples/hello_32",
+            "elf_examples/x86_64_static", "elf_examples/libfunc.so",
+            "elf_examples/test_ppc" } ) {
+        elfio seq_writer;
+        elfio seek_writer;
+        ASSERT_EQ( seq_writer.load( file_name ), true );
+        ASSERT_EQ( seek_writer.load( file_name ), true );
+
+        std::stringstream seq_stream;
+        std::stringstream seek_stream;
+        ASSERT_EQ( seq_writer.save( seq_stream ), true );
+        ASSERT_EQ( seek_writer.save( seek_stream, false ), true );
+        EXPECT_EQ( seq_stream.str(), seek_stream.str() ) << file_name;
+
+        // Saving again to a used stream rewrites it from the beginning
+        ASSERT_EQ( seq_writer.save( seq_stream ), true );
+        EXPECT_EQ( seq_stream.str(), seek_stream.str() ) << file_name;
+
+        elfio reader;
+        ASSERT_EQ( reader.load( seq_stream ), true );
+        ASSERT_EQ( reader.sections.size(), seq_writer.sections.size() );
+        ASSERT_EQ( reader.segments.size(), seq_writer.segments.size() );
+        for ( Elf_Half i = 0; i < reader.sections.size(); ++i ) {
+            const section* sec = reader.sections[i];
+            if ( sec->get_type() != SHT_NOBITS && sec->get_size() != 0 ) {
+                EXPECT_EQ( std::string( sec->get_data(), sec->get_size() ),
+                           std::string( seq_writer.sections[i]->get_data(),
+                                        sec->get_size() ) );
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, save_in_place )
+{
+    std::ifstream     file( "elf_examples/hello_64", std::ios::binary );
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string original = buffer.str();
+
+    std::stringstream stream( original );
+    elfio             elf;
+    ASSERT_EQ( elf.load( stream ), true );
+
+    // Nothing is written when nothing was changed
+    ASSERT_EQ( elf.save_in_place( stream ), true );
+    EXPECT_EQ( stream.str(), original );
+
+    // Rename "main" in place, change a section header and the ELF header
+    section* strtab = elf.sections[".strtab"];
+    ASSERT_NE( strtab, nullptr );
+    char* data = const_cast<char*>( strtab->get_data() );
+    char* main = nullptr;
+    for ( Elf_Xword i = 1; i < strtab->get_size();
+          i += strlen( data + i ) + 1 ) {
+        if ( std::string( data + i ) == "main" ) {
+            main = data + i;
+        }
+    }
+    ASSERT_NE( main, nullptr );
+    std::copy_n( "----", 4, main );
+    strtab->mark_data_modified( main - data, 4 );
+    // Changes which are not marked are not written
+    data[0] = 'x';
+
+    section* comment = elf.sections[".comment"];
+    ASSERT_NE( comment, nullptr );
+    comment->set_addr_align( 4 );
+    elf.set_flags( 0x1234 );
+
+    ASSERT_EQ( elf.save_in_place( stream ), true );
+    const std::string patched = stream.str();
+    ASSERT_EQ( patched.size(), original.size() );
+
+    Elf_Xword comment_header = elf.get_sections_offset() +
+                               comment->get_index() * sizeof( Elf64_Shdr );
+    auto in_range = []( size_t pos, Elf_Xword offset, Elf_Xword size ) {
+        return pos >= offset && pos < offset + size;
+    };
+    for ( size_t i = 0; i < original.size(); ++i ) {
+        if ( original[i] != patched[i] ) {
+            EXPECT_TRUE( in_range( i, 0, sizeof( Elf64_Ehdr ) ) ||
+                         in_range( i, comment_header, sizeof( Elf64_Shdr ) ) ||
+                         in_range( i, strtab->get_offset() + ( main - data ),
+                                   4 ) )
+                << i;
+        }
+    }
+
+    std::istringstream patched_stream( patched );
+    elfio              reader;
+    ASSERT_EQ( reader.load( patched_stream ), true );
+    EXPECT_EQ( reader.get_flags(), 0x1234 );
+    EXPECT_EQ( reader.sections[".comment"]->get_addr_align(), 4 );
+    symbol_section_accessor symbols( reader, reader.sections[".symtab"] );
+    Elf64_Addr              value;
+    Elf_Xword               size;
+    unsigned char           bind;
+    unsigned char           type;
+    Elf_Half                section_index;
+    unsigned char           other;
+    EXPECT_EQ( symbols.get_symbol( "main", value, size, bind, type,
+                                   section_index, other ),
+               false );
+    EXPECT_EQ( symbols.get_symbol( "----", value, size, bind, type,
+                                   section_index, other ),
+               true );
+
+    // Resizing a section changes the layout
+    comment->append_data( "x" );
+    EXPECT_EQ( elf.save_in_place( stream ), false );
+    EXPECT_EQ( stream.str(), patched );
+
+    // A full save allows in place updates of the new file
+    ASSERT_EQ( elf.save( "elf_examples/hello_64_in_place" ), true );
+    elf.set_entry( 0x1000 );
+    ASSERT_EQ( elf.save_in_place( "elf_examples/hello_64_in_place" ), true );
+    elfio saved;
+    ASSERT_EQ( saved.load( "elf_examples/hello_64_in_place" ), true );
+    EXPECT_EQ( saved.get_entry(), 0x1000 );
+    EXPECT_EQ( saved.sections[".comment"]->get_size(),
+               comment->get_size() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, save_in_place_ranges )
+{
+    std::ifstream     file( "elf_examples/hello_64", std::ios::binary );
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string original = buffer.str();
+
+    std::stringstream stream( original );
+    elfio             elf;
+    ASSERT_EQ( elf.load( stream ), true );
+
+    // The local symbols are arranged already, no symbol is written
+    section* symtab = elf.sections[".symtab"];
+    ASSERT_NE( symtab, nullptr );
+    symbol_section_accessor symbols( elf, symtab );
+    symbols.arrange_local_symbols();
+
+    // Only the changed relocation entry is written
+    section* rela = elf.sections[".rela.plt"];
+    ASSERT_NE( rela, nullptr );
+    relocation_section_accessor relocations( elf, rela );
+    Elf64_Addr                  offset;
+    Elf_Word                    symbol;
+    unsigned                    type;
+    Elf_Sxword                  addend;
+    ASSERT_EQ( relocations.get_entry( 1, offset, symbol, type, addend ),
+               true );
+    ASSERT_EQ( relocations.set_entry( 1, offset + 8, symbol, type, addend ),
+               true );
+
+    // Distant ranges are written separately, adjacent ones are merged
+    section* comment = elf.sections[".comment"];
+    ASSERT_NE( comment, nullptr );
+    ASSERT_GT( comment->get_size(), 12 );
+    char* text = const_cast<char*>( comment->get_data() );
+    std::fill_n( text + 1, 11, '#' );
+    text[0] = '*';
+    comment->mark_data_modified( 1, 2 );
+    comment->mark_data_modified( 9, 3 );
+    comment->mark_data_modified( 3, 2 );
+    comment->mark_data_modified( 7, 0 );
+
+    ASSERT_EQ( elf.save_in_place( stream ), true );
+    const std::string patched = stream.str();
+    ASSERT_EQ( patched.size(), original.size() );
+
+    auto in_range = []( size_t pos, Elf_Xword begin, Elf_Xword size ) {
+        return pos >= begin && pos < begin + size;
+    };
+    std::vector<size_t> changed;
+    for ( size_t i = 0; i < original.size(); ++i ) {
+        if ( original[i] != patched[i] ) {
+            changed.push_back( i );
+            EXPECT_TRUE(
+                in_range( i, rela->get_offset() + rela->get_entry_size(),
+                          rela->get_entry_size() ) ||
+                in_range( i, comment->get_offset() + 1, 4 ) ||
+                in_range( i, comment->get_offset() + 9, 3 ) )
+                << i;
+        }
+    }
+    EXPECT_FALSE( changed.empty() );
+
+    std::istringstream patched_stream( patched );
+    elfio              reader;
+    ASSERT_EQ( reader.load( patched_stream ), true );
+    const_relocation_section_accessor saved( reader,
+                                             reader.sections[".rela.plt"] );
+    Elf64_Addr saved_offset;
+    ASSERT_EQ( saved.get_entry( 1, saved_offset, symbol, type, addend ),
+               true );
+    EXPECT_EQ( saved_offset, offset + 8 );
+    EXPECT_EQ( std::string( reader.sections[".comment"]->get_data() + 1, 4 ),
+               "####" );
+    EXPECT_NE( reader.sections[".comment"]->get_data()[0], '*' );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, parallel_load )
+{
+    for ( const std::string file_name :
+          { "elf_examples/hello_64", "elf_examples/hello_32.o",
+            "elf_examples/x86_64_static", "elf_examples/test_ppc" } ) {
+        elfio serial;
+        ASSERT_EQ( serial.load( file_name ), true );
+
+        std::ifstream stream( file_name, std::ios::binary );
+        elfio         from_file;
+        elfio         from_stream;
+        elfio         from_mapping;
+        from_file.set_threads_num( 4 );
+        from_stream.set_threads_num( 4 );
+        from_mapping.set_threads_num( 4 );
+        ASSERT_EQ( from_file.load( file_name ), true );
+        ASSERT_EQ( from_stream.load( stream ), true );
+        ASSERT_EQ( from_mapping.load_mapped( file_name ), true );
+
+        for ( const elfio* parallel :
+              { &from_file, &from_stream, &from_mapping } ) {
+            ASSERT_EQ( parallel->sections.size(), serial.sections.size() );
+            for ( Elf_Half i = 0; i < serial.sections.size(); ++i ) {
+                const section* expected = serial.sections[i];
+                const section* sec      = parallel->sections[i];
+                EXPECT_EQ( sec->get_name(), expected->get_name() );
+                ASSERT_EQ( sec->get_size(), expected->get_size() );
+                if ( expected->get_data() == nullptr ) {
+                    EXPECT_EQ( sec->get_data(), nullptr );
+                    continue;
+                }
+                ASSERT_NE( sec->get_data(), nullptr );
+                EXPECT_TRUE( std::equal(
+                    expected->get_data(),
+                    expected->get_data() + expected->get_size(),
+                    sec->get_data() ) )
+                    << file_name << " " << expected->get_name();
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, lazy_load_concurrent_readers )
+{
+    const std::string file_name = "elf_examples/x86_64_static";
+    elfio             eager;
+    ASSERT_EQ( eager.load( file_name ), true );
+
+    std::ifstream stream( file_name, std::ios::binary );
+    elfio         from_file;
+    elfio         from_stream;
+    elfio         from_mapping;
+    ASSERT_EQ( from_file.load( file_name, true ), true );
+    ASSERT_EQ( from_stream.load( stream, true ), true );
+    ASSERT_EQ( from_mapping.load_mapped( file_name, true ), true );
+
+    for ( const elfio* lazy : { &from_file, &from_stream, &from_mapping } ) {
+        // All threads read all sections and segments, starting at
+        // different ones
+        std::vector<std::thread> threads;
+        std::atomic<int>         mismatches{ 0 };
+        for ( size_t t = 0; t < 8; ++t ) {
+            threads.emplace_back( [&, t]() {
+                size_t num = eager.sections.size();
+                for ( size_t j = 0; j < num; ++j ) {
+                    Elf_Half       i        = Elf_Half( ( j + t ) % num );
+                    const section* expected = eager.sections[i];
+                    const section* sec      = lazy->sections[i];
+                    const char*    data     = sec->get_data();
+                    if ( expected->get_data() == nullptr ||
+                         expected->get_size() == 0 ) {
+                        continue;
+                    }
+                    if ( data == nullptr ||
+                         !std::equal( expected->get_data(),
+                                      expected->get_data() +
+                                          expected->get_size(),
+                                      data ) ) {
+                        ++mismatches;
+                    }
+                }
+                for ( const auto& seg : lazy->segments ) {
+                    const segment* expected =
+                        eager.segments[seg->get_index()];
+                    if ( expected->get_file_size() != 0 &&
+                         ( seg->get_data() == nullptr ||
+                           !std::equal( expected->get_data(),
+                                        expected->get_data() +
+                                            expected->get_file_size(),
+                                        seg->get_data() ) ) ) {
+                        ++mismatches;
+                    }
+                }
+                if ( lazy->sections[".text"] == nullptr ) {
+                    ++mismatches;
+                }
+            } );
+        }
+        for ( auto& thread : threads ) {
+            thread.join();
+        }
+        EXPECT_EQ( mismatches, 0 );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, lazy_load_data_cache )
+{
+    const std::string file_name = "elf_examples/x86_64_static";
+    elfio             eager;
+    ASSERT_EQ( eager.load( file_name ), true );
+
+    auto cache = std::make_shared<lru_data_cache>( 64 * 1024 );
+    {
+        elfio first;
+        elfio second;
+        first.set_data_cache( cache );
+        second.set_data_cache( cache );
+        EXPECT_EQ( first.get_data_cache(), cache );
+        ASSERT_EQ( first.load( file_name, true ), true );
+        ASSERT_EQ( second.load( file_name, true ), true );
+
+        // Released data is loaded again on the next access
+        for ( int pass = 0; pass < 2; ++pass ) {
+            for ( const elfio* lazy : { &first, &second } ) {
+                for ( Elf_Half i = 0; i < eager.sections.size(); ++i ) {
+                    const section* expected = eager.sections[i];
+                    const section* sec      = lazy->sections[i];
+                    if ( expected->get_data() == nullptr ) {
+                        continue;
+                    }
+                    ASSERT_NE( sec->get_data(), nullptr );
+                    EXPECT_TRUE( std::equal(
+                        expected->get_data(),
+                        expected->get_data() + expected->get_size(),
+                        sec->get_data() ) );
+                    EXPECT_TRUE( cache->get_size() <= cache->get_budget() ||
+                                 cache->get_entries_num() == 1 );
+                }
+            }
+        }
+
+        // The least recently used data is released first
+        const section* text   = first.sections[".text"];
+        const section* rodata = first.sections[".rodata"];
+        cache->set_budget( 0 );
+        cache->set_budget( size_t( text->get_size() + rodata->get_size() ) );
+        const char* data = text->get_data();
+        rodata->get_data();
+        EXPECT_EQ( text->get_data(), data );
+        first.sections[".comment"]->get_data();
+        EXPECT_EQ( cache->get_entries_num(), 2 );
+        EXPECT_EQ( text->get_data(), data );
+
+        // Modified data is not tracked anymore
+        section* comment = second.sections[".comment"];
+        comment->set_data( "modified" );
+        cache->set_budget( 0 );
+        EXPECT_EQ( cache->get_entries_num(), 0 );
+        EXPECT_EQ( std::string( comment->get_data(), comment->get_size() ),
+                   "modified" );
+
+        cache->set_budget( 1024 * 1024 );
+        first.sections[".text"]->get_data();
+        EXPECT_NE( cache->get_size(), 0 );
+        first.sections[".text"]->free_data();
+        EXPECT_EQ( cache->get_size(), 0 );
+        second.segments[0]->get_data();
+        EXPECT_EQ( cache->get_size(), second.segments[0]->get_file_size() );
+    }
+
+    // Destroyed sections and segments are not tracked anymore
+    EXPECT_EQ( cache->get_entries_num(), 0 );
+    EXPECT_EQ( cache->get_size(), 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, lazy_load_data_cache_pins )
+{
+    const std::string file_name = "elf_examples/x86_64_static";
+    elfio             eager;
+    ASSERT_EQ( eager.load( file_name ), true );
+    std::stringstream expected;
+    ASSERT_EQ( eager.save( expected ), true );
+
+    // The budget is smaller than any two sections with data
+    Elf_Xword largest = 0;
+    for ( const auto& sec : eager.sections ) {
+        largest = std::max( largest, sec->get_size() );
+    }
+    auto  cache = std::make_shared<lru_data_cache>( size_t( largest ) );
+    elfio lazy;
+    lazy.set_data_cache( cache );
+    ASSERT_EQ( lazy.load( file_name, true ), true );
+
+    // Pinned data is not released by loads of other sections
+    const section* text = lazy.sections[".text"];
+    {
+        data_pin<section> pin( text );
+        const char*       data = pin.get();
+        ASSERT_NE( data, nullptr );
+        for ( const auto& sec : lazy.sections ) {
+            sec->get_data();
+        }
+        EXPECT_EQ( text->get_data(), data );
+        EXPECT_TRUE( std::equal( data, data + text->get_size(),
+                                 eager.sections[".text"]->get_data() ) );
+        EXPECT_GT( cache->get_size(), cache->get_budget() );
+    }
+    lazy.sections[".comment"]->get_data();
+    EXPECT_LE( cache->get_size(), cache->get_budget() );
+
+    // Data released by the cache is loaded again and kept while saving
+    std::stringstream saved;
+    ASSERT_EQ( lazy.save( saved ), true );
+    EXPECT_EQ( saved.str(), expected.str() );
+
+    std::stringstream saved_by_seek;
+    ASSERT_EQ( lazy.save( saved_by_seek, false ), true );
+    EXPECT_EQ( saved_by_seek.str(), expected.str() );
+
+    // The data is not pinned anymore after the save
+    lazy.sections[".comment"]->free_data();
+    lazy.sections[".comment"]->get_data();
+    EXPECT_LE( cache->get_size(), cache->get_budget() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, load_profiles )
+{
+    const std::string file_name = "elf_examples/main";
+    elfio             full;
+    ASSERT_EQ( full.load( file_name, true ), true );
+
+    elfio deferred;
+    deferred.set_load_profile( load_profile::deferred_names );
+    EXPECT_EQ( deferred.get_load_profile(), load_profile::deferred_names );
+    ASSERT_EQ( deferred.load( file_name, true ), true );
+    ASSERT_EQ( deferred.sections.size(), full.sections.size() );
+    EXPECT_EQ( deferred.sections[".text"]->get_index(),
+               full.sections[".text"]->get_index() );
+    for ( Elf_Half i = 0; i < full.sections.size(); ++i ) {
+        EXPECT_EQ( deferred.sections[i]->get_name(),
+                   full.sections[i]->get_name() );
+    }
+    deferred.sections[1]->set_name( ".renamed" );
+    EXPECT_EQ( deferred.sections[".renamed"], deferred.sections[1] );
+
+    elfio headers;
+    headers.set_load_profile( load_profile::headers_only );
+    ASSERT_EQ( headers.load( file_name, true ), true );
+    EXPECT_EQ( headers.sections.size(), 0 );
+    EXPECT_EQ( headers.sections[".text"], nullptr );
+    EXPECT_EQ( headers.get_machine(), EM_X86_64 );
+    EXPECT_EQ( headers.get_type(), ET_EXEC );
+    ASSERT_EQ( headers.segments.size(), full.segments.size() );
+
+    // The build ID is available from the note segment
+    std::string build_id;
+    for ( const auto& seg : headers.segments ) {
+        if ( seg->get_type() != PT_NOTE ) {
+            continue;
+        }
+        note_segment_accessor notes( headers, seg.get() );
+        for ( Elf_Word i = 0; i < notes.get_notes_num(); ++i ) {
+            Elf_Word    type;
+            std::string name;
+            char*       desc;
+            Elf_Word    desc_size;
+            if ( notes.get_note( i, type, name, desc, desc_size ) &&
+                 type == NT_GNU_BUILD_ID && name == "GNU" ) {
+                build_id.assign( desc, desc_size );
+            }
+        }
+    }
+    EXPECT_EQ( build_id.size(), 20 );
+    EXPECT_EQ( (unsigned char)build_id[0], 0xab );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, batch_scanner )
+{
+    std::vector<std::string> file_names = {
+        "elf_examples/hello_64",     "elf_examples/hello_32",
+        "elf_examples/x86_64_static", "elf_examples/libfunc.so",
+        "elf_examples/main",         "elf_examples/asm.o",
+        "elf_examples/not_existing", "elf_examples/hello.c" };
+
+    std::map<std::string, Elf_Half> expected;
+    for ( const auto& file_name : file_names ) {
+        elfio reader;
+        if ( reader.load( file_name ) ) {
+            expected[file_name] = reader.get_machine();
+        }
+    }
+    ASSERT_EQ( expected.size(), 6 );
+
+    for ( bool is_lazy : { true, false } ) {
+        batch_scanner scanner( 3, 64 * 1024 );
+        scanner.set_lazy( is_lazy );
+        EXPECT_EQ( scanner.get_workers_num(), 3 );
+        EXPECT_EQ( scanner.get_memory_budget(), 64 * 1024 );
+
+        std::mutex                      mutex;
+        std::map<std::string, Elf_Half> machines;
+        std::vector<std::string>        failed;
+        size_t                          sizes = 0;
+        size_t                          loaded =
+            scanner.scan( file_names, [&]( const std::string& file_name,
+                                           elfio*             file ) {
+                std::lock_guard<std::mutex> lock( mutex );
+                if ( file == nullptr ) {
+                    failed.push_back( file_name );
+                    return;
+                }
+                machines[file_name] = file->get_machine();
+                for ( const auto& sec : file->sections ) {
+                    if ( sec->get_type() != SHT_NOBITS &&
+                         sec->get_data() != nullptr ) {
+                        sizes += sec->get_size();
+                    }
+                }
+            } );
+
+        EXPECT_EQ( loaded, 6 );
+        EXPECT_EQ( machines, expected );
+        std::sort( failed.begin(), failed.end() );
+        EXPECT_EQ( failed, std::vector<std::string>(
+                               { "elf_examples/hello.c",
+                                 "elf_examples/not_existing" } ) );
+        EXPECT_GT( sizes, 0 );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, relocation_cursor )
+{
+    for ( const std::string file_name :
+          { "elf_examples/hello_32.o", "elf_examples/hello_64.o",
+            "elf_examples/hello_32", "elf_examples/hello_64",
+            "elf_examples/libfunc.so" } ) {
+        elfio reader;
+        ASSERT_EQ( reader.load( file_name ), true ) << file_name;
+
+        Elf_Xword checked = 0;
+        for ( const auto& sec : reader.sections ) {
+            if ( sec->get_type() != SHT_REL && sec->get_type() != SHT_RELA ) {
+                continue;
+            }
+
+            const_relocation_section_accessor relocs( reader, sec.get() );
+            const_symbol_section_accessor     symbols(
+                reader, reader.sections[(Elf_Half)sec->get_link()] );
+            relocation_cursor cursor( reader, sec.get() );
+            ASSERT_EQ( cursor.get_entries_num(), relocs.get_entries_num() );
+
+            relocation_entry entry;
+            Elf_Xword        index = 0;
+            while ( cursor.next( entry ) ) {
+                Elf64_Addr offset;
+                Elf_Word   symbol;
+                unsigned   type;
+                Elf_Sxword addend;
+                ASSERT_EQ(
+                    relocs.get_entry( index, offset, symbol, type, addend ),
+                    true );
+                EXPECT_EQ( entry.offset, offset );
+                EXPECT_EQ( entry.symbol, symbol );
+                EXPECT_EQ( entry.type, type );
+                EXPECT_EQ( entry.addend, addend );
+
+                std::string   name;
+                Elf64_Addr    value;
+                Elf_Xword     size;
+                unsigned char bind;
+                unsigned char symbol_type;
+                Elf_Half      section_index;
+                unsigned char other;
+                ASSERT_EQ( symbols.get_symbol( symbol, name, value, size,
+                                               bind, symbol_type,
+                                               section_index, other ),
+                           true );
+                EXPECT_EQ( entry.symbol_name, name );
+                EXPECT_EQ( entry.symbol_value, value );
+
+                std::string resolved_name;
+                Elf64_Addr  resolved_value;
+                Elf_Sxword  calc_value;
+                ASSERT_EQ( relocs.get_entry( index, offset, resolved_value,
+                                             resolved_name, type, addend,
+                                             calc_value ),
+                           true );
+                EXPECT_EQ( resolved_name, name );
+                EXPECT_EQ( calc_value, entry.calc_value );
+                ++index;
+                ++checked;
+            }
+            EXPECT_EQ( index, cursor.get_entries_num() );
+            EXPECT_EQ( cursor.get_entry( index, entry ), false );
+
+            cursor.set_position( 0 );
+            EXPECT_EQ( cursor.get_position(), 0 );
+        }
+        EXPECT_GT( checked, 0 ) << file_name;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, relocator )
+{
+    elfio writer;
+    writer.create( ELFCLASS64, ELFDATA2LSB );
+    writer.set_type( ET_REL );
+    writer.set_machine( EM_AARCH64 );
+
+    // bl, adrp, add, ldr, followed by data
+    const std::uint32_t code[] = { 0x94000000, 0x90000000, 0x91000000,
+                                   0xf9400001, 0,          0,
+                                   0,          0x94000000, 0xffffffff,
+                                   0xffffffff, 0xffffffff, 0xffffffff,
+                                   0,          0 };
+    section* text = writer.sections.add( ".text" );
+    text->set_type( SHT_PROGBITS );
+    text->set_flags( SHF_ALLOC | SHF_EXECINSTR );
+    text->set_data( reinterpret_cast<const char*>( code ), sizeof( code ) );
+
+    section* rodata = writer.sections.add( ".rodata" );
+    rodata->set_type( SHT_PROGBITS );
+    rodata->set_flags( SHF_ALLOC );
+    rodata->set_address( 0x1200 );
+    rodata->set_data( std::string( 0x40, '\0' ) );
+
+    section* str_sec = writer.sections.add( ".strtab" );
+    str_sec->set_type( SHT_STRTAB );
+    section* sym_sec = writer.sections.add( ".symtab" );
+    sym_sec->set_type( SHT_SYMTAB );
+    sym_sec->set_link( str_sec->get_index() );
+    sym_sec->set_entry_size( writer.get_default_entry_size( SHT_SYMTAB ) );
+
+    string_section_accessor strings( str_sec );
+    symbol_section_accessor symbols( writer, sym_sec );
+    Elf_Word far = symbols.add_symbol( strings, "far", 0x30, 0, STB_LOCAL,
+                                       STT_OBJECT, 0, rodata->get_index() );
+    Elf_Word ext = symbols.add_symbol( strings, "ext", 0, 0, STB_GLOBAL,
+                                       STT_FUNC, 0, SHN_UNDEF );
+    Elf_Word weak = symbols.add_symbol( strings, "weak", 0, 0, STB_WEAK,
+                                        STT_OBJECT, 0, SHN_UNDEF );
+    Elf_Word missing = symbols.add_symbol( strings, "missing", 0, 0,
+                                           STB_GLOBAL, STT_OBJECT, 0,
+                                           SHN_UNDEF );
+
+    section* rel_sec = writer.sections.add( ".rela.text" );
+    rel_sec->set_type( SHT_RELA );
+    rel_sec->set_info( text->get_index() );
+    rel_sec->set_link( sym_sec->get_index() );
+    rel_sec->set_entry_size( writer.get_default_entry_size( SHT_RELA ) );
+    relocation_section_accessor relocs( writer, rel_sec );
+    relocs.add_entry( 0x00, far, R_AARCH64_CALL26, 0 );
+    relocs.add_entry( 0x04, far, R_AARCH64_ADR_PREL_PG_HI21, 0 );
+    relocs.add_entry( 0x08, far, R_AARCH64_ADD_ABS_LO12_NC, 0 );
+    relocs.add_entry( 0x0c, far, R_AARCH64_LDST64_ABS_LO12_NC, 0 );
+    relocs.add_entry( 0x10, far, R_AARCH64_ABS64, 8 );
+    relocs.add_entry( 0x18, far, R_AARCH64_PREL32, 0 );
+    relocs.add_entry( 0x1c, ext, R_AARCH64_CALL26, 0 );
+    relocs.add_entry( 0x20, weak, R_AARCH64_ABS64, 0 );
+    relocs.add_entry( 0x28, missing, R_AARCH64_ABS64, 0 );
+    relocs.add_entry( 0x30, far, 0x7ff, 0 );
+    relocs.add_entry( 0x100, far, R_AARCH64_ABS64, 0 );
+
+    relocator engine( writer );
+    ASSERT_EQ( engine.is_supported(), true );
+    engine.set_symbol_resolver(
+        []( std::string_view name, Elf64_Addr& value ) {
+            value = 0x100000;
+            return name == "ext";
+        } );
+
+    std::vector<std::uint32_t> data( std::begin( code ), std::end( code ) );
+    relocation_report          report;
+    ASSERT_EQ( engine.apply( rel_sec, reinterpret_cast<char*>( data.data() ),
+                             sizeof( code ), 0, &report ),
+               false );
+    EXPECT_EQ( report.applied, 8 );
+    ASSERT_EQ( report.issues.size(), 3 );
+    EXPECT_EQ( report.issues[0].index, 8 );
+    EXPECT_EQ( report.issues[0].status, relocation_status::unresolved );
+    EXPECT_EQ( report.issues[1].index, 9 );
+    EXPECT_EQ( report.issues[1].type, 0x7ff );
+    EXPECT_EQ( report.issues[1].status, relocation_status::unsupported );
+    EXPECT_EQ( report.issues[2].index, 10 );
+    EXPECT_EQ( report.issues[2].status, relocation_status::out_of_bounds );
+
+    // far is at 0x1230
+    EXPECT_EQ( data[0], 0x9400048c ); // bl 0x1230
+    EXPECT_EQ( data[1], 0xb0000000 ); // adrp x0, 0x1000
+    EXPECT_EQ( data[2], 0x9108c000 ); // add x0, x0, #0x230
+    EXPECT_EQ( data[3], 0xf9411801 ); // ldr x1, [x0, #0x230]
+    EXPECT_EQ( data[4], 0x1238 );
+    EXPECT_EQ( data[5], 0 );
+    EXPECT_EQ( data[6], 0x1230 - 0x18 );
+    EXPECT_EQ( data[7], 0x9403fff9 ); // bl 0x100000
+    EXPECT_EQ( data[8], 0 );          // Undefined weak symbol
+    EXPECT_EQ( data[9], 0 );
+    EXPECT_EQ( data[10], 0xffffffff ); // Unresolved, not changed
+
+    // The base moves absolute values, not PC relative ones
+    engine.set_base( 0x40000000 );
+    data.assign( std::begin( code ), std::end( code ) );
+    engine.apply( rel_sec, reinterpret_cast<char*>( data.data() ),
+                  sizeof( code ), 0 );
+    EXPECT_EQ( data[0], 0x9400048c );
+    EXPECT_EQ( data[4], 0x40001238 );
+    EXPECT_EQ( data[5], 0 );
+
+    // Unsupported architectures
+    writer.set_machine( EM_PPC );
+    EXPECT_EQ( relocator( writer ).is_supported(), false );
+    EXPECT_EQ( relocator( writer ).apply(
+                   rel_sec, reinterpret_cast<char*>( data.data() ),
+                   sizeof( code ), 0 ),
+               false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+struct relocation_fixup
+{
+    Elf64_Addr offset; // Offset of the field in the code
+    Elf64_Addr symbol; // Absolute value of the symbol
+    unsigned   type;
+    Elf_Sxword addend; // Used by RELA sections only
+};
+
+struct relocation_case
+{
+    const char*                   name;
+    Elf_Half                      machine;
+    unsigned char                 elf_class;
+    bool                          is_rela;
+    Elf64_Addr                    address; // Address of the code
+    std::vector<unsigned char>    code;
+    std::vector<relocation_fixup> fixups;
+    std::vector<unsigned char>    expected;
+    relocation_status             status;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+void check_relocation_case( const relocation_case& test )
+{
+    elfio writer;
+    writer.create( test.elf_class, ELFDATA2LSB );
+    writer.set_type( ET_EXEC );
+    writer.set_machine( test.machine );
+
+    section* str_sec = writer.sections.add( ".strtab" );
+    str_sec->set_type( SHT_STRTAB );
+    section* sym_sec = writer.sections.add( ".symtab" );
+    sym_sec->set_type( SHT_SYMTAB );
+    sym_sec->set_link( str_sec->get_index() );
+    sym_sec->set_entry_size( writer.get_default_entry_size( SHT_SYMTAB ) );
+    section* rel_sec = writer.sections.add( ".rel.text" );
+    rel_sec->set_type( test.is_rela ? SHT_RELA : SHT_REL );
+    rel_sec->set_link( sym_sec->get_index() );
+    rel_sec->set_entry_size(
+        writer.get_default_entry_size( rel_sec->get_type() ) );
+
+    string_section_accessor     strings( str_sec );
+    symbol_section_accessor     symbols( writer, sym_sec );
+    relocation_section_accessor relocs( writer, rel_sec );
+    for ( const auto& fixup : test.fixups ) {
+        Elf_Word symbol =
+            symbols.add_symbol( strings, "s", fixup.symbol, 0, STB_LOCAL,
+                                STT_NOTYPE, 0, SHN_ABS );
+        if ( test.is_rela ) {
+            relocs.add_entry( test.address + fixup.offset, symbol,
+                              (unsigned char)fixup.type, fixup.addend );
+        }
+        else {
+            relocs.add_entry( test.address + fixup.offset, symbol,
+                              (unsigned char)fixup.type );
+        }
+    }
+
+    std::vector<unsigned char> data = test.code;
+    relocation_report          report;
+    relocator                  engine( writer );
+    engine.apply( rel_sec, reinterpret_cast<char*>( data.data() ), data.size(),
+                  test.address, &report );
+    if ( test.status == relocation_status::applied ) {
+        EXPECT_TRUE( report.issues.empty() ) << test.name;
+    }
+    else {
+        ASSERT_EQ( report.issues.size(), 1 ) << test.name;
+        EXPECT_EQ( report.issues[0].status, test.status ) << test.name;
+    }
+    EXPECT_EQ( data, test.expected ) << test.name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, relocator_encodings )
+{
+    // The expected encodings are disassembled by llvm-mc as in the comments
+    const relocation_case cases[] = {
+        // i386, the addend is kept in the field
+        { "386 PC32", EM_386, ELFCLASS32, false, 0x1000,
+          { 0xfc, 0xff, 0xff, 0xff },
+          { { 0, 0x2000, R_386_PC32, 0 } },
+          { 0xfc, 0x0f, 0x00, 0x00 },
+          relocation_status::applied },
+        { "386 32", EM_386, ELFCLASS32, false, 0x1000,
+          { 0x08, 0x00, 0x00, 0x00 },
+          { { 0, 0x12345678, R_386_32, 0 } },
+          { 0x80, 0x56, 0x34, 0x12 },
+          relocation_status::applied },
+
+        // x86-64
+        { "x86-64 32 max", EM_X86_64, ELFCLASS64, true, 0x10000,
+          { 0, 0, 0, 0 },
+          { { 0, 0xffffffff, R_X86_64_32, 0 } },
+          { 0xff, 0xff, 0xff, 0xff },
+          relocation_status::applied },
+        { "x86-64 32 overflow", EM_X86_64, ELFCLASS64, true, 0x10000,
+          { 0, 0, 0, 0 },
+          { { 0, 0xfffffffc, R_X86_64_32, 4 } },
+          { 0, 0, 0, 0 },
+          relocation_status::overflow },
+        { "x86-64 32 negative", EM_X86_64, ELFCLASS64, true, 0x10000,
+          { 0, 0, 0, 0 },
+          { { 0, 0, R_X86_64_32, -1 } },
+          { 0, 0, 0, 0 },
+          relocation_status::overflow },
+        { "x86-64 32S min", EM_X86_64, ELFCLASS64, true, 0x10000,
+          { 0, 0, 0, 0 },
+          { { 0, 0xffffffff80000000, R_X86_64_32S, 0 } },
+          { 0x00, 0x00, 0x00, 0x80 },
+          relocation_status::applied },
+        { "x86-64 32S overflow", EM_X86_64, ELFCLASS64, true, 0x10000,
+          { 0, 0, 0, 0 },
+          { { 0, 0x7fffffff, R_X86_64_32S, 1 } },
+          { 0, 0, 0, 0 },
+          relocation_status::overflow },
+        { "x86-64 PC32", EM_X86_64, ELFCLASS64, true, 0x10000,
+          { 0, 0, 0, 0 },
+          { { 0, 0x20000, R_X86_64_PC32, -4 } },
+          { 0xfc, 0xff, 0x00, 0x00 },
+          relocation_status::applied },
+
+        // RISC-V
+        { "riscv BRANCH forward", EM_RISCV, ELFCLASS64, true, 0x10000,
+          { 0x63, 0x00, 0xb5, 0x00 }, // beq a0, a1, 0
+          { { 0, 0x10800, R_RISCV_BRANCH, 0 } },
+          { 0xe3, 0x00, 0xb5, 0x00 }, // beq a0, a1, 2048
+          relocation_status::applied },
+        { "riscv BRANCH backward", EM_RISCV, ELFCLASS64, true, 0x10000,
+          { 0x63, 0x00, 0xb5, 0x00 },
+          { { 0, 0xffe0, R_RISCV_BRANCH, 0 } },
+          { 0xe3, 0x00, 0xb5, 0xfe }, // beq a0, a1, -32
+          relocation_status::applied },
+        { "riscv BRANCH overflow", EM_RISCV, ELFCLASS64, true, 0x10000,
+          { 0x63, 0x00, 0xb5, 0x00 },
+          { { 0, 0x11000, R_RISCV_BRANCH, 0 } },
+          { 0x63, 0x00, 0xb5, 0x00 },
+          relocation_status::overflow },
+        { "riscv JAL", EM_RISCV, ELFCLASS64, true, 0x10000,
+          { 0xef, 0x00, 0x00, 0x00 }, // jal 0
+          { { 0, 0x10000 + 0x12346, R_RISCV_JAL, 0 } },
+          { 0xef, 0x20, 0x61, 0x34 }, // jal 0x12346
+          relocation_status::applied },
+        { "riscv CALL", EM_RISCV, ELFCLASS64, true, 0x10000,
+          { 0x97, 0x00, 0x00, 0x00, 0xe7, 0x80, 0x00, 0x00 },
+          { { 0, 0x10000 + 0x12345ffe, R_RISCV_CALL, 0 } },
+          { 0x97, 0x60, 0x34, 0x12,   // auipc ra, 0x12346
+            0xe7, 0x80, 0xe0, 0xff }, // jalr -2(ra)
+          relocation_status::applied },
+        { "riscv RVC_BRANCH", EM_RISCV, ELFCLASS64, true, 0x10000,
+          { 0x01, 0xc1 }, // c.beqz a0, 0
+          { { 0, 0x10000 + 0xaa, R_RISCV_RVC_BRANCH, 0 } },
+          { 0x4d, 0xc5 }, // c.beqz a0, 170
+          relocation_status::applied },
+        { "riscv RVC_JUMP", EM_RISCV, ELFCLASS64, true, 0x10000,
+          { 0x01, 0xa0 }, // c.j 0
+          { { 0, 0x10000 - 0x552, R_RISCV_RVC_JUMP, 0 } },
+          { 0x7d, 0xb4 }, // c.j -1362
+          relocation_status::applied },
+        { "riscv PCREL_HI20 and LO12", EM_RISCV, ELFCLASS64, true, 0x10000,
+          { 0x17, 0x05, 0x00, 0x00,   // auipc a0, 0
+            0x13, 0x05, 0x05, 0x00,   // addi a0, a0, 0
+            0x23, 0x30, 0xb5, 0x00 }, // sd a1, 0(a0)
+          { { 0, 0x11800, R_RISCV_PCREL_HI20, 0 },
+            { 4, 0x10000, R_RISCV_PCREL_LO12_I, 0 },
+            { 8, 0x10000, R_RISCV_PCREL_LO12_S, 0 } },
+          { 0x17, 0x25, 0x00, 0x00,   // auipc a0, 2
+            0x13, 0x05, 0x05, 0x80,   // addi a0, a0, -2048
+            0x23, 0x30, 0xb5, 0x80 }, // sd a1, -2048(a0)
+          relocation_status::applied },
+
+        // ARM, the addend is kept in the instruction
+        { "arm BL to ARM", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xfe, 0xff, 0xff, 0xeb }, // bl .
+          { { 0, 0x8100, R_ARM_CALL, 0 } },
+          { 0x3e, 0x00, 0x00, 0xeb }, // bl #248
+          relocation_status::applied },
+        { "arm BL to Thumb", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xfe, 0xff, 0xff, 0xeb },
+          { { 0, 0x8101, R_ARM_CALL, 0 } },
+          { 0x3e, 0x00, 0x00, 0xfa }, // blx #248
+          relocation_status::applied },
+        { "arm BL to Thumb, H bit", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xfe, 0xff, 0xff, 0xeb },
+          { { 0, 0x8103, R_ARM_CALL, 0 } },
+          { 0x3e, 0x00, 0x00, 0xfb }, // blx #250
+          relocation_status::applied },
+        { "arm BLX to Thumb, H bit", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xfe, 0xff, 0xff, 0xfa }, // blx .
+          { { 0, 0x8103, R_ARM_CALL, 0 } },
+          { 0x3e, 0x00, 0x00, 0xfb },
+          relocation_status::applied },
+        { "arm BLX with H bit addend", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xfe, 0xff, 0xff, 0xfb }, // blx .+2
+          { { 0, 0x8103, R_ARM_CALL, 0 } },
+          { 0x3f, 0x00, 0x00, 0xfa }, // blx #252
+          relocation_status::applied },
+        { "arm BLX to ARM", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xfe, 0xff, 0xff, 0xfa },
+          { { 0, 0x8100, R_ARM_CALL, 0 } },
+          { 0x3e, 0x00, 0x00, 0xeb },
+          relocation_status::applied },
+        { "arm B to Thumb", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xfe, 0xff, 0xff, 0xea }, // b .
+          { { 0, 0x8101, R_ARM_JUMP24, 0 } },
+          { 0xfe, 0xff, 0xff, 0xea },
+          relocation_status::unsupported },
+        { "arm MOVW and MOVT", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0x00, 0x00, 0x00, 0xe3,   // movw r0, #0
+            0x00, 0x00, 0x40, 0xe3 }, // movt r0, #0
+          { { 0, 0x12345678, R_ARM_MOVW_ABS_NC, 0 },
+            { 4, 0x12345678, R_ARM_MOVT_ABS, 0 } },
+          { 0x78, 0x06, 0x05, 0xe3,   // movw r0, #0x5678
+            0x34, 0x02, 0x41, 0xe3 }, // movt r0, #0x1234
+          relocation_status::applied },
+
+        // Thumb
+        { "thumb BL to Thumb", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xff, 0xf7, 0xfe, 0xff }, // bl .
+          { { 0, 0x8201, R_ARM_THM_CALL, 0 } },
+          { 0x00, 0xf0, 0xfe, 0xf8 }, // bl #508
+          relocation_status::applied },
+        { "thumb BL to ARM", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0x00, 0xbf,               // nop
+            0xff, 0xf7, 0xfe, 0xff }, // bl .
+          { { 2, 0x8200, R_ARM_THM_CALL, 0 } },
+          { 0x00, 0xbf,
+            0x00, 0xf0, 0xfe, 0xe8 }, // blx #508, from the aligned PC
+          relocation_status::applied },
+        { "thumb BLX to ARM", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0x00, 0xbf,               // nop
+            0xff, 0xf7, 0xfe, 0xef }, // blx .
+          { { 2, 0x8200, R_ARM_THM_CALL, 0 } },
+          { 0x00, 0xbf, 0x00, 0xf0, 0xfe, 0xe8 },
+          relocation_status::applied },
+        { "thumb BLX to Thumb", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xff, 0xf7, 0xfe, 0xef },
+          { { 0, 0x8201, R_ARM_THM_CALL, 0 } },
+          { 0x00, 0xf0, 0xfe, 0xf8 },
+          relocation_status::applied },
+        { "thumb B.W to ARM", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0xff, 0xf7, 0xfe, 0xbf }, // b.w .
+          { { 0, 0x8200, R_ARM_THM_JUMP24, 0 } },
+          { 0xff, 0xf7, 0xfe, 0xbf },
+          relocation_status::unsupported },
+        { "thumb MOVW and MOVT", EM_ARM, ELFCLASS32, false, 0x8000,
+          { 0x40, 0xf2, 0x00, 0x00,   // movw r0, #0
+            0xc0, 0xf2, 0x00, 0x00 }, // movt r0, #0
+          { { 0, 0x12345678, R_ARM_THM_MOVW_ABS_NC, 0 },
+            { 4, 0x12345678, R_ARM_THM_MOVT_ABS, 0 } },
+          { 0x45, 0xf2, 0x78, 0x60,   // movw r0, #0x5678
+            0xc1, 0xf2, 0x34, 0x20 }, // movt r0, #0x1234
+          relocation_status::applied },
+    };
+
+    for ( const auto& test : cases ) {
+        check_relocation_case( test );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <class Rel, class Sym, class Dyn>
+void check_table_views( const elfio& reader, const std::string& file_name )
+{
+    Elf_Xword checked = 0;
+    for ( const auto& sec : reader.sections ) {
+        if ( sec->get_type() == SHT_REL || sec->get_type() == SHT_RELA ) {
+            const_relocation_section_accessor relocs( reader, sec.get() );
+            auto check = [&]( const auto& view ) {
+                ASSERT_EQ( view.size(), relocs.get_entries_num() );
+                Elf_Xword index = 0;
+                for ( const auto& entry : view ) {
+                    Elf64_Addr offset;
+                    Elf_Word   symbol;
+                    unsigned   type;
+                    Elf_Sxword addend;
+                    relocs.get_entry( index++, offset, symbol, type, addend );
+                    EXPECT_EQ( entry.r_offset, offset ) << file_name;
+                    EXPECT_EQ( get_sym_and_type<Rel>::get_r_sym( entry.r_info ),
+                               symbol );
+                    EXPECT_EQ(
+                        get_sym_and_type<Rel>::get_r_type( entry.r_info ),
+                        type );
+                    ++checked;
+                }
+            };
+            if ( sec->get_type() == SHT_REL ) {
+                check( make_table_view<Rel>( reader, sec.get() ) );
+            }
+            else {
+                auto view = make_table_view<
+                    std::conditional_t<sizeof( Rel ) == sizeof( Elf32_Rel ),
+                                       Elf32_Rela, Elf64_Rela>>( reader,
+                                                                 sec.get() );
+                check( view );
+                Elf_Xword index = 0;
+                for ( const auto& entry : view ) {
+                    Elf64_Addr offset;
+                    Elf_Word   symbol;
+                    unsigned   type;
+                    Elf_Sxword addend;
+                    relocs.get_entry( index++, offset, symbol, type, addend );
+                    EXPECT_EQ( entry.r_addend, addend );
+                }
+            }
+        }
+        else if ( sec->get_type() == SHT_SYMTAB ||
+                  sec->get_type() == SHT_DYNSYM ) {
+            const_symbol_section_accessor symbols( reader, sec.get() );
+            auto view = make_table_view<Sym>( reader, sec.get() );
+            ASSERT_EQ( view.size(), symbols.get_symbols_num() );
+            std::ptrdiff_t functions = 0;
+            for ( Elf_Xword i = 0; i < view.size(); ++i ) {
+                std::string   name;
+                Elf64_Addr    value;
+                Elf_Xword     size;
+                unsigned char bind;
+                unsigned char type;
+                Elf_Half      section_index;
+                unsigned char other;
+                symbols.get_symbol( i, name, value, size, bind, type,
+                                    section_index, other );
+                Sym sym = view[i];
+                EXPECT_EQ( sym.st_value, value ) << file_name;
+                EXPECT_EQ( sym.st_size, size );
+                EXPECT_EQ( ELF_ST_BIND( sym.st_info ), bind );
+                EXPECT_EQ( ELF_ST_TYPE( sym.st_info ), type );
+                EXPECT_EQ( sym.st_shndx, section_index );
+                EXPECT_EQ( sym.st_other, other );
+                functions += type == STT_FUNC ? 1 : 0;
+                ++checked;
+            }
+
+            // The view works with the standard algorithms
+            EXPECT_EQ( std::count_if( view.begin(), view.end(),
+                                      []( const Sym& sym ) {
+                                          return ELF_ST_TYPE( sym.st_info ) ==
+                                                 STT_FUNC;
+                                      } ),
+                       functions );
+            EXPECT_EQ( std::distance( view.begin(), view.end() ),
+                       std::ptrdiff_t( view.size() ) );
+            if ( !view.empty() ) {
+                EXPECT_EQ( ( *( view.end() - 1 ) ).st_name,
+                           view.back().st_name );
+                EXPECT_EQ( ( view.end() - 1 )->st_name, view.back().st_name );
+            }
+
+            Elf_Xword first_function = 0;
+            while ( first_function < view.size() &&
+                    ELF_ST_TYPE( view[first_function].st_info ) != STT_FUNC ) {
+                ++first_function;
+            }
+            auto found = std::find_if(
+                view.begin(), view.end(), []( const Sym& sym ) {
+                    return ELF_ST_TYPE( sym.st_info ) == STT_FUNC;
+                } );
+            EXPECT_EQ( std::distance( view.begin(), found ),
+                       std::ptrdiff_t( first_function ) );
+
+            // The local symbols come first, and sh_info is one greater
+            // than the index of the last one
+            auto first_global = std::lower_bound(
+                view.begin(), view.end(), STB_LOCAL,
+                []( const Sym& sym, unsigned char bind ) {
+                    return ELF_ST_BIND( sym.st_info ) == bind;
+                } );
+            EXPECT_EQ( std::distance( view.begin(), first_global ),
+                       std::ptrdiff_t( sec->get_info() ) )
+                << file_name;
+        }
+        else if ( sec->get_type() == SHT_DYNAMIC ) {
+            const_dynamic_section_accessor dynamic( reader, sec.get() );
+            auto view = make_table_view<Dyn>( reader, sec.get() );
+            // The accessor stops at DT_NULL, the view covers the section
+            ASSERT_GE( view.size(), dynamic.get_entries_num() );
+            for ( Elf_Xword i = 0; i < dynamic.get_entries_num(); ++i ) {
+                Elf_Xword   tag;
+                Elf_Xword   value;
+                std::string str;
+                dynamic.get_entry( i, tag, value, str );
+                EXPECT_EQ( Elf_Xword( view[i].d_tag ), tag );
+                ++checked;
+            }
+        }
+    }
+    EXPECT_GT( checked, 0 ) << file_name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, table_views )
+{
+    for ( const std::string file_name :
+          { "elf_examples/hello_32.o", "elf_examples/hello_64.o",
+            "elf_examples/hello_32", "elf_examples/hello_64",
+            "elf_examples/test_ppc.o", "elf_examples/test_ppc" } ) {
+        elfio reader;
+        ASSERT_EQ( reader.load( file_name ), true ) << file_name;
+        if ( reader.get_class() == ELFCLASS32 ) {
+            check_table_views<Elf32_Rel, Elf32_Sym, Elf32_Dyn>( reader,
+                                                                file_name );
+        }
+        else {
+            check_table_views<Elf64_Rel, Elf64_Sym, Elf64_Dyn>( reader,
+                                                                file_name );
+        }
+
+        // Plain arrays only for the host byte order
+        const section* symtab = reader.sections[".symtab"];
+        ASSERT_NE( symtab, nullptr );
+        auto view = make_table_view<Elf32_Sym>( reader, symtab );
+        EXPECT_EQ( view.native_data() != nullptr,
+                   reader.get_class() == ELFCLASS32 &&
+                       reader.get_encoding() == ELFDATA2LSB );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <class T> void check_table_byteswap()
+{
+    std::vector<unsigned char> source( 257 * sizeof( T ) );
+    uint32_t                   seed = 12345;
+    for ( auto& byte : source ) {
+        seed = seed * 1103515245 + 12345;
+        byte = (unsigned char)( seed >> 16 );
+    }
+
+    for ( size_t count : { 0, 1, 3, 4, 7, 8, 17, 64, 255, 257 } ) {
+        std::vector<unsigned char> bulk( count * sizeof( T ) );
+        std::vector<unsigned char> portable( count * sizeof( T ) );
+        table_entry_swapper<T>::swap( bulk.data(), source.data(), count );
+        table_entry_swapper<T>::swap_portable( portable.data(),
+                                               source.data(), count );
+        EXPECT_EQ( bulk, portable ) << sizeof( T ) << " " << count;
+
+        // In place conversion returns the original data
+        table_entry_swapper<T>::swap( bulk.data(), bulk.data(), count );
+        EXPECT_TRUE( std::equal( bulk.begin(), bulk.end(), source.begin() ) );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, table_byteswap )
+{
+    check_table_byteswap<Elf32_Rel>();
+    check_table_byteswap<Elf32_Rela>();
+    check_table_byteswap<Elf64_Rel>();
+    check_table_byteswap<Elf64_Rela>();
+    check_table_byteswap<Elf32_Sym>();
+    check_table_byteswap<Elf64_Sym>();
+    check_table_byteswap<Elf32_Dyn>();
+    check_table_byteswap<Elf64_Dyn>();
+
+    // Copies of a big endian table match the entries of the view
+    elfio reader;
+    ASSERT_EQ( reader.load( "elf_examples/test_ppc" ), true );
+    for ( const auto& sec : reader.sections ) {
+        if ( sec->get_type() != SHT_SYMTAB && sec->get_type() != SHT_DYNSYM ) {
+            continue;
+        }
+        auto                   view = make_table_view<Elf32_Sym>( reader,
+                                                                  sec.get() );
+        std::vector<Elf32_Sym> symbols;
+        view.copy_to( symbols );
+        ASSERT_EQ( symbols.size(), view.size() );
+        for ( Elf_Xword i = 0; i < view.size(); ++i ) {
+            Elf32_Sym sym = view[i];
+            EXPECT_EQ( std::memcmp( &symbols[i], &sym, sizeof( sym ) ), 0 );
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <unsigned char Class, unsigned char Encoding>
+void check_static_symbols( const std::string& file_name )
+{
+    elfio reader;
+    ASSERT_EQ( reader.load( file_name ), true ) << file_name;
+    ASSERT_EQ( reader.get_class(), Class );
+    ASSERT_EQ( reader.get_encoding(), Encoding );
+
+    Elf_Xword checked = 0;
+    for ( const auto& sec : reader.sections ) {
+        if ( sec->get_type() != SHT_SYMTAB && sec->get_type() != SHT_DYNSYM ) {
+            continue;
+        }
+        const_symbol_section_accessor symbols( reader, sec.get() );
+        static_symbol_section_accessor<Class, Encoding> fast( reader,
+                                                              sec.get() );
+        ASSERT_EQ( fast.get_symbols_num(), symbols.get_symbols_num() );
+        for ( Elf_Xword i = 0; i < symbols.get_symbols_num(); ++i ) {
+            std::string      name1;
+            std::string_view name2;
+            Elf64_Addr       value1, value2;
+            Elf_Xword        size1, size2;
+            unsigned char    bind1, bind2, type1, type2, other1, other2;
+            Elf_Half         section1, section2;
+            symbols.get_symbol( i, name1, value1, size1, bind1, type1,
+                                section1, other1 );
+            ASSERT_EQ( fast.get_symbol( i, name2, value2, size2, bind2, type2,
+                                        section2, other2 ),
+                       true );
+            EXPECT_EQ( name1, name2 ) << file_name;
+            EXPECT_EQ( value1, value2 );
+            EXPECT_EQ( size1, size2 );
+            EXPECT_EQ( bind1, bind2 );
+            EXPECT_EQ( type1, type2 );
+            EXPECT_EQ( section1, section2 );
+            EXPECT_EQ( other1, other2 );
+            ++checked;
+        }
+
+        std::string_view name;
+        Elf64_Addr       value;
+        Elf_Xword        size;
+        unsigned char    bind, type, other;
+        Elf_Half         section_index;
+        EXPECT_EQ( fast.get_symbol( fast.get_symbols_num(), name, value, size,
+                                    bind, type, section_index, other ),
+                   false );
+    }
+    EXPECT_GT( checked, 0 ) << file_name;
+
+    // Files of another class or encoding give an empty accessor
+    const section* symtab = reader.sections[".symtab"];
+    static_symbol_section_accessor<Class, ( Encoding == ELFDATA2LSB
+                                                ? ELFDATA2MSB
+                                                : ELFDATA2LSB )>
+        other_encoding( reader, symtab );
+    EXPECT_EQ( other_encoding.get_symbols_num(), 0 );
+    static_symbol_section_accessor<( Class == ELFCLASS64 ? ELFCLASS32
+                                                         : ELFCLASS64 ),
+                                   Encoding>
+        other_class( reader, symtab );
+    EXPECT_EQ( other_class.get_symbols_num(), 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, static_symbol_accessor )
+{
+    check_static_symbols<ELFCLASS32, ELFDATA2LSB>( "elf_examples/hello_32" );
+    check_static_symbols<ELFCLASS64, ELFDATA2LSB>( "elf_examples/hello_64" );
+    check_static_symbols<ELFCLASS64, ELFDATA2LSB>( "elf_examples/hello_64.o" );
+    check_static_symbols<ELFCLASS32, ELFDATA2MSB>( "elf_examples/test_ppc" );
+
+    static_endianness_convertor<ELFDATA2MSB> msb;
+    static_endianness_convertor<ELFDATA2LSB> lsb;
+    EXPECT_NE( msb.is_conversion_needed(), lsb.is_conversion_needed() );
+    const Elf_Xword value = 0x0102030405060708;
+    EXPECT_EQ( msb( lsb( value ) ),
+               msb.is_conversion_needed() ? 0x0807060504030201 : value );
+    EXPECT_EQ( msb( Elf_Half( 0x0102 ) ),
+               msb.is_conversion_needed() ? 0x0201 : 0x0102 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Exposes the stream based loads of the sections and segments
+struct stream_section : section_impl<Elf64_Shdr>
+{
+    using section_impl::load;
+    using section_impl::section_impl;
+};
+
+struct stream_segment : segment_impl<Elf64_Phdr>
+{
+    using segment_impl::load;
+    using segment_impl::segment_impl;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, load_from_stream_offsets )
+{
+    elfio reader;
+    ASSERT_EQ( reader.load( "elf_examples/hello_64" ), true );
+    const section* text = reader.sections[".text"];
+    ASSERT_NE( text, nullptr );
+    ASSERT_GT( reader.segments.size(), 0 );
+    const segment* load = reader.segments[0];
+
+    // The stream based loads read a single header each
+    std::ifstream stream( "elf_examples/hello_64", std::ios::binary );
+    auto          convertor = std::make_shared<endianness_convertor>();
+    convertor->setup( ELFDATA2LSB );
+    auto translator = std::make_shared<address_translator>();
+
+    stream_section sec( convertor, translator, nullptr );
+    ASSERT_EQ( sec.load( stream,
+                         std::streampos( reader.get_sections_offset() +
+                                         text->get_index() *
+                                             sizeof( Elf64_Shdr ) ),
+                         false ),
+               true );
+    EXPECT_EQ( sec.get_address(), text->get_address() );
+    ASSERT_EQ( sec.get_size(), text->get_size() );
+    EXPECT_TRUE( std::equal( sec.get_data(), sec.get_data() + sec.get_size(),
+                             text->get_data() ) );
+
+    stream_segment seg( convertor, translator );
+    ASSERT_EQ( seg.load( stream,
+                         std::streampos( reader.get_segments_offset() ),
+                         true ),
+               true );
+    EXPECT_EQ( seg.get_type(), load->get_type() );
+    EXPECT_EQ( seg.get_virtual_address(), load->get_virtual_address() );
+    EXPECT_EQ( seg.get_file_size(), load->get_file_size() );
+}
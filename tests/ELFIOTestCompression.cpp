@@ -0,0 +1,242 @@
+/*
+Copyright (C) 2001-present by Serge Lamikhov-Center
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifdef _MSC_VER
+#define _SCL_SECURE_NO_WARNINGS
+#define ELFIO_NO_INTTYPES
+#endif
+
+#include <gtest/gtest.h>
+#include <elfio/elfio_compression.hpp>
+
+
+using namespace ELFIO;
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, compressed_sections_load )
+{
+    for ( const std::string file_name : { "elf_examples/zlib_debug_64.o",
+                                          "elf_examples/zlib_debug_32.o" } ) {
+        elfio raw;
+        elfio reader( new section_compression() );
+        ASSERT_EQ( raw.load( file_name ), true );
+        ASSERT_EQ( reader.load( file_name ), true );
+
+        section_compression codec;
+        codec.setup( raw.get_class() );
+
+        int compressed = 0;
+        for ( const auto& sec : raw.sections ) {
+            if ( ( sec->get_flags() & SHF_COMPRESSED ) == 0 ) {
+                continue;
+            }
+            ++compressed;
+
+            Elf_Word  type       = 0;
+            Elf_Xword size       = 0;
+            Elf_Xword addr_align = 0;
+            ASSERT_EQ( codec.get_header( sec->get_data(), sec->get_size(),
+                                         raw.get_convertor(), type, size,
+                                         addr_align ),
+                       true );
+            EXPECT_EQ( type, ELFCOMPRESS_ZLIB );
+
+            const section* inflated = reader.sections[sec->get_name()];
+            ASSERT_NE( inflated, nullptr );
+            ASSERT_EQ( inflated->get_size(), size );
+
+            std::string data( size_t( size ), '\0' );
+            ASSERT_EQ( codec.read( raw, sec.get(), 0, &data[0], size ), true );
+            EXPECT_EQ( data, std::string( inflated->get_data(), size ) );
+        }
+        EXPECT_GE( compressed, 2 );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, compressed_sections_parallel_load )
+{
+    for ( const std::string file_name : { "elf_examples/zlib_debug_64.o",
+                                          "elf_examples/zlib_debug_32.o" } ) {
+        elfio serial( new section_compression() );
+        elfio parallel( new section_compression() );
+        elfio mapped( new section_compression() );
+        parallel.set_threads_num( 4 );
+        mapped.set_threads_num( 4 );
+        ASSERT_EQ( serial.load( file_name ), true );
+        ASSERT_EQ( parallel.load( file_name ), true );
+        ASSERT_EQ( mapped.load_mapped( file_name ), true );
+
+        for ( const elfio* reader : { &parallel, &mapped } ) {
+            ASSERT_EQ( reader->sections.size(), serial.sections.size() );
+            for ( Elf_Half i = 0; i < serial.sections.size(); ++i ) {
+                const section* expected = serial.sections[i];
+                const section* sec      = reader->sections[i];
+                ASSERT_EQ( sec->get_size(), expected->get_size() );
+                EXPECT_EQ( std::string( sec->get_data() ? sec->get_data() : "",
+                                        sec->get_size() ),
+                           std::string( expected->get_data()
+                                            ? expected->get_data()
+                                            : "",
+                                        expected->get_size() ) );
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, compressed_section_range_read )
+{
+    elfio raw;
+    ASSERT_EQ( raw.load( "elf_examples/zlib_debug_64.o", true ), true );
+    const section* sec = raw.sections[".debug_info"];
+    ASSERT_NE( sec, nullptr );
+    ASSERT_NE( sec->get_flags() & SHF_COMPRESSED, 0 );
+
+    section_compression codec( ELFCOMPRESS_ZLIB, 16 );
+    codec.setup( raw.get_class() );
+    Elf_Xword               size = 0;
+    std::unique_ptr<char[]> whole =
+        codec.inflate( sec->get_data(), raw.get_convertor(), sec->get_size(),
+                       size );
+    ASSERT_NE( whole, nullptr );
+    ASSERT_GT( size, 64 );
+
+    // Sequential, overlapping and backward ranges
+    std::vector<std::pair<Elf_Xword, Elf_Xword>> ranges = {
+        { 0, 10 },  { 10, 7 }, { 17, 40 },       { 50, 3 },  { 52, 1 },
+        { 20, 30 }, { 0, 1 },  { size - 5, 5 }, { 3, size - 3 } };
+    for ( const auto& range : ranges ) {
+        std::string data( size_t( range.second ), '\0' );
+        ASSERT_EQ( codec.read( raw, sec, range.first, &data[0], range.second ),
+                   true );
+        EXPECT_EQ( data,
+                   std::string( whole.get() + range.first, range.second ) );
+    }
+
+    char c;
+    EXPECT_EQ( codec.read( raw, sec, size, &c, 1 ), false );
+    EXPECT_EQ( codec.read( raw, sec, size, &c, 0 ), true );
+
+    // Truncated compressed data
+    EXPECT_EQ( codec.read( sec->get_data(), sec->get_size() / 2,
+                           raw.get_convertor(), size - 1, &c, 1 ),
+               false );
+    EXPECT_EQ( codec.inflate( sec->get_data(), raw.get_convertor(),
+                              sec->get_size() / 2, size ),
+               nullptr );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, compressed_section_round_trip )
+{
+    std::string data;
+    for ( int i = 0; i < 1000; ++i ) {
+        data += "compressed section " + std::to_string( i % 17 ) + '\n';
+    }
+
+    auto convertor = std::make_shared<endianness_convertor>();
+    convertor->setup( ELFDATA2MSB );
+
+    for ( unsigned char file_class : { ELFCLASS32, ELFCLASS64 } ) {
+        section_compression codec;
+        codec.setup( file_class );
+
+        Elf_Xword compressed_size = 0;
+        auto      compressed = codec.deflate( data.data(), convertor,
+                                              data.size(), compressed_size );
+        ASSERT_NE( compressed, nullptr );
+        EXPECT_LT( compressed_size, data.size() / 4 );
+
+        Elf_Word  type       = 0;
+        Elf_Xword size       = 0;
+        Elf_Xword addr_align = 0;
+        ASSERT_EQ( codec.get_header( compressed.get(), compressed_size,
+                                     convertor, type, size, addr_align ),
+                   true );
+        EXPECT_EQ( type, ELFCOMPRESS_ZLIB );
+        EXPECT_EQ( size, data.size() );
+        EXPECT_EQ( addr_align, 1 );
+
+        Elf_Xword uncompressed_size = 0;
+        auto      uncompressed      = codec.inflate(
+            compressed.get(), convertor, compressed_size, uncompressed_size );
+        ASSERT_NE( uncompressed, nullptr );
+        EXPECT_EQ( std::string( uncompressed.get(), uncompressed_size ),
+                   data );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST( ELFIOTest, compressed_sections_save )
+{
+    for ( const std::string file_name : { "elf_examples/zlib_debug_64.o",
+                                          "elf_examples/zlib_debug_32.o" } ) {
+        elfio writer( new section_compression() );
+        ASSERT_EQ( writer.load( file_name ), true );
+
+        // Make compressed sections big enough to be worth the threads
+        std::vector<std::string> contents;
+        for ( const auto& sec : writer.sections ) {
+            if ( sec->get_flags() & SHF_COMPRESSED ) {
+                std::string data( sec->get_data(), sec->get_size() );
+                for ( int i = 0; i < 10; ++i ) {
+                    data += data;
+                }
+                sec->set_data( data );
+            }
+            contents.emplace_back( sec->get_data() ? sec->get_data() : "",
+                                   sec->get_size() );
+        }
+
+        std::stringstream serial;
+        ASSERT_EQ( writer.save( serial ), true );
+        writer.set_threads_num( 4 );
+        EXPECT_EQ( writer.get_threads_num(), 4 );
+        std::stringstream parallel;
+        ASSERT_EQ( writer.save( parallel ), true );
+        EXPECT_EQ( serial.str(), parallel.str() );
+
+        // The uncompressed data is kept in memory
+        for ( Elf_Half i = 0; i < writer.sections.size(); ++i ) {
+            const section* sec = writer.sections[i];
+            EXPECT_EQ( std::string( sec->get_data() ? sec->get_data() : "",
+                                    sec->get_size() ),
+                       contents[i] );
+        }
+
+        // The file holds the compressed data and sizes
+        elfio raw;
+        elfio reader( new section_compression() );
+        ASSERT_EQ( raw.load( parallel ), true );
+        ASSERT_EQ( reader.load( parallel ), true );
+        for ( Elf_Half i = 0; i < reader.sections.size(); ++i ) {
+            const section* sec = reader.sections[i];
+            EXPECT_EQ( std::string( sec->get_data() ? sec->get_data() : "",
+                                    sec->get_size() ),
+                       contents[i] );
+            if ( sec->get_flags() & SHF_COMPRESSED ) {
+                EXPECT_LT( raw.sections[i]->get_size(), sec->get_size() / 8 );
+            }
+        }
+    }
+}